@@ -0,0 +1,223 @@
+// Copyright © 2016-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_BACKEND_THREADED_CPU_H__
+#define __NMFD_BACKEND_THREADED_CPU_H__
+
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include <scfd/memory/host.h>
+#include <scfd/static_vec/vec.h>
+
+/**
+*   Multi-threaded (OpenMP) CPU backend. Fits the Backend template parameter of
+*   dense_vector_operations, dense_vector_space and dense_operations (same types as scfd::backend::serial_cpu).
+*
+*   - for_each uses static partitioning: thread t always processes the same contiguous range of indices;
+*   - memory_type touches freshly allocated memory with the same partitioning, so on NUMA systems
+*     pages of a vector are placed on the node of the thread that later processes them (first touch policy);
+*   - reduce and transform_reduce sum fixed size blocks and then combine block sums by pairwise tree
+*     in fixed order, so the result does not depend on the number of threads and is reproducible from run to run;
+*     transform_reduce evaluates map on the fly, so reductions in dense_vector_operations need no temporary array.
+*
+*   Without OpenMP (no -fopenmp) everything runs on a single thread with the same results.
+*/
+
+namespace nmfd
+{
+namespace backend
+{
+namespace detail
+{
+
+inline int threaded_cpu_threads_num()
+{
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+inline int threaded_cpu_thread_id()
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/// [begin, end) part of [0, n) processed by thread t of threads_num
+template<class Ordinal>
+void threaded_cpu_static_range(Ordinal n, int t, int threads_num, Ordinal &begin, Ordinal &end)
+{
+    begin = static_cast<Ordinal>((static_cast<long long>(n)*t)/threads_num);
+    end = static_cast<Ordinal>((static_cast<long long>(n)*(t+1))/threads_num);
+}
+
+struct threaded_cpu_host_memory : public scfd::memory::host
+{
+    static void malloc(pointer_type* p, size_t size)
+    {
+        scfd::memory::host::malloc(p, size);
+        // first touch with the same partitioning as for_each uses
+        char *data = static_cast<char*>(*p);
+        const int threads_num = threaded_cpu_threads_num();
+        #pragma omp parallel num_threads(threads_num)
+        {
+            size_t begin, end;
+            threaded_cpu_static_range(size, threaded_cpu_thread_id(), threads_num, begin, end);
+            if(end > begin)
+                std::memset(data + begin, 0, end - begin);
+        }
+    }
+};
+
+template<class Ordinal = int>
+struct threaded_cpu_for_each
+{
+    template<class Func>
+    void operator()(Func f, Ordinal size) const
+    {
+        const int threads_num = threaded_cpu_threads_num();
+        #pragma omp parallel num_threads(threads_num)
+        {
+            Func f_loc(f);
+            Ordinal begin, end;
+            threaded_cpu_static_range(size, threaded_cpu_thread_id(), threads_num, begin, end);
+            for(Ordinal i = begin; i < end; ++i)
+            {
+                f_loc(i);
+            }
+        }
+    }
+};
+
+/// range is split over the first index only
+template<int Dim, class Ordinal = int>
+struct threaded_cpu_for_each_nd
+{
+    using idx_nd_type = scfd::static_vec::vec<Ordinal, Dim>;
+
+    template<class Func>
+    void operator()(Func f, const idx_nd_type &size) const
+    {
+        Ordinal inner_size = 1;
+        for(int j = 1; j < Dim; ++j)
+        {
+            inner_size *= size[j];
+        }
+        const int threads_num = threaded_cpu_threads_num();
+        #pragma omp parallel num_threads(threads_num)
+        {
+            Func f_loc(f);
+            Ordinal begin, end;
+            threaded_cpu_static_range(size[0], threaded_cpu_thread_id(), threads_num, begin, end);
+            idx_nd_type idx;
+            for(Ordinal i0 = begin; i0 < end; ++i0)
+            {
+                for(Ordinal l = 0; l < inner_size; ++l)
+                {
+                    idx[0] = i0;
+                    Ordinal rem = l;
+                    for(int j = Dim-1; j > 0; --j)
+                    {
+                        idx[j] = rem%size[j];
+                        rem /= size[j];
+                    }
+                    f_loc(idx);
+                }
+            }
+        }
+    }
+};
+
+struct threaded_cpu_transform_reduce
+{
+    /// block size is fixed (not derived from threads number) to keep summation order independent of it
+    static const std::ptrdiff_t block_size = 2048;
+
+    /// op(init_val, f(0) op ... op f(size-1)); f is called exactly once for each index
+    template<class Ordinal, class Func, class T, class BinaryOp>
+    T operator()(Ordinal size, const Func &f, T init_val, BinaryOp op) const
+    {
+        const std::ptrdiff_t n = static_cast<std::ptrdiff_t>(size);
+        const std::ptrdiff_t blocks_num = (n + block_size - 1)/block_size;
+        if(blocks_num == 0)
+        {
+            return init_val;
+        }
+        std::vector<T> partial(blocks_num, init_val);
+        const int threads_num = threaded_cpu_threads_num();
+        #pragma omp parallel num_threads(threads_num)
+        {
+            std::ptrdiff_t b_begin, b_end;
+            threaded_cpu_static_range(blocks_num, threaded_cpu_thread_id(), threads_num, b_begin, b_end);
+            for(std::ptrdiff_t b = b_begin; b < b_end; ++b)
+            {
+                const std::ptrdiff_t i_end = (b+1)*block_size < n ? (b+1)*block_size : n;
+                T s = f(static_cast<Ordinal>(b*block_size));
+                for(std::ptrdiff_t i = b*block_size+1; i < i_end; ++i)
+                {
+                    s = op(s, f(static_cast<Ordinal>(i)));
+                }
+                partial[b] = s;
+            }
+        }
+        for(std::ptrdiff_t stride = 1; stride < blocks_num; stride *= 2)
+        {
+            for(std::ptrdiff_t b = 0; b + stride < blocks_num; b += 2*stride)
+            {
+                partial[b] = op(partial[b], partial[b + stride]);
+            }
+        }
+        return op(init_val, partial[0]);
+    }
+};
+
+struct threaded_cpu_reduce
+{
+    template<class Ordinal, class T>
+    T operator()(Ordinal size, const T *input, T init_val) const
+    {
+        return threaded_cpu_transform_reduce()(
+            size, [input](Ordinal i) { return input[i]; }, init_val, [](const T &a, const T &b) { return a + b; }
+        );
+    }
+};
+
+} // namespace detail
+
+struct threaded_cpu
+{
+    using memory_type = detail::threaded_cpu_host_memory;
+    template<class Ordinal = int>
+    using for_each_type = detail::threaded_cpu_for_each<Ordinal>;
+    template<int Dim, class Ordinal = int>
+    using for_each_nd_type = detail::threaded_cpu_for_each_nd<Dim, Ordinal>;
+    using reduce_type = detail::threaded_cpu_reduce;
+    using transform_reduce_type = detail::threaded_cpu_transform_reduce;
+};
+
+} /// namespace backend
+} /// namespace nmfd
+
+#endif
@@ -0,0 +1,54 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_JACOBI_APPLY_HOOK_H__
+#define __NMFD_JACOBI_APPLY_HOOK_H__
+
+#include <utility>
+
+namespace nmfd
+{
+namespace detail
+{
+
+/// Calculates f = J*v with the jacobi operator of the current linearization point
+/// (nonlin_op.get_jacobi_operator()->apply(v, f)) and returns true if NonlinearOperator provides it;
+/// returns false and does nothing otherwise (for example for residual-only operators).
+template<class NonlinearOperator, class Vector, class = int>
+struct jacobi_apply_hook
+{
+    static constexpr bool is_available = false;
+    static bool apply(const NonlinearOperator &, const Vector &, Vector &)
+    {
+        return false;
+    }
+};
+
+template<class NonlinearOperator, class Vector>
+struct jacobi_apply_hook<NonlinearOperator,Vector,decltype((void)(std::declval<const NonlinearOperator&>().get_jacobi_operator()->apply(std::declval<const Vector&>(),std::declval<Vector&>())),int(0))>
+{
+    static constexpr bool is_available = true;
+    static bool apply(const NonlinearOperator &nonlin_op, const Vector &v, Vector &f)
+    {
+        nonlin_op.get_jacobi_operator()->apply(v, f);
+        return true;
+    }
+};
+
+} // namespace detail
+} // namespace nmfd
+
+#endif
@@ -0,0 +1,100 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_LIN_SOLVER_MONITOR_HOOK_H__
+#define __NMFD_LIN_SOLVER_MONITOR_HOOK_H__
+
+#include <utility>
+
+namespace nmfd
+{
+namespace detail
+{
+
+/// Gives access to the monitor of iterative linear solvers (lin_solver.monitor(), see default_monitor).
+/// For solvers without monitor (direct solvers etc.) is_available is false, iters_performed returns -1,
+/// resid_norm returns -1 and tolerance manipulations do nothing.
+template<class LinearSolver, class = int>
+struct lin_solver_monitor_hook
+{
+    static constexpr bool is_available = false;
+    static int iters_performed(const LinearSolver &)
+    {
+        return -1;
+    }
+    template<class T>
+    static T resid_norm(const LinearSolver &)
+    {
+        return T(-1);
+    }
+    template<class T>
+    static T rel_tol(const LinearSolver &)
+    {
+        return T(0);
+    }
+    template<class T>
+    static void set_temp_tolerance(LinearSolver &, T)
+    {
+    }
+    static void restore_tolerance(LinearSolver &)
+    {
+    }
+};
+
+template<class LinearSolver>
+struct lin_solver_monitor_hook
+<
+    LinearSolver,
+    decltype
+    (
+        (void)(std::declval<const LinearSolver&>().monitor().iters_performed()),
+        (void)(std::declval<const LinearSolver&>().monitor().resid_norm()),
+        (void)(std::declval<LinearSolver&>().monitor().restore_tolerance()),
+        int(0)
+    )
+>
+{
+    static constexpr bool is_available = true;
+    static int iters_performed(const LinearSolver &lin_solver)
+    {
+        return lin_solver.monitor().iters_performed();
+    }
+    /// norm of the linear residual at the end of the last solve
+    template<class T>
+    static T resid_norm(const LinearSolver &lin_solver)
+    {
+        return lin_solver.monitor().resid_norm();
+    }
+    template<class T>
+    static T rel_tol(const LinearSolver &lin_solver)
+    {
+        return lin_solver.monitor().rel_tol();
+    }
+    template<class T>
+    static void set_temp_tolerance(LinearSolver &lin_solver, T rel_tol)
+    {
+        lin_solver.monitor().set_temp_tolerance(rel_tol);
+    }
+    static void restore_tolerance(LinearSolver &lin_solver)
+    {
+        lin_solver.monitor().restore_tolerance();
+    }
+};
+
+} // namespace detail
+} // namespace nmfd
+
+#endif
@@ -0,0 +1,50 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_LINEARIZATION_POINT_HOOK_H__
+#define __NMFD_LINEARIZATION_POINT_HOOK_H__
+
+#include <utility>
+
+namespace nmfd
+{
+namespace detail
+{
+
+/// Calls nonlin_op.set_linearization_point(x, Fx) if NonlinearOperator can reuse already known residual
+/// Fx = F(x) (for example jacobian-free operators) and nonlin_op.set_linearization_point(x) otherwise.
+template<class NonlinearOperator, class Vector, class = int>
+struct linearization_point_hook
+{
+    static void set(NonlinearOperator &nonlin_op, const Vector &x, const Vector &)
+    {
+        nonlin_op.set_linearization_point(x);
+    }
+};
+
+template<class NonlinearOperator, class Vector>
+struct linearization_point_hook<NonlinearOperator,Vector,decltype((void)(std::declval<NonlinearOperator&>().set_linearization_point(std::declval<const Vector&>(),std::declval<const Vector&>())),int(0))>
+{
+    static void set(NonlinearOperator &nonlin_op, const Vector &x, const Vector &Fx)
+    {
+        nonlin_op.set_linearization_point(x, Fx);
+    }
+};
+
+} // namespace detail
+} // namespace nmfd
+
+#endif
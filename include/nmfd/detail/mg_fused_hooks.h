@@ -0,0 +1,126 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_MG_FUSED_HOOKS_H__
+#define __NMFD_MG_FUSED_HOOKS_H__
+
+#include <utility>
+
+/**
+*   Optional extended level interface of preconditioners::mg. Each hook calls the fused method and returns true
+*   if the level component provides it; returns false and does nothing otherwise, so mg falls back to the basic
+*   Smoother/Restrictor/Prolongator interface.
+*/
+
+namespace nmfd
+{
+namespace detail
+{
+
+/// Smoother::apply_and_residual(rhs, x, residual): residual = rhs - A*x on entry; x += S*residual and
+/// residual = rhs - A*x (with updated x) in one sweep
+template<class Smoother, class Vector, class = int>
+struct smoother_residual_hook
+{
+    static constexpr bool is_available = false;
+    static bool apply(const Smoother &, const Vector &, Vector &, Vector &)
+    {
+        return false;
+    }
+};
+
+template<class Smoother, class Vector>
+struct smoother_residual_hook<Smoother,Vector,decltype((void)(std::declval<const Smoother&>().apply_and_residual(std::declval<const Vector&>(),std::declval<Vector&>(),std::declval<Vector&>())),int(0))>
+{
+    static constexpr bool is_available = true;
+    static bool apply(const Smoother &smoother, const Vector &rhs, Vector &x, Vector &residual)
+    {
+        smoother.apply_and_residual(rhs, x, residual);
+        return true;
+    }
+};
+
+/// Smoother::apply_zero_guess(rhs, x, residual): first sweep from zero initial guess, x is not read on entry;
+/// x = S*rhs and residual = rhs - A*x, which usually can be expressed through rhs without operator apply
+template<class Smoother, class Vector, class = int>
+struct smoother_zero_guess_hook
+{
+    static constexpr bool is_available = false;
+    static bool apply(const Smoother &, const Vector &, Vector &, Vector &)
+    {
+        return false;
+    }
+};
+
+template<class Smoother, class Vector>
+struct smoother_zero_guess_hook<Smoother,Vector,decltype((void)(std::declval<const Smoother&>().apply_zero_guess(std::declval<const Vector&>(),std::declval<Vector&>(),std::declval<Vector&>())),int(0))>
+{
+    static constexpr bool is_available = true;
+    static bool apply(const Smoother &smoother, const Vector &rhs, Vector &x, Vector &residual)
+    {
+        smoother.apply_zero_guess(rhs, x, residual);
+        return true;
+    }
+};
+
+/// Restrictor::restrict_residual(A, rhs, x, coarse_rhs): coarse_rhs = R*(rhs - A*x) without storing fine residual
+template<class Restrictor, class Operator, class Vector, class = int>
+struct restrict_residual_hook
+{
+    static constexpr bool is_available = false;
+    static bool apply(const Restrictor &, const Operator &, const Vector &, const Vector &, Vector &)
+    {
+        return false;
+    }
+};
+
+template<class Restrictor, class Operator, class Vector>
+struct restrict_residual_hook<Restrictor,Operator,Vector,decltype((void)(std::declval<const Restrictor&>().restrict_residual(std::declval<const Operator&>(),std::declval<const Vector&>(),std::declval<const Vector&>(),std::declval<Vector&>())),int(0))>
+{
+    static constexpr bool is_available = true;
+    static bool apply(const Restrictor &restrictor, const Operator &op, const Vector &rhs, const Vector &x, Vector &coarse_rhs)
+    {
+        restrictor.restrict_residual(op, rhs, x, coarse_rhs);
+        return true;
+    }
+};
+
+/// Prolongator::prolongate_add(coarse_x, x): x += P*coarse_x without temporary fine vector
+template<class Prolongator, class Vector, class = int>
+struct prolongate_add_hook
+{
+    static constexpr bool is_available = false;
+    static bool apply(const Prolongator &, const Vector &, Vector &)
+    {
+        return false;
+    }
+};
+
+template<class Prolongator, class Vector>
+struct prolongate_add_hook<Prolongator,Vector,decltype((void)(std::declval<const Prolongator&>().prolongate_add(std::declval<const Vector&>(),std::declval<Vector&>())),int(0))>
+{
+    static constexpr bool is_available = true;
+    static bool apply(const Prolongator &prolongator, const Vector &coarse_x, Vector &x)
+    {
+        prolongator.prolongate_add(coarse_x, x);
+        return true;
+    }
+};
+
+} // namespace detail
+} // namespace nmfd
+
+#endif
@@ -0,0 +1,49 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_RECYCLE_SPACE_HOOK_H__
+#define __NMFD_RECYCLE_SPACE_HOOK_H__
+
+#include <utility>
+
+namespace nmfd
+{
+namespace detail
+{
+
+/// Calls algo.update_recycle_space(arg) if Algo has such method (i.e. recycling krylov solvers)
+/// and does nothing otherwise.
+template<class Algo, class Arg, class = int>
+struct recycle_space_hook
+{
+    static void update(Algo &, const Arg &)
+    {
+    }
+};
+
+template<class Algo, class Arg>
+struct recycle_space_hook<Algo,Arg,decltype((void)(std::declval<Algo&>().update_recycle_space(std::declval<const Arg&>())),int(0))>
+{
+    static void update(Algo &algo, const Arg &arg)
+    {
+        algo.update_recycle_space(arg);
+    }
+};
+
+} // namespace detail
+} // namespace nmfd
+
+#endif
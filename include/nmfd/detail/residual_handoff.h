@@ -0,0 +1,96 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_RESIDUAL_HANDOFF_H__
+#define __NMFD_RESIDUAL_HANDOFF_H__
+
+#include <utility>
+
+namespace nmfd
+{
+namespace detail
+{
+
+/// Makes one step of iteration operator. If convergence strategy provides already calculated residual
+/// (conv_strat.residual() returns pointer to F(x) or nullptr) and iteration operator can accept it
+/// (has solve(nonlin_op, x, Fx, d_x)) then residual is passed, otherwise plain solve(nonlin_op, x, d_x) is called.
+template<class ConvergenceStrategy, class IterationOperator, class NonlinearOperator, class Vector, class = int>
+struct residual_handoff
+{
+    static bool solve(ConvergenceStrategy &conv_strat, IterationOperator &iter_op, NonlinearOperator &nonlin_op, const Vector &x, Vector &d_x)
+    {
+        return iter_op.solve(nonlin_op, x, d_x);
+    }
+};
+
+template<class ConvergenceStrategy, class IterationOperator, class NonlinearOperator, class Vector>
+struct residual_handoff
+<
+    ConvergenceStrategy, IterationOperator, NonlinearOperator, Vector,
+    decltype
+    (
+        (void)(std::declval<IterationOperator&>().solve(
+            std::declval<NonlinearOperator&>(), std::declval<const Vector&>(),
+            *std::declval<const ConvergenceStrategy&>().residual(), std::declval<Vector&>()
+        )),
+        int(0)
+    )
+>
+{
+    static bool solve(ConvergenceStrategy &conv_strat, IterationOperator &iter_op, NonlinearOperator &nonlin_op, const Vector &x, Vector &d_x)
+    {
+        const auto *Fx = conv_strat.residual();
+        if(Fx != nullptr)
+        {
+            return iter_op.solve(nonlin_op, x, *Fx, d_x);
+        }
+        return iter_op.solve(nonlin_op, x, d_x);
+    }
+};
+
+/// Passes F(x+d_x) of the step just made by iteration operator to convergence strategy. If iteration operator
+/// globalizes the step itself and provides the residual (iter_op.step_residual() returns pointer to F(x+d_x) or nullptr)
+/// and convergence strategy can accept it (has set_step_residual), the strategy does not recalculate F(x+d_x)
+/// for unit weight. Otherwise nothing is done.
+template<class ConvergenceStrategy, class IterationOperator, class = int>
+struct step_residual_handoff
+{
+    static void pass(ConvergenceStrategy &, const IterationOperator &)
+    {
+    }
+};
+
+template<class ConvergenceStrategy, class IterationOperator>
+struct step_residual_handoff
+<
+    ConvergenceStrategy, IterationOperator,
+    decltype
+    (
+        (void)(std::declval<ConvergenceStrategy&>().set_step_residual(std::declval<const IterationOperator&>().step_residual())),
+        int(0)
+    )
+>
+{
+    static void pass(ConvergenceStrategy &conv_strat, const IterationOperator &iter_op)
+    {
+        conv_strat.set_step_residual(iter_op.step_residual());
+    }
+};
+
+} // namespace detail
+} // namespace nmfd
+
+#endif
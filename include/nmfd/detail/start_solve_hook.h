@@ -0,0 +1,50 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_START_SOLVE_HOOK_H__
+#define __NMFD_START_SOLVE_HOOK_H__
+
+#include <utility>
+
+namespace nmfd
+{
+namespace detail
+{
+
+/// Calls algo.start_solve() if Algo has such method (i.e. iteration operators that keep state between
+/// steps, like lagged jacobian or secant history, which must be dropped when new nonlinear solve starts)
+/// and does nothing otherwise.
+template<class Algo, class = int>
+struct start_solve_hook
+{
+    static void apply(Algo &)
+    {
+    }
+};
+
+template<class Algo>
+struct start_solve_hook<Algo,decltype((void)(std::declval<Algo&>().start_solve()),int(0))>
+{
+    static void apply(Algo &algo)
+    {
+        algo.start_solve();
+    }
+};
+
+} // namespace detail
+} // namespace nmfd
+
+#endif
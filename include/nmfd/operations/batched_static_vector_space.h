@@ -0,0 +1,289 @@
+#ifndef __NMFD_BATCHED_STATIC_VECTOR_SPACE_H__
+#define __NMFD_BATCHED_STATIC_VECTOR_SPACE_H__
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace nmfd
+{
+namespace operations
+{
+
+/**
+*   Batch of batch_size independent vectors of static size Dim stored as structure of arrays:
+*   component i of system b is data[i*batch_size + b], so every operation below is a loop over
+*   contiguous lanes (systems) for each component, which compilers vectorize across systems.
+*/
+template <class T, int Dim>
+struct batched_static_vector
+{
+    std::vector<T> data;
+    std::size_t batch_size = 0;
+
+    T &operator()(int i, std::size_t b)
+    {
+        return data[i*batch_size + b];
+    }
+    const T &operator()(int i, std::size_t b)const
+    {
+        return data[i*batch_size + b];
+    }
+    /// pointer to batch_size contiguous values of component i
+    T *component(int i)
+    {
+        return data.data() + i*batch_size;
+    }
+    const T *component(int i)const
+    {
+        return data.data() + i*batch_size;
+    }
+};
+
+/// Batch of Dim x Dim matrices, element (i,j) of system b is data[(i*Dim + j)*batch_size + b]
+template <class T, int Dim>
+struct batched_static_matrix
+{
+    std::vector<T> data;
+    std::size_t batch_size = 0;
+
+    T &operator()(int i, int j, std::size_t b)
+    {
+        return data[(i*Dim + j)*batch_size + b];
+    }
+    const T &operator()(int i, int j, std::size_t b)const
+    {
+        return data[(i*Dim + j)*batch_size + b];
+    }
+    T *component(int i, int j)
+    {
+        return data.data() + (i*Dim + j)*batch_size;
+    }
+    const T *component(int i, int j)const
+    {
+        return data.data() + (i*Dim + j)*batch_size;
+    }
+};
+
+/**
+*   Vector space of batches of small static vectors (see batched_static_vector). Linear combinations take
+*   either common scalar multipliers or per lane multipliers (lanes_type, one value per system, zero
+*   multiplier masks the system out). Reductions are per lane: results are written to lanes_type.
+*/
+template <class T, int Dim>
+struct batched_static_vector_space
+{
+    static constexpr int dim = Dim;
+    using scalar_type = T;
+    using vector_type = batched_static_vector<T,Dim>;
+    using matrix_type = batched_static_matrix<T,Dim>;
+    /// one value per system
+    using lanes_type = std::vector<T>;
+    /// one flag per system
+    using mask_type = std::vector<unsigned char>;
+
+    explicit batched_static_vector_space(std::size_t batch_size) : batch_size_(batch_size)
+    {
+    }
+
+    /// size of each system
+    std::size_t size()const
+    {
+        return Dim;
+    }
+    /// number of systems
+    std::size_t batch_size()const
+    {
+        return batch_size_;
+    }
+
+    void init_vector(vector_type& x)const
+    {
+        x.batch_size = batch_size_;
+        x.data.assign(Dim*batch_size_, T(0));
+    }
+    template<class ...Args>
+    void init_vectors(Args&&...args)const
+    {
+        (init_vector(args), ...);
+    }
+    void free_vector(vector_type& x)const
+    {
+        x.data.clear();
+        x.data.shrink_to_fit();
+        x.batch_size = 0;
+    }
+    template<class ...Args>
+    void free_vectors(Args&&...args)const
+    {
+        (free_vector(args), ...);
+    }
+    void start_use_vector(vector_type& x)const
+    {
+    }
+    template<class ...Args>
+    void start_use_vectors(Args&&...args)const
+    {
+    }
+    void stop_use_vector(vector_type& x)const
+    {
+    }
+    template<class ...Args>
+    void stop_use_vectors(Args&&...args)const
+    {
+    }
+    void init_matrix(matrix_type& a)const
+    {
+        a.batch_size = batch_size_;
+        a.data.assign(Dim*Dim*batch_size_, T(0));
+    }
+    void free_matrix(matrix_type& a)const
+    {
+        a.data.clear();
+        a.data.shrink_to_fit();
+        a.batch_size = 0;
+    }
+    void init_lanes(lanes_type& l, T val = T(0))const
+    {
+        l.assign(batch_size_, val);
+    }
+    void init_mask(mask_type& m, unsigned char val = 0)const
+    {
+        m.assign(batch_size_, val);
+    }
+
+    void set_value_at_point(scalar_type val_x, int i, std::size_t b, vector_type& x)const
+    {
+        x(i,b) = val_x;
+    }
+    T get_value_at_point(int i, std::size_t b, const vector_type& x)const
+    {
+        return x(i,b);
+    }
+
+    //calc: valid_b := all components of system b are finite
+    void check_is_valid_number(const vector_type &x, mask_type &valid)const
+    {
+        for(std::size_t b = 0;b < batch_size_;++b)
+            valid[b] = 1;
+        for(int i = 0;i < Dim;++i)
+        {
+            const T *x_i = x.component(i);
+            for(std::size_t b = 0;b < batch_size_;++b)
+                valid[b] &= static_cast<unsigned char>(std::isfinite(x_i[b]));
+        }
+    }
+    //calc: res_b := (x_b,y_b)
+    void scalar_prod(const vector_type &x, const vector_type &y, lanes_type &res)const
+    {
+        for(std::size_t b = 0;b < batch_size_;++b)
+            res[b] = T(0);
+        for(int i = 0;i < Dim;++i)
+        {
+            const T *x_i = x.component(i), *y_i = y.component(i);
+            for(std::size_t b = 0;b < batch_size_;++b)
+                res[b] += x_i[b]*y_i[b];
+        }
+    }
+    void norm_sq(const vector_type &x, lanes_type &res)const
+    {
+        scalar_prod(x, x, res);
+    }
+    void norm(const vector_type &x, lanes_type &res)const
+    {
+        scalar_prod(x, x, res);
+        for(std::size_t b = 0;b < batch_size_;++b)
+            res[b] = std::sqrt(res[b]);
+    }
+    void norm_inf(const vector_type &x, lanes_type &res)const
+    {
+        for(std::size_t b = 0;b < batch_size_;++b)
+            res[b] = T(0);
+        for(int i = 0;i < Dim;++i)
+        {
+            const T *x_i = x.component(i);
+            for(std::size_t b = 0;b < batch_size_;++b)
+                res[b] = (res[b] < std::abs(x_i[b]))?std::abs(x_i[b]):res[b];
+        }
+    }
+
+    //calc: x := <vector_type with all elements equal to given scalar value>
+    void assign_scalar(const scalar_type scalar, vector_type& x)const
+    {
+        for(std::size_t k = 0;k < x.data.size();++k)
+            x.data[k] = scalar;
+    }
+    //copy: y := x
+    void assign(const vector_type& x, vector_type& y)const
+    {
+        for(std::size_t k = 0;k < x.data.size();++k)
+            y.data[k] = x.data[k];
+    }
+    //calc: y := mul_x*x
+    void assign_lin_comb(scalar_type mul_x, const vector_type& x, vector_type& y)const
+    {
+        for(std::size_t k = 0;k < x.data.size();++k)
+            y.data[k] = mul_x*x.data[k];
+    }
+    //calc: z := mul_x*x + mul_y*y
+    void assign_lin_comb(scalar_type mul_x, const vector_type& x, scalar_type mul_y, const vector_type& y,
+                         vector_type& z)const
+    {
+        for(std::size_t k = 0;k < x.data.size();++k)
+            z.data[k] = mul_x*x.data[k] + mul_y*y.data[k];
+    }
+    //calc: z_b := mul_x*x_b + mul_y_b*y_b
+    void assign_lin_comb(scalar_type mul_x, const vector_type& x, const lanes_type &mul_y, const vector_type& y,
+                         vector_type& z)const
+    {
+        for(int i = 0;i < Dim;++i)
+        {
+            const T *x_i = x.component(i), *y_i = y.component(i);
+            T *z_i = z.component(i);
+            for(std::size_t b = 0;b < batch_size_;++b)
+                z_i[b] = mul_x*x_i[b] + mul_y[b]*y_i[b];
+        }
+    }
+    //calc: y := mul_x*x + y
+    void add_lin_comb(scalar_type mul_x, const vector_type& x, vector_type& y)const
+    {
+        for(std::size_t k = 0;k < x.data.size();++k)
+            y.data[k] += mul_x*x.data[k];
+    }
+    //calc: y := mul_x*x + mul_y*y
+    void add_lin_comb(scalar_type mul_x, const vector_type& x, scalar_type mul_y, vector_type& y)const
+    {
+        for(std::size_t k = 0;k < x.data.size();++k)
+            y.data[k] = mul_x*x.data[k] + mul_y*y.data[k];
+    }
+    //calc: y_b := mul_x_b*x_b + y_b
+    void add_lin_comb(const lanes_type &mul_x, const vector_type& x, vector_type& y)const
+    {
+        for(int i = 0;i < Dim;++i)
+        {
+            const T *x_i = x.component(i);
+            T *y_i = y.component(i);
+            for(std::size_t b = 0;b < batch_size_;++b)
+                y_i[b] += mul_x[b]*x_i[b];
+        }
+    }
+    //calc: y_b := x_b for systems with mask_b set
+    void assign_masked(const mask_type &mask, const vector_type& x, vector_type& y)const
+    {
+        for(int i = 0;i < Dim;++i)
+        {
+            const T *x_i = x.component(i);
+            T *y_i = y.component(i);
+            for(std::size_t b = 0;b < batch_size_;++b)
+                y_i[b] = mask[b]?x_i[b]:y_i[b];
+        }
+    }
+
+private:
+    std::size_t batch_size_;
+};
+
+} // namespace operations
+} // namespace nmfd
+
+#endif
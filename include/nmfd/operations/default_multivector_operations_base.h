@@ -53,6 +53,38 @@ public:
     {
         static_cast<const DerivedSpace*>(this)->add_lin_comb(mul_x, mx[k_], mul_y, y);
     }
+    /// default batched versions just loop over columns; spaces with real kernels should override them
+    void multi_scalar_prod(const multivector_type& mx, Ord m, Ord k0, Ord k1, const vector_type &y, scalar_type *res)const
+    {
+        for (Ord k = k0;k < k1;++k)
+        {
+            res[k-k0] = static_cast<const DerivedSpace*>(this)->scalar_prod(mx[k], y);
+        }
+    }
+    void multi_add_lin_comb(const scalar_type *mul_x, const multivector_type& mx, Ord m, Ord k0, Ord k1, const scalar_type mul_y, vector_type& y) const
+    {
+        if (k0 >= k1)
+        {
+            static_cast<const DerivedSpace*>(this)->scale(mul_y, y);
+            return;
+        }
+        static_cast<const DerivedSpace*>(this)->add_lin_comb(mul_x[0], mx[k0], mul_y, y);
+        for (Ord k = k0+1;k < k1;++k)
+        {
+            static_cast<const DerivedSpace*>(this)->add_lin_comb(mul_x[k-k0], mx[k], static_cast<scalar_type>(1), y);
+        }
+    }
+    /// default nonblocking reductions are performed immediately and return finished handle
+    reduction_handle scalar_prod_async(const vector_type &x, const vector_type &y, scalar_type *res)const
+    {
+        *res = static_cast<const DerivedSpace*>(this)->scalar_prod(x, y);
+        return reduction_handle();
+    }
+    reduction_handle multi_scalar_prod_async(const multivector_type& mx, Ord m, Ord k0, Ord k1, const vector_type &y, scalar_type *res)const
+    {
+        static_cast<const DerivedSpace*>(this)->multi_scalar_prod(mx, m, k0, k1, y, res);
+        return reduction_handle();
+    }
 
 };
 
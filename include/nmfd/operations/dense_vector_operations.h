@@ -2,10 +2,13 @@
 #define __NMFD_DENSE_VECTOR_OPERATIONS_H__
 
 #include <vector>
+#include <algorithm>
 
 #include <scfd/utils/todo.h>
 
 #include <nmfd/operations/kernels/dense_vector_space.h>
+#include <nmfd/operations/detail/backend_transform_reduce.h>
+#include <nmfd/operations/reduction_handle.h>
 
 namespace nmfd
 {
@@ -18,8 +21,13 @@ class dense_vector_operations
 public:
     using scalar_type   = typename VectorTraits::scalar_type;
     using vector_type   = typename VectorTraits::vector_type;
+    using multivector_type = std::vector<vector_type>;
+    using Ord           = Ordinal;
+    using ordinal_type  = Ordinal;
     using for_each_type = typename Backend::template for_each_type<Ordinal>;
     using reduce_type   = typename Backend::reduce_type;
+    using transform_reduce_traits = detail::backend_transform_reduce<Backend>;
+    using transform_reduce_type   = typename transform_reduce_traits::type;
     using memory_type   = typename Backend::memory_type;
 
 public:
@@ -42,6 +50,13 @@ public:
     using mul_pointwise_kernel     = kernels::mul_pointwise<scalar_type>;
     using div_pointwise_kernel     = kernels::div_pointwise<scalar_type>;
     using assign_random_kernel     = kernels::assign_random<scalar_type>;
+    using add_lin_comb_2_dot_kernel = kernels::add_lin_comb_2_dot<scalar_type>;
+    using scalar_prod_2_kernel     = kernels::scalar_prod_2<scalar_type>;
+
+    /// number of multivector columns processed by one sweep of the fused multi_* kernels
+    static constexpr int multi_kernel_max_cols = 8;
+    using multi_scalar_prod_kernel  = kernels::multi_scalar_prod<scalar_type, multi_kernel_max_cols>;
+    using multi_add_lin_comb_kernel = kernels::multi_add_lin_comb<scalar_type, multi_kernel_max_cols>;
 
 public:
     dense_vector_operations() = default;
@@ -49,7 +64,6 @@ public:
     template <typename... Args>
     dense_vector_operations( Args &&...args ) : vt_( std::forward<Args>( args )... )
     {
-        vt_.alloc( vt_.loc_size(), helper_ );
     }
 
     [[nodiscard]] Ordinal get_loc_size( const vector_type &x ) const
@@ -57,24 +71,40 @@ public:
         return vt_.get_loc_size( x );
     }
 
+    /// raw data access, used by conversions between spaces of different scalar types
+    scalar_type *get_raw_ptr( vector_type &x ) const
+    {
+        return vt_.get_raw_ptr( x );
+    }
+    const scalar_type *get_raw_ptr( const vector_type &x ) const
+    {
+        return vt_.get_raw_ptr( x );
+    }
+
     bool check_is_valid_number( const vector_type &x ) const
     {
         return std::isfinite( norm2_sq( x ) );
     }
+    // name used by solvers monitors (vector_operations_base interface)
+    [[nodiscard]] bool is_valid_number( const vector_type &x ) const
+    {
+        return check_is_valid_number( x );
+    }
 
     [[nodiscard]] scalar_type scalar_prod( const vector_type &x, const vector_type &y ) const
     {
-        verify_max_loc_size( get_loc_size( x ) );
-        for_each_inst_(
-            scalar_prod_kernel{ vt_.get_raw_ptr( x ), vt_.get_raw_ptr( y ), vt_.get_raw_ptr( helper_ ) },
-            get_loc_size( x )
-        );
-        return reduce_inst_( get_loc_size( x ), vt_.get_raw_ptr( helper_ ), scalar_type{ 0.f } );
+        return map_reduce_sum( get_loc_size( x ), scalar_prod_kernel{ vt_.get_raw_ptr( x ), vt_.get_raw_ptr( y ) } );
     }
     [[nodiscard]] scalar_type scalar_prod_l2( const vector_type &x, const vector_type &y ) const
     {
         return scalar_prod( x, y );
     }
+    // single node reductions have nothing to overlap with, so they are finished immediately
+    reduction_handle scalar_prod_async( const vector_type &x, const vector_type &y, scalar_type *res ) const
+    {
+        *res = scalar_prod( x, y );
+        return reduction_handle();
+    }
 
     [[nodiscard]] scalar_type norm( const vector_type &x ) const
     {
@@ -112,6 +142,12 @@ public:
     }
     [[nodiscard]] scalar_type norm_inf( const vector_type &x ) const
     {
+        if constexpr ( transform_reduce_traits::is_available )
+        {
+            return transform_reduce_inst_(
+                get_loc_size( x ), norm_inf_kernel{ vt_.get_raw_ptr( x ) }, scalar_type{ 0 }, kernels::max_op{}
+            );
+        }
         scalar_type max_val = 0.0;
         for ( size_t j = 0; j < get_loc_size( x ); j++ )
         {
@@ -129,15 +165,11 @@ public:
 
     [[nodiscard]] scalar_type sum( const vector_type &x ) const
     {
-        verify_max_loc_size( get_loc_size( x ) );
-        for_each_inst_( sum_kernel{ vt_.get_raw_ptr( x ), vt_.get_raw_ptr( helper_ ) }, get_loc_size( x ) );
-        return reduce_inst_( get_loc_size( x ), vt_.get_raw_ptr( helper_ ), scalar_type{ 0 } );
+        return map_reduce_sum( get_loc_size( x ), sum_kernel{ vt_.get_raw_ptr( x ) } );
     }
     [[nodiscard]] scalar_type asum( const vector_type &x ) const
     {
-        verify_max_loc_size( get_loc_size( x ) );
-        for_each_inst_( asum_kernel{ vt_.get_raw_ptr( x ), vt_.get_raw_ptr( helper_ ) }, get_loc_size( x ) );
-        return reduce_inst_( get_loc_size( x ), vt_.get_raw_ptr( helper_ ), scalar_type{ 0 } );
+        return map_reduce_sum( get_loc_size( x ), asum_kernel{ vt_.get_raw_ptr( x ) } );
     }
 
     scalar_type normalize( vector_type &x ) const
@@ -231,6 +263,49 @@ public:
         );
     }
 
+    /// fused operations: each of them makes one sweep over data instead of two
+    // calc: y := mul_x*x + mul_y*y; returns (y,y) of the updated y
+    scalar_type axpy_dot( scalar_type mul_x, const vector_type &x, scalar_type mul_y, vector_type &y ) const
+    {
+        return map_reduce_sum(
+            get_loc_size( y ), add_lin_comb_2_dot_kernel{ mul_x, vt_.get_raw_ptr( x ), mul_y, vt_.get_raw_ptr( y ) }
+        );
+    }
+    // calc: res[0] := (x1,y), res[1] := (x2,y); res is host array
+    void dot2( const vector_type &x1, const vector_type &x2, const vector_type &y, scalar_type *res ) const
+    {
+        multi_map_reduce_sum(
+            get_loc_size( y ), scalar_prod_2_kernel{ vt_.get_raw_ptr( x1 ), vt_.get_raw_ptr( x2 ), vt_.get_raw_ptr( y ) }, 2,
+            res
+        );
+    }
+
+    // copy with conversion: y := x, where x belongs to space x_ops with other scalar type (for mixed precision solvers)
+    template <class OtherOperations>
+    void assign_convert( const OtherOperations &x_ops, const typename OtherOperations::vector_type &x, vector_type &y ) const
+    {
+        for_each_inst_(
+            kernels::assign_convert<typename OtherOperations::scalar_type, scalar_type>{
+                x_ops.get_raw_ptr( x ), vt_.get_raw_ptr( y )
+            },
+            get_loc_size( y )
+        );
+    }
+    // calc with conversion: y := mul_x*x + mul_y*y, where x belongs to space x_ops with other scalar type
+    template <class OtherOperations>
+    void add_lin_comb_convert(
+        scalar_type mul_x, const OtherOperations &x_ops, const typename OtherOperations::vector_type &x, scalar_type mul_y,
+        vector_type &y
+    ) const
+    {
+        for_each_inst_(
+            kernels::add_lin_comb_convert<typename OtherOperations::scalar_type, scalar_type>{
+                mul_x, x_ops.get_raw_ptr( x ), mul_y, vt_.get_raw_ptr( y )
+            },
+            get_loc_size( y )
+        );
+    }
+
     void make_abs_copy( const vector_type &x, vector_type &y ) const
     {
         for_each_inst_( make_abs_copy_kernel{ vt_.get_raw_ptr( x ), vt_.get_raw_ptr( y ) }, get_loc_size( x ) );
@@ -319,6 +394,116 @@ size_t argmax_element(vector_type& x)const
   return ret.second;
 }*/
 
+    /// multivector interface
+    void assign( const multivector_type &mx, Ordinal, Ordinal k_, vector_type &x ) const
+    {
+        assign( mx[k_], x );
+    }
+    void assign( const vector_type &x, multivector_type &mx, Ordinal, Ordinal k_ ) const
+    {
+        assign( x, mx[k_] );
+    }
+    [[nodiscard]] scalar_type scalar_prod( const multivector_type &mx, Ordinal, Ordinal k_, const vector_type &y ) const
+    {
+        return scalar_prod( mx[k_], y );
+    }
+    [[nodiscard]] scalar_type
+    scalar_prod_l2( const multivector_type &mx, Ordinal, Ordinal k_, const vector_type &y ) const
+    {
+        return scalar_prod( mx[k_], y );
+    }
+    void add_lin_comb(
+        scalar_type mul_x, const multivector_type &mx, Ordinal, Ordinal k_, scalar_type mul_y, vector_type &y
+    ) const
+    {
+        add_lin_comb( mul_x, mx[k_], mul_y, y );
+    }
+    // calc: mx[k_] := mul_x*x
+    void scale_assign( scalar_type mul_x, const vector_type &x, multivector_type &mx, Ordinal, Ordinal k_ ) const
+    {
+        assign_lin_comb( mul_x, x, mx[k_] );
+    }
+    // calc: y := mul_x*mx[k_] + mul_y*y; returns (y,y) of the updated y
+    scalar_type axpy_dot(
+        scalar_type mul_x, const multivector_type &mx, Ordinal, Ordinal k_, scalar_type mul_y, vector_type &y
+    ) const
+    {
+        return axpy_dot( mul_x, mx[k_], mul_y, y );
+    }
+    // calc: res[0] := (mx[k_],y), res[1] := (x,y); res is host array
+    void dot2(
+        const multivector_type &mx, Ordinal, Ordinal k_, const vector_type &x, const vector_type &y, scalar_type *res
+    ) const
+    {
+        dot2( mx[k_], x, y, res );
+    }
+    // calc: res[k-k0] := (mx[k],y) for k0 <= k < k1; res is host array
+    // columns are processed by blocks of multi_kernel_max_cols with a single sweep over y per block
+    void multi_scalar_prod(
+        const multivector_type &mx, Ordinal, Ordinal k0, Ordinal k1, const vector_type &y, scalar_type *res
+    ) const
+    {
+        if ( k0 >= k1 )
+        {
+            return;
+        }
+        for ( Ordinal kb = k0; kb < k1; kb += multi_kernel_max_cols )
+        {
+            multi_scalar_prod_kernel kernel;
+            kernel.cols = static_cast<int>( std::min<Ordinal>( multi_kernel_max_cols, k1 - kb ) );
+            kernel.y    = vt_.get_raw_ptr( y );
+            for ( int j = 0; j < kernel.cols; ++j )
+            {
+                kernel.x[j] = vt_.get_raw_ptr( mx[kb + j] );
+            }
+            multi_map_reduce_sum( get_loc_size( y ), kernel, kernel.cols, res + ( kb - k0 ) );
+        }
+    }
+    // calc: res[(l-l0)*(k1-k0) + (k-k0)] := (mx[k],my[l]) for k0 <= k < k1, l0 <= l < l1; res is host array
+    // (column-major block of Gram matrix)
+    void multi_scalar_prod(
+        const multivector_type &mx, Ordinal m, Ordinal k0, Ordinal k1, const multivector_type &my, Ordinal,
+        Ordinal l0, Ordinal l1, scalar_type *res
+    ) const
+    {
+        for ( Ordinal l = l0; l < l1; ++l )
+        {
+            multi_scalar_prod( mx, m, k0, k1, my[l], res + ( l - l0 ) * ( k1 - k0 ) );
+        }
+    }
+    reduction_handle multi_scalar_prod_async(
+        const multivector_type &mx, Ordinal m, Ordinal k0, Ordinal k1, const vector_type &y, scalar_type *res
+    ) const
+    {
+        multi_scalar_prod( mx, m, k0, k1, y, res );
+        return reduction_handle();
+    }
+    // calc: y := mul_y*y + sum_k mul_x[k-k0]*mx[k] for k0 <= k < k1; mul_x is host array
+    void multi_add_lin_comb(
+        const scalar_type *mul_x, const multivector_type &mx, Ordinal, Ordinal k0, Ordinal k1, scalar_type mul_y,
+        vector_type &y
+    ) const
+    {
+        if ( k0 >= k1 )
+        {
+            scale( mul_y, y );
+            return;
+        }
+        for ( Ordinal kb = k0; kb < k1; kb += multi_kernel_max_cols )
+        {
+            multi_add_lin_comb_kernel kernel;
+            kernel.cols  = static_cast<int>( std::min<Ordinal>( multi_kernel_max_cols, k1 - kb ) );
+            kernel.mul_y = ( kb == k0 ? mul_y : scalar_type{ 1 } );
+            kernel.y     = vt_.get_raw_ptr( y );
+            for ( int j = 0; j < kernel.cols; ++j )
+            {
+                kernel.mul_x[j] = mul_x[kb + j - k0];
+                kernel.x[j]     = vt_.get_raw_ptr( mx[kb + j] );
+            }
+            for_each_inst_( kernel, get_loc_size( y ) );
+        }
+    }
+
     void assign_random( vector_type &x, const scalar_type from = 0, const scalar_type to = 1 ) const
     {
         unsigned int seed = static_cast<unsigned int>( std::rand() );
@@ -339,19 +524,66 @@ size_t argmax_element(vector_type& x)const
     }
 
 protected:
+    // helper_ is temporary array for reductions on backends without transform_reduce; allocated on first demand
     void verify_max_loc_size( size_t loc_size ) const
     {
         if ( vt_.get_loc_size( helper_ ) < loc_size )
         {
-            vt_.dealloc( helper_ );
+            if ( vt_.get_loc_size( helper_ ) > 0 )
+            {
+                vt_.dealloc( helper_ );
+            }
             vt_.alloc( loc_size, helper_ );
         }
     }
 
-    mutable VectorTraits vt_;
-    mutable vector_type  helper_;
-    for_each_type        for_each_inst_;
-    reduce_type          reduce_inst_;
+    // calc: sum_{idx < size} f(idx) in one sweep if possible
+    template <class Map>
+    scalar_type map_reduce_sum( Ordinal size, const Map &f ) const
+    {
+        if constexpr ( transform_reduce_traits::is_available )
+        {
+            return transform_reduce_inst_( size, f, scalar_type{ 0 }, kernels::plus_op{} );
+        }
+        else
+        {
+            verify_max_loc_size( size );
+            for_each_inst_( kernels::map_assign<Map, scalar_type>{ f, vt_.get_raw_ptr( helper_ ) }, size );
+            return reduce_inst_( size, vt_.get_raw_ptr( helper_ ), scalar_type{ 0 } );
+        }
+    }
+    // calc: res[j] := sum_{idx < size} f(idx)[j] for j < cols; res is host array
+    template <class Map>
+    void multi_map_reduce_sum( Ordinal size, const Map &f, int cols, scalar_type *res ) const
+    {
+        if constexpr ( transform_reduce_traits::is_available )
+        {
+            using value_type      = decltype( f( Ordinal( 0 ) ) );
+            const value_type zero = value_type{};
+            const value_type sums = transform_reduce_inst_( size, f, zero, kernels::plus_op{} );
+            for ( int j = 0; j < cols; ++j )
+            {
+                res[j] = sums[j];
+            }
+        }
+        else
+        {
+            verify_max_loc_size( cols * size );
+            for_each_inst_(
+                kernels::multi_map_assign<Map, scalar_type>{ f, cols, vt_.get_raw_ptr( helper_ ), size }, size
+            );
+            for ( int j = 0; j < cols; ++j )
+            {
+                res[j] = reduce_inst_( size, vt_.get_raw_ptr( helper_ ) + j * size, scalar_type{ 0 } );
+            }
+        }
+    }
+
+    mutable VectorTraits  vt_;
+    mutable vector_type   helper_;
+    for_each_type         for_each_inst_;
+    reduce_type           reduce_inst_;
+    transform_reduce_type transform_reduce_inst_;
 };
 
 } // namespace operations
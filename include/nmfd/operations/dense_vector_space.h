@@ -17,6 +17,7 @@ class dense_vector_space : public dense_vector_operations<VectorTraits, Backend,
 {
 public:
     using vector_type = typename VectorTraits::vector_type;
+    using multivector_type = typename dense_vector_operations<VectorTraits, Backend, Ordinal>::multivector_type;
     using parent_t    = dense_vector_operations<VectorTraits, Backend, Ordinal>;
 
 public:
@@ -65,6 +66,29 @@ public:
     {
     }
 
+    void init_multivector( multivector_type &x, Ordinal m ) const
+    {
+        x.resize( m );
+        for ( Ordinal i = 0; i < m; ++i )
+        {
+            init_vector( x[i] );
+        }
+    }
+    void free_multivector( multivector_type &x, Ordinal m ) const
+    {
+        for ( Ordinal i = 0; i < m; ++i )
+        {
+            free_vector( x[i] );
+        }
+        x.clear();
+    }
+    void start_use_multivector( multivector_type &x, Ordinal m ) const
+    {
+    }
+    void stop_use_multivector( multivector_type &x, Ordinal m ) const
+    {
+    }
+
     [[nodiscard]] size_t size() const
     {
         return parent_t::vt_.size();
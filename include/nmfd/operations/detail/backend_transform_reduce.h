@@ -0,0 +1,62 @@
+#ifndef __NMFD_OPERATIONS_DETAIL_BACKEND_TRANSFORM_REDUCE_H__
+#define __NMFD_OPERATIONS_DETAIL_BACKEND_TRANSFORM_REDUCE_H__
+
+#include <utility>
+#ifdef PLATFORM_SERIAL_CPU
+#include <scfd/backend/backend.h>
+#endif
+
+namespace nmfd
+{
+namespace operations
+{
+namespace detail
+{
+
+// transform_reduce( size, f, init, op ) = op( init, f(0) op f(1) op ... op f(size-1) ) without temporary arrays
+struct serial_cpu_transform_reduce
+{
+    template <class Ordinal, class Func, class T, class BinaryOp>
+    T operator()( Ordinal size, const Func &f, T init_val, BinaryOp op ) const
+    {
+        T res = init_val;
+        for ( Ordinal i = 0; i < size; ++i )
+        {
+            res = op( res, f( i ) );
+        }
+        return res;
+    }
+};
+
+// is_available is true if transform_reduce is known for the Backend: either Backend::transform_reduce_type
+// is defined or it is serial cpu backend of scfd; otherwise reductions go through temporary array and reduce_type
+template <class Backend, class = int>
+struct backend_transform_reduce
+{
+    static constexpr bool is_available = false;
+    struct type
+    {
+    };
+};
+
+template <class Backend>
+struct backend_transform_reduce<Backend, decltype( (void)sizeof( typename Backend::transform_reduce_type ), int( 0 ) )>
+{
+    static constexpr bool is_available = true;
+    using type                         = typename Backend::transform_reduce_type;
+};
+
+#ifdef PLATFORM_SERIAL_CPU
+template <>
+struct backend_transform_reduce<scfd::backend::serial_cpu, int>
+{
+    static constexpr bool is_available = true;
+    using type                         = serial_cpu_transform_reduce;
+};
+#endif
+
+} // namespace detail
+} // namespace operations
+} // namespace nmfd
+
+#endif
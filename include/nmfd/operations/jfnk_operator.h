@@ -0,0 +1,171 @@
+#ifndef __NMFD_JFNK_OPERATOR_H__
+#define __NMFD_JFNK_OPERATOR_H__
+
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <nmfd/detail/vector_wrap.h>
+
+namespace nmfd
+{
+namespace operations
+{
+
+/**
+*   Jacobian-free linear operator: action of the jacobian of NonlinearOperator at the linearization point x0
+*   is approximated by finite difference directional derivative
+*
+*   J(x0) v ~ (F(x0 + eps*v) - F(x0))/eps,   eps = rel_perturbation*sqrt(1 + ||x0||)/||v||
+*
+*   (same choice of eps as in NITSOL). F(x0) and ||x0|| are calculated once per linearization point,
+*   so each apply costs one evaluation of F. Fits LinearOperator concept, so can be used as linear_operator_type
+*   of krylov solvers (gmres, etc.).
+*   NonlinearOperator must have apply(const vector_type &x, vector_type &f) const.
+*/
+template<class VectorSpace, class NonlinearOperator>
+class jfnk_operator
+{
+public:
+    using scalar_type = typename VectorSpace::scalar_type;
+    using vector_type = typename VectorSpace::vector_type;
+    using vector_space_type = VectorSpace;
+    using nonlinear_operator_type = NonlinearOperator;
+
+    static scalar_type default_rel_perturbation()
+    {
+        return std::sqrt(std::numeric_limits<scalar_type>::epsilon());
+    }
+
+public:
+    jfnk_operator(
+        std::shared_ptr<VectorSpace> space, std::shared_ptr<const NonlinearOperator> nonlin_op,
+        scalar_type rel_perturbation = default_rel_perturbation()
+    ) :
+        space_(std::move(space)), nonlin_op_(std::move(nonlin_op)), rel_perturbation_(rel_perturbation),
+        x0_(*space_), F0_(*space_), w_(*space_), Fw_(*space_), x0_norm_(0), is_linearized_(false)
+    {
+    }
+
+    const std::shared_ptr<vector_space_type> &get_dom_space()const
+    {
+        return space_;
+    }
+    const std::shared_ptr<vector_space_type> &get_im_space()const
+    {
+        return space_;
+    }
+
+    void set_linearization_point(const vector_type &x)
+    {
+        space_->assign(x, *x0_);
+        nonlin_op_->apply(*x0_, *F0_);
+        x0_norm_ = space_->norm(*x0_);
+        is_linearized_ = true;
+    }
+    /// Fx = F(x) is already known (for example from newton convergence check)
+    void set_linearization_point(const vector_type &x, const vector_type &Fx)
+    {
+        space_->assign(x, *x0_);
+        space_->assign(Fx, *F0_);
+        x0_norm_ = space_->norm(*x0_);
+        is_linearized_ = true;
+    }
+    bool is_linearized()const
+    {
+        return is_linearized_;
+    }
+
+    void set_rel_perturbation(scalar_type rel_perturbation)
+    {
+        rel_perturbation_ = rel_perturbation;
+    }
+    scalar_type rel_perturbation()const
+    {
+        return rel_perturbation_;
+    }
+
+    /// f := J(x0) v
+    void apply(const vector_type& v, vector_type& f)const
+    {
+        if(!is_linearized_)
+        {
+            throw std::logic_error("jfnk_operator::apply: linearization point is not set");
+        }
+        scalar_type v_norm = space_->norm(v);
+        if(v_norm == scalar_type(0))
+        {
+            space_->assign_scalar(scalar_type(0), f);
+            return;
+        }
+        scalar_type eps = rel_perturbation_*std::sqrt(scalar_type(1) + x0_norm_)/v_norm;
+        space_->assign_lin_comb(scalar_type(1), *x0_, eps, v, *w_); // w = x0 + eps*v
+        nonlin_op_->apply(*w_, *Fw_);
+        space_->assign_lin_comb(scalar_type(1)/eps, *Fw_, -scalar_type(1)/eps, *F0_, f);
+    }
+
+private:
+    using vec_wrap_t = nmfd::detail::vector_wrap<VectorSpace,true,true>;
+
+    std::shared_ptr<VectorSpace> space_;
+    std::shared_ptr<const NonlinearOperator> nonlin_op_;
+    scalar_type rel_perturbation_;
+    vec_wrap_t x0_, F0_;
+    mutable vec_wrap_t w_, Fw_;
+    scalar_type x0_norm_;
+    bool is_linearized_;
+};
+
+/**
+*   Adapter which makes residual-only NonlinearOperator (with apply(x,f) const only) usable by newton_iteration:
+*   jacobi operator is jfnk_operator, so no jacobian is assembled or stored.
+*/
+template<class VectorSpace, class NonlinearOperator>
+class jfnk_system_operator
+{
+public:
+    using scalar_type = typename VectorSpace::scalar_type;
+    using vector_type = typename VectorSpace::vector_type;
+    using vector_space_type = VectorSpace;
+    using jacobi_operator_type = jfnk_operator<VectorSpace, NonlinearOperator>;
+
+public:
+    jfnk_system_operator(
+        std::shared_ptr<VectorSpace> space, std::shared_ptr<const NonlinearOperator> nonlin_op,
+        scalar_type rel_perturbation = jacobi_operator_type::default_rel_perturbation()
+    ) :
+        nonlin_op_(nonlin_op),
+        jacobi_(std::make_shared<jacobi_operator_type>(std::move(space), nonlin_op, rel_perturbation))
+    {
+    }
+
+    void apply(const vector_type &x, vector_type &f)const
+    {
+        nonlin_op_->apply(x, f);
+    }
+    void set_linearization_point(const vector_type &x)
+    {
+        jacobi_->set_linearization_point(x);
+    }
+    void set_linearization_point(const vector_type &x, const vector_type &Fx)
+    {
+        jacobi_->set_linearization_point(x, Fx);
+    }
+    std::shared_ptr<const jacobi_operator_type> get_jacobi_operator()const
+    {
+        return jacobi_;
+    }
+    const std::shared_ptr<jacobi_operator_type> &jacobi_operator()
+    {
+        return jacobi_;
+    }
+
+private:
+    std::shared_ptr<const NonlinearOperator> nonlin_op_;
+    std::shared_ptr<jacobi_operator_type> jacobi_;
+};
+
+} // namespace operations
+} // namespace nmfd
+
+#endif
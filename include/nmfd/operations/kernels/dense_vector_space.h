@@ -19,17 +19,103 @@ namespace operations
 namespace kernels
 {
 
+/************************************************************
+ * Reductions are written as maps idx -> value, which are
+ * combined by Backend::transform_reduce_type in one sweep
+ * (see detail/backend_transform_reduce.h). For backends without
+ * it map values are stored by map_assign/multi_map_assign
+ * and then reduced by Backend::reduce_type.
+ ************************************************************/
+
+// fixed size set of scalars, reduced component-wise by batched reductions
+template <class Scalar, int N>
+struct scalar_tuple
+{
+    Scalar v[N];
+
+    __DEVICE_TAG__ Scalar &operator[]( const int j )
+    {
+        return v[j];
+    }
+    __DEVICE_TAG__ const Scalar &operator[]( const int j ) const
+    {
+        return v[j];
+    }
+};
+
+template <class Scalar, int N>
+__DEVICE_TAG__ scalar_tuple<Scalar, N> operator+( const scalar_tuple<Scalar, N> &a, const scalar_tuple<Scalar, N> &b )
+{
+    scalar_tuple<Scalar, N> res;
+    for ( int j = 0; j < N; ++j )
+    {
+        res[j] = a[j] + b[j];
+    }
+    return res;
+}
+
+struct plus_op
+{
+    template <class T>
+    __DEVICE_TAG__ T operator()( const T &a, const T &b ) const
+    {
+        return a + b;
+    }
+};
+
+struct max_op
+{
+    template <class T>
+    __DEVICE_TAG__ T operator()( const T &a, const T &b ) const
+    {
+        return a < b ? b : a;
+    }
+};
+
+// z[idx] = f(idx)
+template <class Map, class Scalar>
+struct map_assign
+{
+    Map     f;
+    Scalar *z;
+
+    template <class Idx>
+    __DEVICE_TAG__ void operator()( const Idx idx )
+    {
+        z[idx] = f( idx );
+    }
+};
+
+// z[j*stride + idx] = f(idx)[j] for j < cols
+template <class Map, class Scalar>
+struct multi_map_assign
+{
+    Map            f;
+    int            cols;
+    Scalar        *z;
+    std::ptrdiff_t stride;
+
+    template <class Idx>
+    __DEVICE_TAG__ void operator()( const Idx idx )
+    {
+        const auto val = f( idx );
+        for ( int j = 0; j < cols; ++j )
+        {
+            z[j * stride + idx] = val[j];
+        }
+    }
+};
+
 template <class Scalar, class VectorType>
 struct scalar_prod
 {
     const Scalar *x;
     const Scalar *y;
-    Scalar       *z;
 
     template <class Idx>
-    __DEVICE_TAG__ void operator()( const Idx idx )
+    __DEVICE_TAG__ Scalar operator()( const Idx idx ) const
     {
-        z[idx] = x[idx] * y[idx];
+        return x[idx] * y[idx];
     }
 };
 
@@ -64,12 +150,11 @@ template <class Scalar, class VectorType>
 struct norm_inf
 {
     const Scalar *x;
-    Scalar       *z;
 
     template <class Idx>
-    __DEVICE_TAG__ void operator()( const Idx idx )
+    __DEVICE_TAG__ Scalar operator()( const Idx idx ) const
     {
-        z[idx] = scfd::utils::scalar_traits<Scalar>::abs( x[idx] );
+        return scfd::utils::scalar_traits<Scalar>::abs( x[idx] );
     }
 };
 
@@ -77,12 +162,11 @@ template <class Scalar, class VectorType>
 struct sum
 {
     const Scalar *x;
-    Scalar       *z;
 
     template <class Idx>
-    __DEVICE_TAG__ void operator()( const Idx idx )
+    __DEVICE_TAG__ Scalar operator()( const Idx idx ) const
     {
-        z[idx] = x[idx];
+        return x[idx];
     }
 };
 
@@ -90,12 +174,11 @@ template <class Scalar, class VectorType>
 struct asum
 {
     const Scalar *x;
-    Scalar       *z;
 
     template <class Idx>
-    __DEVICE_TAG__ void operator()( const Idx idx )
+    __DEVICE_TAG__ Scalar operator()( const Idx idx ) const
     {
-        z[idx] = scfd::utils::scalar_traits<Scalar>::abs( x[idx] );
+        return scfd::utils::scalar_traits<Scalar>::abs( x[idx] );
     }
 };
 
@@ -112,6 +195,36 @@ struct assign
     }
 };
 
+// y = x with conversion of scalar type (e.g. between double and float vector spaces)
+template <class ScalarX, class Scalar>
+struct assign_convert
+{
+    const ScalarX *x;
+    Scalar        *y;
+
+    template <class Idx>
+    __DEVICE_TAG__ void operator()( const Idx idx )
+    {
+        y[idx] = static_cast<Scalar>( x[idx] );
+    }
+};
+
+// y = mul_x*x + mul_y*y, x is converted to the scalar type of y before multiplication
+template <class ScalarX, class Scalar>
+struct add_lin_comb_convert
+{
+    Scalar         mul_x;
+    const ScalarX *x;
+    Scalar         mul_y;
+    Scalar        *y;
+
+    template <class Idx>
+    __DEVICE_TAG__ void operator()( const Idx idx )
+    {
+        y[idx] = mul_x * static_cast<Scalar>( x[idx] ) + mul_y * y[idx];
+    }
+};
+
 template <class Scalar>
 struct assign_lin_comb_1
 {
@@ -293,6 +406,84 @@ struct assign_random
     }
 };
 
+// {x[j][idx]*y[idx]} for j < cols (zeros for the rest): one sweep over y for a block of columns
+template <class Scalar, int MaxCols>
+struct multi_scalar_prod
+{
+    const Scalar *x[MaxCols];
+    int           cols;
+    const Scalar *y;
+
+    template <class Idx>
+    __DEVICE_TAG__ scalar_tuple<Scalar, MaxCols> operator()( const Idx idx ) const
+    {
+        scalar_tuple<Scalar, MaxCols> res;
+        const Scalar                  y_idx = y[idx];
+        for ( int j = 0; j < MaxCols; ++j )
+        {
+            res[j] = ( j < cols ? x[j][idx] * y_idx : Scalar( 0 ) );
+        }
+        return res;
+    }
+};
+
+// y = mul_y*y + sum_j mul_x[j]*x[j] for j < cols
+template <class Scalar, int MaxCols>
+struct multi_add_lin_comb
+{
+    Scalar        mul_x[MaxCols];
+    const Scalar *x[MaxCols];
+    int           cols;
+    Scalar        mul_y;
+    Scalar       *y;
+
+    template <class Idx>
+    __DEVICE_TAG__ void operator()( const Idx idx )
+    {
+        Scalar res = mul_y * y[idx];
+        for ( int j = 0; j < cols; ++j )
+        {
+            res += mul_x[j] * x[j][idx];
+        }
+        y[idx] = res;
+    }
+};
+
+// y = mul_x*x + mul_y*y; returns y[idx]*y[idx] for the reduction to (y,y)
+// NOTE map with side effect: must be evaluated exactly once per idx (true for all reductions here)
+template <class Scalar>
+struct add_lin_comb_2_dot
+{
+    Scalar        mul_x;
+    const Scalar *x;
+    Scalar        mul_y;
+    Scalar       *y;
+
+    template <class Idx>
+    __DEVICE_TAG__ Scalar operator()( const Idx idx ) const
+    {
+        const Scalar y_idx = mul_x * x[idx] + mul_y * y[idx];
+        y[idx]             = y_idx;
+        return y_idx * y_idx;
+    }
+};
+
+// {x1[idx]*y[idx], x2[idx]*y[idx]}: two products with one read of y
+template <class Scalar>
+struct scalar_prod_2
+{
+    const Scalar *x1;
+    const Scalar *x2;
+    const Scalar *y;
+
+    template <class Idx>
+    __DEVICE_TAG__ scalar_tuple<Scalar, 2> operator()( const Idx idx ) const
+    {
+        const Scalar y_idx = y[idx];
+        return scalar_tuple<Scalar, 2>{ { x1[idx] * y_idx, x2[idx] * y_idx } };
+    }
+};
+
 } // namespace kernels
 } // namespace operations
 } // namespace nmfd
@@ -0,0 +1,67 @@
+#ifndef __NMFD_REDUCTION_HANDLE_H__
+#define __NMFD_REDUCTION_HANDLE_H__
+
+#include <functional>
+#include <utility>
+
+namespace nmfd
+{
+namespace operations
+{
+
+/// Handle of nonblocking reduction started by *_async methods of VectorOperations.
+/// Results are written into host memory passed when reduction was started and are valid
+/// only after wait() returns. Default constructed handle corresponds to already finished reduction.
+/// Destructor waits for unfinished reduction, so results memory must outlive the handle.
+class reduction_handle
+{
+public:
+    reduction_handle() = default;
+    explicit reduction_handle(std::function<void()> finalize) : 
+        finalize_(std::move(finalize))
+    {
+    }
+    reduction_handle(const reduction_handle&) = delete;
+    reduction_handle &operator=(const reduction_handle&) = delete;
+    reduction_handle(reduction_handle &&h) noexcept : 
+        finalize_(std::move(h.finalize_))
+    {
+        h.finalize_ = nullptr;
+    }
+    reduction_handle &operator=(reduction_handle &&h) noexcept
+    {
+        if (this != &h)
+        {
+            wait();
+            finalize_ = std::move(h.finalize_);
+            h.finalize_ = nullptr;
+        }
+        return *this;
+    }
+    ~reduction_handle()
+    {
+        wait();
+    }
+
+    bool is_pending() const
+    {
+        return static_cast<bool>(finalize_);
+    }
+    void wait()
+    {
+        if (finalize_)
+        {
+            auto finalize = std::move(finalize_);
+            finalize_ = nullptr;
+            finalize();
+        }
+    }
+
+private:
+    std::function<void()> finalize_;
+};
+
+}
+}
+
+#endif
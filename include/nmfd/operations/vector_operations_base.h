@@ -3,6 +3,7 @@
 
 //#include <map>
 #include <utility>
+#include "reduction_handle.h"
 //#include <scfd/utils/logged_obj_base.h>
 
 
@@ -51,11 +52,18 @@ public:
     [[nodiscard]] virtual scalar_type scalar_prod(const multivector_type& mx, Ord m, Ord k_, const vector_type &y)const = 0;
     [[nodiscard]] virtual scalar_type scalar_prod_l2(const multivector_type& mx, Ord m, Ord k_, const vector_type &y)const = 0;
     virtual void add_lin_comb(const scalar_type mul_x, const multivector_type& mx, Ord m, Ord k_, const scalar_type mul_y, vector_type& y) const = 0;
+    //calc: res[k-k0] := (mx[k],y) for k0 <= k < k1; res is host array of size k1-k0
+    virtual void multi_scalar_prod(const multivector_type& mx, Ord m, Ord k0, Ord k1, const vector_type &y, scalar_type *res)const = 0;
+    //calc: y := mul_y*y + sum_k mul_x[k-k0]*mx[k] for k0 <= k < k1; mul_x is host array of size k1-k0
+    virtual void multi_add_lin_comb(const scalar_type *mul_x, const multivector_type& mx, Ord m, Ord k0, Ord k1, const scalar_type mul_y, vector_type& y) const = 0;
+    //nonblocking versions of reductions: results are written into res and are valid after returned handle wait()
+    virtual reduction_handle multi_scalar_prod_async(const multivector_type& mx, Ord m, Ord k0, Ord k1, const vector_type &y, scalar_type *res)const = 0;
 
     [[nodiscard]] virtual bool is_valid_number(const vector_type &x) const = 0;
     //reduction operations:
     [[nodiscard]] virtual scalar_type scalar_prod(const vector_type &x, const vector_type &y)const = 0;
     [[nodiscard]] virtual scalar_type scalar_prod_l2(const vector_type &x, const vector_type &y)const = 0;
+    virtual reduction_handle scalar_prod_async(const vector_type &x, const vector_type &y, scalar_type *res)const = 0;
     [[nodiscard]] virtual scalar_type sum(const vector_type &x)const = 0;
     
     [[nodiscard]] virtual scalar_type asum(const vector_type &x)const = 0;
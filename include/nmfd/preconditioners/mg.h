@@ -24,6 +24,7 @@
 #include <nlohmann/json.hpp>
 #endif
 #include <nmfd/detail/vector_wrap.h>
+#include <nmfd/detail/mg_fused_hooks.h>
 //#include <glued_matrix_operator.h>
 #include "preconditioner_interface.h"
 
@@ -75,21 +76,61 @@ public:
         std::string out_prefix;
         bool set_direct_coarse_matrix_defect;
         bool regularize_after_direct_coarse;
+        /// number of consecutive update_operator calls after a coarse levels refresh for which coarse operators,
+        /// smoothers and coarse solver are kept as is (only the finest level gets the new operator); 0 refreshes every time
+        std::size_t coarse_freeze_updates;
+        /// use extended level interface (see detail/mg_fused_hooks.h) when Smoother, Restrictor, Prolongator provide it:
+        /// smoothing sweep with residual update, first sweep from zero initial guess, restriction of residual
+        /// calculated on the fly and prolongation with addition are done in one pass over fine vectors each
+        bool fused_kernels;
+        /// "standard" - cycle_type coarse level visits per level (1 - V-cycle, 2 - W-cycle);
+        /// "F" - F-cycle: coarse level is visited by F-cycle followed by V-cycle;
+        /// "K" - K-cycle: coarse level correction is accelerated by kcycle_max_iters (1 or 2) flexible Krylov
+        /// iterations with coarse operator, preconditioned by K-cycle on the coarse level. It makes mg
+        /// a nonlinear preconditioner, so flexible outer solver (fgmres) is preferable.
+        std::string cycle_kind;
+        std::string kcycle_method; //"fcg" (symmetric positive definite operators) or "gcr" (minimal residual)
+        std::size_t kcycle_max_iters;
+        /// second Krylov iteration is skipped if the first one reduced coarse residual by this factor
+        T kcycle_tol;
+        /// "cycle" - apply makes one cycle from zero initial guess (preconditioner);
+        /// "fmg" - apply is full multigrid solve (see solve_fmg), so mg can be used as standalone solver
+        std::string mode;
+        /// cycles made on each level after interpolation from the coarser one in full multigrid
+        std::size_t fmg_cycles;
 
         params(const std::string &log_prefix = "", const std::string &log_name = "mg::") : 
             logged_obj_params_t(0, log_prefix+log_name),
             max_levels(25), cycle_type(1), num_sweeps_pre(1), num_sweeps_post(1),
             direct_coarse(true), out_prefix("mg_"),
-            set_direct_coarse_matrix_defect(false), regularize_after_direct_coarse(false)
+            set_direct_coarse_matrix_defect(false), regularize_after_direct_coarse(false),
+            coarse_freeze_updates(0), fused_kernels(true),
+            cycle_kind("standard"), kcycle_method("fcg"), kcycle_max_iters(2), kcycle_tol(0.25),
+            mode("cycle"), fmg_cycles(1)
         {
         }
         #ifdef NMFD_ENABLE_NLOHMANN
         void from_json(const nlohmann::json& j)
         {
+            coarse_freeze_updates = j.value("coarse_freeze_updates", coarse_freeze_updates);
+            fused_kernels = j.value("fused_kernels", fused_kernels);
+            cycle_kind = j.value("cycle_kind", cycle_kind);
+            kcycle_method = j.value("kcycle_method", kcycle_method);
+            kcycle_max_iters = j.value("kcycle_max_iters", kcycle_max_iters);
+            kcycle_tol = j.value("kcycle_tol", kcycle_tol);
+            mode = j.value("mode", mode);
+            fmg_cycles = j.value("fmg_cycles", fmg_cycles);
         }
         nlohmann::json to_json() const
         {
-            return nlohmann::json();
+            return 
+                nlohmann::json
+                {
+                    {"coarse_freeze_updates", coarse_freeze_updates}, {"fused_kernels", fused_kernels},
+                    {"cycle_kind", cycle_kind}, {"kcycle_method", kcycle_method},
+                    {"kcycle_max_iters", kcycle_max_iters}, {"kcycle_tol", kcycle_tol},
+                    {"mode", mode}, {"fmg_cycles", fmg_cycles}
+                };
         }
         #endif
     };
@@ -155,17 +196,66 @@ public:
     };
 
     mg(const utils_hierarchy &u, const params_hierarchy &p) : 
-        logged_obj_t(u.log, p), utils_(u), prm_(p)
+        logged_obj_t(u.log, p), utils_(u), prm_(p), cycle_kind_(cycle_kind_from_params(p)), mode_(mode_from_params(p)),
+        kcycle_min_res_(p.kcycle_method == "gcr")
     {
+        if ((cycle_kind_ == cycle_kind_t::k)&&(prm_.kcycle_method != "fcg")&&(prm_.kcycle_method != "gcr"))
+            throw std::logic_error("mg: unknown kcycle_method " + prm_.kcycle_method);
+        if ((cycle_kind_ == cycle_kind_t::k)&&((prm_.kcycle_max_iters < 1)||(prm_.kcycle_max_iters > 2)))
+            throw std::logic_error("mg: kcycle_max_iters must be 1 or 2");
     }
     ~mg()
     {
     }
 
+    /// builds hierarchy on the first call, later calls only update operator (see update_operator)
     void set_operator(std::shared_ptr<const operator_type> op)
     {
+        if (levs_.empty())
+            build(op);
+        else
+            update_operator(op);
+    }
+    /// Numeric-only refresh for operator with the same structure (for example new newton jacobian):
+    /// levels, transfer operators, buffers, smoothers and coarse solver are kept, coarse operators are
+    /// recalculated by Coarsening::coarse_operator and passed to set_operator of smoothers and coarse solver.
+    /// Coarse levels are refreshed only on every (coarse_freeze_updates+1)-th call.
+    void update_operator(std::shared_ptr<const operator_type> op)
+    {
+        if (levs_.empty())
+            throw std::logic_error("mg::update_operator: levels are not built");
+
+        levs_[0].update(op);
+        if (levs_.size() == 1)
+            return;
+        if (updates_since_coarse_refresh_ < prm_.coarse_freeze_updates)
+        {
+            ++updates_since_coarse_refresh_;
+            return;
+        }
+        for (std::size_t levi = 0; levi+1 < levs_.size(); ++levi)
+        {
+            auto &curr = levs_[levi];
+            levs_[levi+1].update(coarsening_->coarse_operator(*curr.sys_operator, *curr.restrictor, *curr.prolongator));
+        }
+        updates_since_coarse_refresh_ = 0;
+        ++coarse_refreshes_num_;
+    }
+    /// drops current hierarchy and builds new one (for operator with changed structure)
+    void rebuild(std::shared_ptr<const operator_type> op)
+    {
+        levs_.clear();
         build(op);
     }
+    std::size_t levels_num()const
+    {
+        return levs_.size();
+    }
+    /// number of coarse levels refreshes made by update_operator
+    int coarse_refreshes_num()const
+    {
+        return coarse_refreshes_num_;
+    }
 
     void apply(const vector_type &rhs, vector_type &x) const 
     {
@@ -173,7 +263,10 @@ public:
             throw std::logic_error("mg::apply: levels are empty");
 
         levs_[0].vec_sp->assign(rhs, *levs_[0].rhs);
-        cycle(0);
+        if (mode_ == mode_t::fmg)
+            fmg();
+        else
+            cycle(0, cycle_kind_);
         levs_[0].vec_sp->assign(*levs_[0].x, x);
     }
 
@@ -184,13 +277,33 @@ public:
             throw std::logic_error("mg::apply: levels are empty");
 
         levs_[0].vec_sp->assign(x, *levs_[0].rhs);
-        cycle(0);
+        if (mode_ == mode_t::fmg)
+            fmg();
+        else
+            cycle(0, cycle_kind_);
+        levs_[0].vec_sp->assign(*levs_[0].x, x);
+    }
+
+    /// Full multigrid (nested iteration) solve, independent of mode: rhs is restricted down to the coarsest
+    /// level and solved there, then on each finer level the prolongated coarse solution is used as initial guess
+    /// for fmg_cycles cycles of cycle_kind. Reaches discretization error accuracy with work of a few cycles.
+    void solve_fmg(const vector_type &rhs, vector_type &x) const 
+    {
+        if (levs_.empty())
+            throw std::logic_error("mg::solve_fmg: levels are empty");
+
+        levs_[0].vec_sp->assign(rhs, *levs_[0].rhs);
+        fmg();
         levs_[0].vec_sp->assign(*levs_[0].x, x);
     }
 
 private:
     //TODO make it true,false and add start_use helper class in apply
     using buf_arr_t = detail::vector_wrap<vector_space_type,true,true>;
+    using smoother_residual_hook_t = nmfd::detail::smoother_residual_hook<smoother_type,vector_type>;
+    using smoother_zero_guess_hook_t = nmfd::detail::smoother_zero_guess_hook<smoother_type,vector_type>;
+    using restrict_residual_hook_t = nmfd::detail::restrict_residual_hook<restrictor_type,operator_type,vector_type>;
+    using prolongate_add_hook_t = nmfd::detail::prolongate_add_hook<prolongator_type,vector_type>;
     struct level_t
     {
         std::shared_ptr<const operator_type> sys_operator;
@@ -202,11 +315,13 @@ private:
 
         std::shared_ptr<vector_space_type> vec_sp;
         buf_arr_t x,residual,rhs;
+        /// first K-cycle search direction and its operator image, allocated for K-cycle only
+        buf_arr_t kc,kv;
 
         level_t(std::shared_ptr<const operator_type> op, const utils_hierarchy &utils, const params_hierarchy &prm, bool create_coarse_solver = false) : 
             sys_operator(std::move(op)),
             vec_sp(sys_operator->get_dom_space()),
-            x(*vec_sp), residual(*vec_sp), rhs(*vec_sp)
+            x(*vec_sp), residual(*vec_sp), rhs(*vec_sp), kc(*vec_sp, false, false), kv(*vec_sp, false, false)
         {
             smoother = algo_hierarchy_creator<smoother_type>::get(utils.smoother,prm.smoother);
             smoother->set_operator(sys_operator);
@@ -216,6 +331,18 @@ private:
                 coarse_solver->set_operator(sys_operator);
             }
         }
+        void update(std::shared_ptr<const operator_type> op)
+        {
+            sys_operator = std::move(op);
+            smoother->set_operator(sys_operator);
+            if (coarse_solver)
+                coarse_solver->set_operator(sys_operator);
+        }
+        void init_krylov_buffers()
+        {
+            kc.init(); kc.start_use();
+            kv.init(); kv.start_use();
+        }
         level_t(const level_t&) = delete;
         level_t &operator=(const level_t&) = delete;
         level_t(level_t&&) = default;
@@ -243,19 +370,102 @@ private:
             smoother->apply(*residual);
             vec_sp->add_lin_comb(T(1), *residual, T(1), *x);
         }
+        /// First iteration from x = 0: x is not read, so it needs no zeroing, and residual is not needed
+        void make_first_iter()
+        {
+            vec_sp->assign(*rhs, *x);
+            smoother->apply(*x);
+        }
+        /// make_first_iter followed by calc_residual, in one sweep without operator apply if smoother supports it
+        void make_first_iter_and_residual(bool fused)
+        {
+            if (fused && smoother_zero_guess_hook_t::apply(*smoother, *rhs, *x, *residual))
+                return;
+            make_first_iter();
+            calc_residual();
+        }
+        /// make_iter followed by calc_residual, in one sweep if smoother supports it
+        void make_iter_and_residual(bool fused)
+        {
+            if (fused && smoother_residual_hook_t::apply(*smoother, *rhs, *x, *residual))
+                return;
+            make_iter();
+            calc_residual();
+        }
+        /// coarse_rhs = R*(rhs - A*x); fine residual is not stored if restrictor supports it
+        void restrict_residual(vector_type &coarse_rhs, bool fused)
+        {
+            if (fused && restrict_residual_hook_t::apply(*restrictor, *sys_operator, *rhs, *x, coarse_rhs))
+                return;
+            calc_residual();
+            restrictor->apply(*residual, coarse_rhs);
+        }
+        /// x += P*coarse_x; residual is used as temporary buffer if prolongator does not support it
+        void prolongate_add(const vector_type &coarse_x, bool fused)
+        {
+            if (fused && prolongate_add_hook_t::apply(*prolongator, coarse_x, *x))
+                return;
+            prolongator->apply(coarse_x, *residual);
+            vec_sp->add_lin_comb(T(1), *residual, T(1), *x);
+        }
     };
 
+    enum class cycle_kind_t { standard, v, f, k };
+
+    static cycle_kind_t cycle_kind_from_params(const params &p)
+    {
+        if (p.cycle_kind == "standard") return cycle_kind_t::standard;
+        if (p.cycle_kind == "F") return cycle_kind_t::f;
+        if (p.cycle_kind == "K") return cycle_kind_t::k;
+        throw std::logic_error("mg: unknown cycle_kind " + p.cycle_kind);
+    }
+
+    enum class mode_t { cycle, fmg };
+
+    static mode_t mode_from_params(const params &p)
+    {
+        if (p.mode == "cycle") return mode_t::cycle;
+        if (p.mode == "fmg") return mode_t::fmg;
+        throw std::logic_error("mg: unknown mode " + p.mode);
+    }
+
     utils_hierarchy utils_;
     params_hierarchy prm_;
+    cycle_kind_t cycle_kind_;
+    mode_t mode_;
+    /// kcycle_method is "gcr"
+    bool kcycle_min_res_;
     /// TODO mutable - because of rhs x residual?
     mutable std::vector<level_t> levs_;
+    /// kept after build for numeric refreshes of coarse operators
+    std::shared_ptr<coarsening_type> coarsening_;
+    std::size_t updates_since_coarse_refresh_ = 0;
+    int coarse_refreshes_num_ = 0;
 
     void build(std::shared_ptr<const operator_type> op)
     {
         if (!levs_.empty())
             throw std::logic_error("mg::build: levels are alredy built!");
-        
-        auto c = algo_hierarchy_creator<coarsening_type>::get(utils_.coarsening,prm_.coarsening);
+
+        build_levels(op);
+
+        //hierarchy may be cut by max_levels or by coarsening, K-cycle buffers are needed in any case
+        if (cycle_kind_ == cycle_kind_t::k)
+        {
+            for (std::size_t levi = 1; levi < levs_.size(); ++levi)
+            {
+                levs_[levi].init_krylov_buffers();
+            }
+        }
+
+        logged_obj_t::info_f("build complete: levels number = %d", levs_.size());
+    }
+
+    void build_levels(std::shared_ptr<const operator_type> op)
+    {
+        coarsening_ = algo_hierarchy_creator<coarsening_type>::get(utils_.coarsening,prm_.coarsening);
+        auto &c = coarsening_;
+        updates_since_coarse_refresh_ = 0;
 
         int lev_i = 0;
         auto curr_op = op;
@@ -296,21 +506,23 @@ private:
         {
             levs_.emplace_back( curr_op, utils_, prm_ );
         }
-
-        logged_obj_t::info_f("build complete: levels number = %d", levs_.size());
     }
 
-    void cycle(size_t levi) const
+    /// Visits level levi: improves x for rhs of the level. If x_is_zero, x is zero on entry; while it is known
+    /// to be zero x is not stored, first smoothing sweep writes it from rhs (and prolongation does if there are
+    /// no pre sweeps). Otherwise current x is used as initial guess.
+    void cycle(size_t levi, cycle_kind_t kind, bool x_is_zero = true) const
     {
         auto &curr = levs_[levi];
-
-        curr.vec_sp->assign_scalar(T(0), *curr.x);
-        curr.vec_sp->assign(*curr.rhs, *curr.residual);
+        const bool fused = prm_.fused_kernels;
 
         if (levi+1 == levs_.size()) 
         {
             if (curr.coarse_solver) 
             {
+                /// coarse solver is supposed to be (almost) exact, so it always solves from scratch
+                curr.vec_sp->assign_scalar(T(0), *curr.x);
+                curr.vec_sp->assign(*curr.rhs, *curr.residual);
                 curr.coarse_solver->apply(*curr.residual, *curr.x);
                 /*if (lvl->level_regularization) {
                     lvl->level_regularization->apply(x);
@@ -318,16 +530,23 @@ private:
             } 
             else 
             {
-                for (size_t i = 0; i < prm_.num_sweeps_pre;  ++i) 
+                const size_t sweeps_num = prm_.num_sweeps_pre + prm_.num_sweeps_post;
+                if (!x_is_zero)
                 {
-                    curr.make_iter();
                     curr.calc_residual();
                 }
-                for (size_t i = 0; i < prm_.num_sweeps_post; ++i) 
+                else if (sweeps_num == 0)
                 {
-                    curr.make_iter();
-                    ///TODO can remove last call but not very important for the last level
-                    curr.calc_residual();
+                    curr.vec_sp->assign_scalar(T(0), *curr.x);
+                }
+                for (size_t i = 0; i < sweeps_num; ++i) 
+                {
+                    ///TODO can remove last residual calculation but not very important for the last level
+                    if (x_is_zero)
+                        curr.make_first_iter_and_residual(fused);
+                    else
+                        curr.make_iter_and_residual(fused);
+                    x_is_zero = false;
                 }
             }
         } 
@@ -335,39 +554,154 @@ private:
         {
             auto &next = levs_[levi+1];
 
-            for (size_t j = 0; j < prm_.cycle_type; ++j) 
+            const size_t visits_num = (kind == cycle_kind_t::standard ? prm_.cycle_type : 1);
+            for (size_t j = 0; j < visits_num; ++j) 
             {
-                if (j > 0)
+                if (!x_is_zero)
                 {
                     curr.calc_residual();
                 }
 
                 for (size_t i = 0; i < prm_.num_sweeps_pre; ++i)
                 {
-                    curr.make_iter();
-                    curr.calc_residual();
+                    if ((i+1 == prm_.num_sweeps_pre)&&fused&&restrict_residual_hook_t::is_available)
+                    {
+                        /// residual after the last sweep is only needed restricted
+                        if (x_is_zero)
+                            curr.make_first_iter();
+                        else
+                            curr.make_iter();
+                        curr.restrict_residual(*next.rhs, fused);
+                    }
+                    else
+                    {
+                        if (x_is_zero)
+                            curr.make_first_iter_and_residual(fused);
+                        else
+                            curr.make_iter_and_residual(fused);
+                    }
+                    x_is_zero = false;
                     /*auto res_norm = curr.vec_sp->norm(*curr.residual);
                     logged_obj_t::info_f("cycle: level number = %d, pre_cycle res_norm = %e", levi, res_norm);*/
                 }
+                if (x_is_zero)
+                {
+                    curr.restrictor->apply(*curr.rhs, *next.rhs);
+                }
+                else if ((prm_.num_sweeps_pre == 0)||!(fused&&restrict_residual_hook_t::is_available))
+                {
+                    curr.restrictor->apply(*curr.residual, *next.rhs);
+                }
 
-                curr.restrictor->apply(*curr.residual, *next.rhs);
-
-                cycle(levi+1);
+                coarse_correction(levi+1, kind);
 
-                /// NOTE *curr.residual is used as tmp buffer here to not create extra buffers
-                curr.prolongator->apply(*next.x, *curr.residual);
-                curr.vec_sp->add_lin_comb(T(1), *curr.residual, T(1), *curr.x);
+                if (x_is_zero)
+                    curr.prolongator->apply(*next.x, *curr.x);
+                else
+                    curr.prolongate_add(*next.x, fused);
+                x_is_zero = false;
 
-                for (size_t i = 0; i < prm_.num_sweeps_post; ++i)
+                if (prm_.num_sweeps_post > 0)
                 {
                     curr.calc_residual();
+                }
+                for (size_t i = 0; i < prm_.num_sweeps_post; ++i)
+                {
                     /*auto res_norm = curr.vec_sp->norm(*curr.residual);
                     logged_obj_t::info_f("cycle: level number = %d, post_cycle res_norm = %e", levi, res_norm);*/
-                    curr.make_iter();
+                    /// residual after the last sweep is not used
+                    if (i+1 < prm_.num_sweeps_post)
+                        curr.make_iter_and_residual(fused);
+                    else
+                        curr.make_iter();
                 }
             }
         }
     }
+    /// levs_[0].x = full multigrid solution for levs_[0].rhs
+    void fmg() const
+    {
+        const size_t coarsest = levs_.size()-1;
+        for (size_t levi = 0; levi < coarsest; ++levi)
+        {
+            levs_[levi].restrictor->apply(*levs_[levi].rhs, *levs_[levi+1].rhs);
+        }
+        cycle(coarsest, cycle_kind_);
+        for (size_t levi = coarsest; levi-- > 0;)
+        {
+            auto &curr = levs_[levi];
+            curr.prolongator->apply(*levs_[levi+1].x, *curr.x);
+            /// coarse levels rhs are overwritten by the cycles, but they are not needed any more
+            for (size_t i = 0; i < prm_.fmg_cycles; ++i)
+            {
+                cycle(levi, cycle_kind_, false);
+            }
+        }
+    }
+    /// levs_[levi].x = approximate solution for levs_[levi].rhs from zero initial guess
+    void coarse_correction(size_t levi, cycle_kind_t kind) const
+    {
+        if (levi+1 == levs_.size())
+        {
+            cycle(levi, kind);
+            return;
+        }
+        switch (kind)
+        {
+        case cycle_kind_t::f:
+            cycle(levi, cycle_kind_t::f);
+            cycle(levi, cycle_kind_t::v, false);
+            break;
+        case cycle_kind_t::k:
+            krylov_correction(levi);
+            break;
+        default:
+            cycle(levi, kind);
+        }
+    }
+    /// K-cycle correction (Notay, Vassilevski): at most two flexible CG (or GCR) iterations for A*x = rhs
+    /// preconditioned by K-cycle on the same level; rhs of the level is destroyed
+    void krylov_correction(size_t levi) const
+    {
+        auto &lev = levs_[levi];
+        auto &vs = *lev.vec_sp;
+        const bool min_res = kcycle_min_res_;
+        /// (u,v) products: in A-norm sense (u = search direction) for fcg, residual norm sense (u = image) for gcr
+        auto prod = [&vs](const vector_type &u, const vector_type &v) { return vs.scalar_prod(u, v); };
+
+        cycle(levi, cycle_kind_t::k);
+        vs.assign(*lev.x, *lev.kc);
+        lev.sys_operator->apply(*lev.kc, *lev.kv);
+        const vector_type &u1 = (min_res ? *lev.kv : *lev.kc);
+        T rho1 = prod(u1, *lev.kv), alpha1 = prod(u1, *lev.rhs);
+        if (rho1 == T(0))
+            return;
+        if (prm_.kcycle_max_iters == 1)
+        {
+            vs.assign_lin_comb(alpha1/rho1, *lev.kc, *lev.x);
+            return;
+        }
+        T rhs_norm = vs.norm(*lev.rhs);
+        vs.add_lin_comb(-alpha1/rho1, *lev.kv, T(1), *lev.rhs);
+        if (vs.norm(*lev.rhs) <= prm_.kcycle_tol*rhs_norm)
+        {
+            vs.assign_lin_comb(alpha1/rho1, *lev.kc, *lev.x);
+            return;
+        }
+
+        cycle(levi, cycle_kind_t::k);
+        /// residual is free after the cycle, holds image of the second search direction
+        lev.sys_operator->apply(*lev.x, *lev.residual);
+        const vector_type &u2 = (min_res ? *lev.residual : *lev.x);
+        T gamma = prod(u2, *lev.kv), beta = prod(u2, *lev.residual), alpha2 = prod(u2, *lev.rhs);
+        T rho2 = beta - gamma*gamma/rho1;
+        if (rho2 == T(0))
+        {
+            vs.assign_lin_comb(alpha1/rho1, *lev.kc, *lev.x);
+            return;
+        }
+        vs.add_lin_comb(alpha1/rho1 - gamma*alpha2/(rho1*rho2), *lev.kc, alpha2/rho2, *lev.x);
+    }
 };
 
 
@@ -0,0 +1,324 @@
+// Copyright © 2016-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_ANDERSON_ITERATION_H__
+#define __NMFD_ANDERSON_ITERATION_H__
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <nmfd/detail/algo_hierarchy_macro.h>
+#include <nmfd/detail/algo_hierarchy_creator.h>
+#include "detail/dense_operations.h"
+#include "detail/fused_vector_ops.h"
+
+namespace nmfd
+{
+namespace solvers
+{
+
+/**
+*   Anderson accelerated fixed point iteration operator for nonlinear_solver (jacobian is not used).
+*   Underlying fixed point map is relaxed Picard (Richardson) iteration g(x) = x + mixing*f(x), f(x) = -F(x).
+*   With the last n <= depth differences dX = [x_{k-n+1}-x_{k-n},...], dF = [f_{k-n+1}-f_{k-n},...] step is
+*
+*   d_x = mixing*f_k - (dX + mixing*dF)*gamma,  gamma = argmin ||f_k - dF*gamma||.
+*
+*   dX is kept as ring buffer in multivector. dF itself is not stored: thin QR factorization dF = Q*R is updated
+*   instead (new column is orthogonalized against Q twice, the oldest one is removed by plane rotations, see
+*   dense_operations::qr_delete_first_column), then gamma = R^{-1}*Q^T*f_k and dF*gamma = Q*Q^T*f_k.
+*   Column is not added if it is (numerically) linearly dependent on previous ones (relative norm after
+*   orthogonalization is below drop_tol). History is cleared at the start of every nonlinear solve.
+*   NonlinearOperator must only have apply(const vector_type &x, vector_type &f) const.
+*/
+template
+<
+    class VectorSpace, class NonlinearOperator,
+    class DenseOperations = detail::dense_operations<typename VectorSpace::Ord, typename VectorSpace::scalar_type>
+>
+class anderson_iteration
+{
+    using T = typename VectorSpace::scalar_type;
+    using T_vec = typename VectorSpace::vector_type;
+    using T_mvec = typename VectorSpace::multivector_type;
+    using Ord = typename VectorSpace::Ord;
+    using dense_operations_t = DenseOperations;
+    using D_vec = typename dense_operations_t::vector_type;
+    using D_mat = typename dense_operations_t::matrix_type;
+public:
+    using scalar_type = typename VectorSpace::scalar_type;
+    using vector_type = typename VectorSpace::vector_type;
+    using vector_space_type = VectorSpace;
+
+    struct params
+    {
+        std::string log_msg_prefix;
+        int depth;
+        T mixing;
+        T drop_tol;
+
+        params(const std::string &log_prefix = "", const std::string & = "anderson_iteration::") :
+            log_msg_prefix(log_prefix), depth(5), mixing(T(1)), drop_tol(T(1.0e-10))
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            depth = j.value("depth", depth);
+            mixing = j.value("mixing", mixing);
+            drop_tol = j.value("drop_tol", drop_tol);
+        }
+        nlohmann::json to_json() const
+        {
+            return
+                nlohmann::json
+                {
+                    {"type", "anderson_iteration"},
+                    {"depth", depth},
+                    {"mixing", mixing},
+                    {"drop_tol", drop_tol}
+                };
+        }
+        #endif
+    };
+    struct utils
+    {
+        std::shared_ptr<VectorSpace> vec_space;
+        std::shared_ptr<dense_operations_t> dense_ops;
+        utils() = default;
+        utils(
+            std::shared_ptr<VectorSpace> vec_space_,
+            std::shared_ptr<dense_operations_t> dense_ops_ = std::make_shared<dense_operations_t>()
+        ) : vec_space(std::move(vec_space_)), dense_ops(std::move(dense_ops_))
+        {
+        }
+        template<class Backend>
+        utils(Backend &backend, std::shared_ptr<VectorSpace> vec_space_) : utils(vec_space_)
+        {
+        }
+    };
+    NMFD_ALGO_HIERARCHY_TYPES_DEFINE(anderson_iteration)
+
+    anderson_iteration(
+        std::shared_ptr<VectorSpace> vec_ops, const params &prm = params(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        vec_ops_(std::move(vec_ops)), dense_ops_(std::move(dense_ops)), prms_(prm)
+    {
+        if(prms_.depth < 0)
+        {
+            throw std::logic_error("anderson_iteration: depth must be non-negative");
+        }
+        m_ = static_cast<Ord>(prms_.depth);
+        vec_ops_->init_vector(f_); vec_ops_->start_use_vector(f_);
+        vec_ops_->init_vector(x_prev_); vec_ops_->start_use_vector(x_prev_);
+        vec_ops_->init_vector(f_prev_); vec_ops_->start_use_vector(f_prev_);
+        if(m_ > 0)
+        {
+            vec_ops_->init_vector(w1_); vec_ops_->start_use_vector(w1_);
+            vec_ops_->init_vector(w2_); vec_ops_->start_use_vector(w2_);
+            vec_ops_->init_vector(w3_); vec_ops_->start_use_vector(w3_);
+            vec_ops_->init_multivector(dX_, m_); vec_ops_->start_use_multivector(dX_, m_);
+            vec_ops_->init_multivector(Q_, m_); vec_ops_->start_use_multivector(Q_, m_);
+            dense_ops_->init(m_, m_);
+            dense_ops_->init_matrix(R_);
+            dense_ops_->init_col_vectors(h_, cs_, sn_);
+            coeffs_.resize(m_);
+            r_col_.resize(m_);
+        }
+        reset();
+    }
+    anderson_iteration(
+        const utils_hierarchy& utils,
+        const params_hierarchy& prm = params_hierarchy()
+    ) :
+        anderson_iteration(utils.vec_space, prm, utils.dense_ops)
+    {
+    }
+    ~anderson_iteration()
+    {
+        if(m_ > 0)
+        {
+            dense_ops_->free_matrix(R_);
+            dense_ops_->free_col_vectors(h_, cs_, sn_);
+            vec_ops_->stop_use_multivector(Q_, m_); vec_ops_->free_multivector(Q_, m_);
+            vec_ops_->stop_use_multivector(dX_, m_); vec_ops_->free_multivector(dX_, m_);
+            vec_ops_->stop_use_vector(w3_); vec_ops_->free_vector(w3_);
+            vec_ops_->stop_use_vector(w2_); vec_ops_->free_vector(w2_);
+            vec_ops_->stop_use_vector(w1_); vec_ops_->free_vector(w1_);
+        }
+        vec_ops_->stop_use_vector(f_prev_); vec_ops_->free_vector(f_prev_);
+        vec_ops_->stop_use_vector(x_prev_); vec_ops_->free_vector(x_prev_);
+        vec_ops_->stop_use_vector(f_); vec_ops_->free_vector(f_);
+    }
+
+    bool solve(NonlinearOperator &nonlin_op, const vector_type& x, vector_type& d_x)
+    {
+        nonlin_op.apply(x, f_);
+        vec_ops_->scale(T(-1), f_); // f = -F(x)
+        step(x, d_x);
+        return true;
+    }
+    /// picard residual -F(x) is formed from the given Fx
+    bool solve(NonlinearOperator &, const vector_type& x, const vector_type& Fx, vector_type& d_x)
+    {
+        vec_ops_->assign_lin_comb(T(-1), Fx, f_); // f = -F(x)
+        step(x, d_x);
+        return true;
+    }
+    /// called by nonlinear_solver at the start of every solve: history refers to the previous problem
+    void start_solve()
+    {
+        reset();
+    }
+    /// clears history, next step is plain relaxed Picard step
+    void reset()
+    {
+        has_prev_ = false;
+        n_ = 0;
+        head_ = 0;
+    }
+    /// number of differences currently used
+    int history_size()const
+    {
+        return static_cast<int>(n_);
+    }
+
+private:
+    std::shared_ptr<VectorSpace> vec_ops_;
+    std::shared_ptr<dense_operations_t> dense_ops_;
+    params prms_;
+    Ord m_;
+    T_vec f_, x_prev_, f_prev_, w1_, w2_, w3_;
+    T_mvec dX_, Q_;
+    D_mat R_;
+    D_vec h_, cs_, sn_;
+    //host buffers for batched inner products
+    std::vector<T> coeffs_, r_col_;
+    bool has_prev_;
+    Ord n_, head_;
+
+    /// physical column of dX_ for logical column i (0 is the oldest)
+    Ord dx_col(Ord i)const
+    {
+        return (head_ + i)%m_;
+    }
+
+    /// f_ contains f(x) = -F(x)
+    void step(const vector_type& x, vector_type& d_x)
+    {
+        if(m_ > 0)
+        {
+            if(has_prev_)
+            {
+                vec_ops_->add_lin_comb(T(1), x, T(-1), x_prev_); // x_prev_ = x_k - x_{k-1}
+                vec_ops_->add_lin_comb(T(1), f_, T(-1), f_prev_); // f_prev_ = f_k - f_{k-1}
+                append(x_prev_, f_prev_);
+            }
+            vec_ops_->assign(x, x_prev_);
+            vec_ops_->assign(f_, f_prev_);
+            has_prev_ = true;
+        }
+
+        vec_ops_->assign_lin_comb(prms_.mixing, f_, d_x);
+        if(n_ == 0)
+        {
+            return;
+        }
+        // h = Q^T*f; d_x -= mixing*Q*h
+        vec_ops_->multi_scalar_prod(Q_, m_, 0, n_, f_, coeffs_.data());
+        for(Ord i = 0; i < n_; ++i)
+        {
+            h_(i) = coeffs_[i];
+            coeffs_[i] *= -prms_.mixing;
+        }
+        vec_ops_->multi_add_lin_comb(coeffs_.data(), Q_, m_, 0, n_, T(1), d_x);
+        // gamma = R^{-1}*h; d_x -= dX*gamma
+        dense_ops_->solve_upper_triangular_subsystem(R_, h_, n_);
+        for(Ord i = 0; i < n_; ++i)
+        {
+            vec_ops_->add_lin_comb(-h_(i), dX_, m_, dx_col(i), T(1), d_x);
+        }
+    }
+
+    /// adds new column (dx, df) to the history; df is destroyed
+    void append(const T_vec &dx, T_vec &df)
+    {
+        if(n_ == m_)
+        {
+            delete_oldest();
+        }
+        const T df_norm = vec_ops_->norm(df);
+        if(!(df_norm > T(0)))
+        {
+            return;
+        }
+        // classical Gram-Schmidt with one reorthogonalization against Q(:,0:n)
+        for(Ord i = 0; i < n_; ++i)
+        {
+            r_col_[i] = T(0);
+        }
+        for(int pass = 0; (pass < 2)&&(n_ > 0); ++pass)
+        {
+            vec_ops_->multi_scalar_prod(Q_, m_, 0, n_, df, coeffs_.data());
+            for(Ord i = 0; i < n_; ++i)
+            {
+                r_col_[i] += coeffs_[i];
+                coeffs_[i] = -coeffs_[i];
+            }
+            vec_ops_->multi_add_lin_comb(coeffs_.data(), Q_, m_, 0, n_, T(1), df);
+        }
+        const T r_nn = vec_ops_->norm(df);
+        if(r_nn <= prms_.drop_tol*df_norm)
+        {
+            return;
+        }
+        for(Ord i = 0; i < n_; ++i)
+        {
+            R_(i, n_) = r_col_[i];
+        }
+        R_(n_, n_) = r_nn;
+        detail::fused_scale_assign<VectorSpace>::apply(*vec_ops_, T(1)/r_nn, df, Q_, m_, n_);
+        vec_ops_->assign(dx, dX_, m_, dx_col(n_));
+        ++n_;
+    }
+
+    void delete_oldest()
+    {
+        dense_ops_->qr_delete_first_column(R_, n_, cs_, sn_);
+        // Q(:,j:j+1) = Q(:,j:j+1)*G_j^T; w1_ carries rotated column j+1 to the next rotation,
+        // the last rotated column is dropped
+        if(n_ > 1)
+        {
+            vec_ops_->assign(Q_, m_, 0, w1_);
+        }
+        for(Ord j = 0; j+1 < n_; ++j)
+        {
+            vec_ops_->assign(Q_, m_, j+1, w2_);
+            vec_ops_->assign_lin_comb(cs_(j), w1_, sn_(j), w2_, w3_);
+            vec_ops_->assign(w3_, Q_, m_, j);
+            vec_ops_->add_lin_comb(cs_(j), w2_, -sn_(j), w1_);
+        }
+        head_ = (head_ + 1)%m_;
+        --n_;
+    }
+};
+
+}
+}
+
+#endif
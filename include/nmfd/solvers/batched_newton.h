@@ -0,0 +1,293 @@
+// Copyright © 2016-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_BATCHED_NEWTON_H__
+#define __NMFD_BATCHED_NEWTON_H__
+
+#include <cmath>
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <scfd/utils/logged_obj_base.h>
+#include <nmfd/detail/algo_hierarchy_macro.h>
+#include <nmfd/operations/batched_static_vector_space.h>
+#include "detail/batched_static_lu.h"
+
+namespace nmfd
+{
+namespace solvers
+{
+
+/**
+*   Newton solver for a batch of many small independent nonlinear systems of static size (one per cell etc.),
+*   replacing nonlinear_solver + newton_iteration + static_vector_space called system by system.
+*   Every stage (residual, jacobian, LU solve, line search, convergence check) is done for the whole batch
+*   at once on structure of arrays data of BatchedVectorSpace (operations::batched_static_vector_space), so
+*   loops run over systems and vectorize; systems are tracked by per lane status and step weights instead of
+*   separate solver objects, there are no monitors and nothing is logged per system or per iteration.
+*   Converged (or failed) systems get zero step weight and are left unchanged while the rest iterate.
+*
+*   SystemOperator must have
+*       void apply(const vector_type &x, vector_type &f)const;                  // f_b = F_b(x_b) for all b
+*       void assemble_jacobi(const vector_type &x, matrix_type &jacobi)const;    // jacobi_b = F_b'(x_b) for all b
+*
+*   Step weight is halved per system (at most max_halvings times) until ||F_b(x_b + w_b*dx_b)|| <=
+*   (1 - armijo_c*w_b)*||F_b(x_b)||; each trial costs one batched residual evaluation.
+*   System b is converged when ||F_b|| <= max(abs_tol, rel_tol*||F_b(x0_b)||).
+*/
+template<class BatchedVectorSpace, class SystemOperator, class Log>
+class batched_newton : public scfd::utils::logged_obj_base<Log>
+{
+    using T = typename BatchedVectorSpace::scalar_type;
+    using T_vec = typename BatchedVectorSpace::vector_type;
+    using T_mat = typename BatchedVectorSpace::matrix_type;
+    using lanes_t = typename BatchedVectorSpace::lanes_type;
+    using mask_t = typename BatchedVectorSpace::mask_type;
+    using logged_obj_t = scfd::utils::logged_obj_base<Log>;
+    using lu_t = detail::batched_static_lu<T,BatchedVectorSpace::dim>;
+public:
+    using scalar_type = typename BatchedVectorSpace::scalar_type;
+    using vector_type = typename BatchedVectorSpace::vector_type;
+    using matrix_type = typename BatchedVectorSpace::matrix_type;
+    using vector_space_type = BatchedVectorSpace;
+
+    /// per system result, see lane_status()
+    enum status_type : int
+    {
+        status_converged = 0,
+        status_in_progress = 1,
+        status_invalid_number = 2,
+        status_singular_jacobi = 3,
+        status_max_iters = 4
+    };
+
+    struct params : public logged_obj_t::params
+    {
+        int max_iters_num = 100;
+        T abs_tol = T(1.0e-10);
+        T rel_tol = T(0);
+        int max_halvings = 4;
+        T armijo_c = T(1.0e-4);
+        /// batch summary after each solve
+        bool verbose = false;
+
+        params(
+            const std::string &log_pefix = "", const std::string &log_name = "batched_newton::"
+        ) : logged_obj_t::params(0, log_pefix + log_name)
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            max_iters_num = j.value("max_iters_num", max_iters_num);
+            abs_tol = j.value("abs_tol", abs_tol);
+            rel_tol = j.value("rel_tol", rel_tol);
+            max_halvings = j.value("max_halvings", max_halvings);
+            armijo_c = j.value("armijo_c", armijo_c);
+            verbose = j.value("verbose", verbose);
+        }
+        nlohmann::json to_json() const
+        {
+            return
+                nlohmann::json
+                {
+                    {"type", "batched_newton"},
+                    {"max_iters_num", max_iters_num},
+                    {"abs_tol", abs_tol},
+                    {"rel_tol", rel_tol},
+                    {"max_halvings", max_halvings},
+                    {"armijo_c", armijo_c},
+                    {"verbose", verbose}
+                };
+        }
+        #endif
+    };
+    struct utils
+    {
+        std::shared_ptr<BatchedVectorSpace> vec_space;
+        Log *log;
+        utils() = default;
+        utils(
+            std::shared_ptr<BatchedVectorSpace> vec_space_, Log *log_ = nullptr
+        ) :
+            vec_space(vec_space_), log(log_)
+        {
+        }
+        template<class Backend>
+        utils(Backend &backend, std::shared_ptr<BatchedVectorSpace> vec_space) : utils(vec_space, &backend.log())
+        {
+        }
+    };
+    NMFD_ALGO_HIERARCHY_TYPES_DEFINE(batched_newton)
+
+    batched_newton(std::shared_ptr<BatchedVectorSpace> vec_ops, Log *log = nullptr, const params &prm = params()) :
+        logged_obj_t(log, prm), vec_ops_(std::move(vec_ops)), prms_(prm)
+    {
+        if((prms_.max_iters_num < 0)||(prms_.max_halvings < 0))
+        {
+            throw std::logic_error("batched_newton: max_iters_num and max_halvings must be non-negative");
+        }
+        n_ = vec_ops_->batch_size();
+        vec_ops_->init_vectors(f_, dx_, x_t_, f_t_);
+        vec_ops_->init_matrix(jacobi_);
+        vec_ops_->init_lanes(f_norm_);
+        vec_ops_->init_lanes(f0_norm_);
+        vec_ops_->init_lanes(f_t_norm_);
+        vec_ops_->init_lanes(w_);
+        vec_ops_->init_mask(ok_);
+        vec_ops_->init_mask(valid_);
+        lu_.init(n_);
+        status_.assign(n_, status_in_progress);
+        iters_.assign(n_, 0);
+    }
+    batched_newton(
+        const utils_hierarchy& utils,
+        const params_hierarchy& prm = params_hierarchy()
+    ) :
+        batched_newton(utils.vec_space, utils.log, prm)
+    {
+    }
+    ~batched_newton()
+    {
+        vec_ops_->free_matrix(jacobi_);
+        vec_ops_->free_vectors(f_, dx_, x_t_, f_t_);
+    }
+
+    /// inplace, x contains initial guess for all systems; returns true if all systems converged
+    bool solve(const SystemOperator &sys_op, vector_type &x)
+    {
+        for(std::size_t b = 0; b < n_; ++b)
+        {
+            status_[b] = status_in_progress;
+            iters_[b] = 0;
+        }
+        sys_op.apply(x, f_);
+        vec_ops_->norm(f_, f_norm_);
+        f0_norm_ = f_norm_;
+        std::size_t active_num = update_status();
+        for(int it = 0; (it < prms_.max_iters_num)&&(active_num > 0); ++it)
+        {
+            //dx_b = -J_b^{-1}*F_b
+            sys_op.assemble_jacobi(x, jacobi_);
+            vec_ops_->assign_lin_comb(T(-1), f_, dx_);
+            for(std::size_t b = 0; b < n_; ++b)
+            {
+                ok_[b] = static_cast<unsigned char>(1);
+            }
+            lu_.solve(jacobi_, dx_, ok_);
+            for(std::size_t b = 0; b < n_; ++b)
+            {
+                const bool active = (status_[b] == status_in_progress);
+                status_[b] = (active&&!ok_[b])?status_singular_jacobi:status_[b];
+                w_[b] = (active&&ok_[b])?T(1):T(0);
+                iters_[b] += active?1:0;
+            }
+            //per system backtracking, systems with zero weight just reevaluate F(x)
+            for(int h = 0; ; ++h)
+            {
+                vec_ops_->assign_lin_comb(T(1), x, w_, dx_, x_t_);
+                sys_op.apply(x_t_, f_t_);
+                vec_ops_->norm(f_t_, f_t_norm_);
+                if(h == prms_.max_halvings)
+                {
+                    break;
+                }
+                bool all_accepted = true;
+                for(std::size_t b = 0; b < n_; ++b)
+                {
+                    const bool reject = (w_[b] > T(0))&&!(f_t_norm_[b] <= (T(1) - prms_.armijo_c*w_[b])*f_norm_[b]);
+                    w_[b] = reject?w_[b]*T(0.5):w_[b];
+                    all_accepted = all_accepted&&!reject;
+                }
+                if(all_accepted)
+                {
+                    break;
+                }
+            }
+            vec_ops_->assign(x_t_, x);
+            vec_ops_->assign(f_t_, f_);
+            f_norm_.swap(f_t_norm_);
+            active_num = update_status();
+        }
+        std::size_t converged_num = 0;
+        int iters_max = 0;
+        for(std::size_t b = 0; b < n_; ++b)
+        {
+            status_[b] = (status_[b] == status_in_progress)?status_max_iters:status_[b];
+            converged_num += (status_[b] == status_converged)?1:0;
+            iters_max = (iters_[b] > iters_max)?iters_[b]:iters_max;
+        }
+        if(prms_.verbose)
+        {
+            logged_obj_t::info_f(
+                "converged %zu of %zu systems, max iterations: %i", converged_num, n_, iters_max
+            );
+        }
+        return converged_num == n_;
+    }
+
+    /// status_type of system b after the last solve
+    int lane_status(std::size_t b)const
+    {
+        return status_[b];
+    }
+    /// number of newton iterations made for system b in the last solve
+    int lane_iterations(std::size_t b)const
+    {
+        return iters_[b];
+    }
+    /// ||F_b|| at the end of the last solve
+    T lane_residual_norm(std::size_t b)const
+    {
+        return f_norm_[b];
+    }
+
+private:
+    std::shared_ptr<BatchedVectorSpace> vec_ops_;
+    params prms_;
+    std::size_t n_;
+    T_vec f_, dx_, x_t_, f_t_;
+    T_mat jacobi_;
+    lanes_t f_norm_, f0_norm_, f_t_norm_, w_;
+    mask_t ok_, valid_;
+    lu_t lu_;
+    std::vector<int> status_, iters_;
+
+    /// marks converged and invalid systems, returns number of systems still in progress
+    std::size_t update_status()
+    {
+        vec_ops_->check_is_valid_number(f_, valid_);
+        std::size_t active_num = 0;
+        for(std::size_t b = 0; b < n_; ++b)
+        {
+            const T tol = std::max(prms_.abs_tol, prms_.rel_tol*f0_norm_[b]);
+            const bool active = (status_[b] == status_in_progress);
+            int st = status_in_progress;
+            st = (f_norm_[b] <= tol)?status_converged:st;
+            st = valid_[b]?st:status_invalid_number;
+            status_[b] = active?st:status_[b];
+            active_num += (status_[b] == status_in_progress)?1:0;
+        }
+        return active_num;
+    }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,607 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_BLOCK_GMRES_H__
+#define __NMFD_BLOCK_GMRES_H__
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <limits>
+#ifdef NMFD_ENABLE_NLOHMANN
+#include <nlohmann/json.hpp>
+#endif
+#include "detail/block_apply.h"
+#include <nmfd/detail/algo_utils_hierarchy.h>
+#include <nmfd/detail/algo_params_hierarchy.h>
+#include <nmfd/detail/algo_hierarchy_creator.h>
+#include "iter_solver_base.h"
+#include "detail/dense_operations.h"
+#include "detail/gram_schmidt.h"
+#include "detail/givens_least_squares.h"
+#include "detail/krylov_hierarchy.h"
+#include "detail/residual_regularization_dummy.h"
+#include <nmfd/preconditioners/dummy.h>
+
+namespace nmfd
+{
+namespace solvers
+{
+
+/**
+ * Block GMRES for several right hand sides with the same operator (restarted, block Arnoldi process).
+ * solve_multi(A, B, X, n) advances n <= block_size systems together: each block step applies operator (and preconditioner)
+ * to block of n vectors, so operators with apply_multi(x, f, m, n) stream their data once per block (see detail::block_apply),
+ * and all right hand sides share one krylov space, which usually reduces total number of steps compared with separate solves.
+ * basis_size is the total number of krylov vectors, so restart happens after basis_size/n block steps.
+ * Block orthogonalization is done with classical Gram-Schmidt with reorthogonalization.
+ * Each right hand side has its own monitor (monitor(i)); converged columns are excluded at restarts,
+ * linearly dependent residuals are postponed to the next cycle.
+ * Template parameters demands are the same as for gmres.
+ **/
+
+template
+<
+     class VectorOperations, class Monitor, class Log,
+     class LinearOperator, class Preconditioner = preconditioners::dummy<VectorOperations,LinearOperator>,
+     class ResidualRegulariation = detail::residual_regularization_dummy,
+     class DenseOperations = detail::dense_operations<typename VectorOperations::Ord, typename VectorOperations::scalar_type>
+>
+class block_gmres : public iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, Preconditioner>
+{
+    using parent_t = iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, Preconditioner>;
+    using logged_obj_t = typename parent_t::logged_obj_t;
+    using logged_obj_params_t = typename parent_t::logged_obj_params_t;
+
+public:
+    using scalar_type =  typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using linear_operator_type =  LinearOperator;
+    using preconditioner_type = Preconditioner;
+    using vector_operations_type = VectorOperations;
+    using dense_operations_t = DenseOperations;
+    using monitor_type = Monitor;
+    using log_type = Log;
+    using residual_regulaization_t = ResidualRegulariation;
+
+
+    struct params : public logged_obj_params_t
+    {
+        unsigned basis_size; //total size of the krylov basis
+        unsigned block_size; //maximum number of right hand sides in solve_multi, must not exceed basis_size
+        unsigned batch_size; //residual estimate is logged each batch_size iterations
+        char preconditioner_side; //can be L for left and R for right
+        typename Monitor::params monitor;
+
+        params(const std::string &log_prefix = "", const std::string &log_name = "block_gmres::") :
+            logged_obj_params_t(0, log_prefix+log_name),
+            basis_size(30),
+            block_size(2),
+            batch_size(5),
+            preconditioner_side('R'),
+            monitor( typename Monitor::params(this->log_msg_prefix) )
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            basis_size = j.value("basis_size", basis_size);
+            block_size = j.value("block_size", block_size);
+            batch_size = j.value("batch_size", batch_size);
+            preconditioner_side = j.value("preconditioner_side", preconditioner_side);
+            monitor.from_json(j.at("monitor"));
+        }
+        nlohmann::json to_json() const
+        {
+            return
+                nlohmann::json
+                {
+                    {"type", "block_gmres"},
+                    {"basis_size", basis_size},
+                    {"block_size", block_size},
+                    {"batch_size", batch_size},
+                    {"preconditioner_side", preconditioner_side},
+                    {"monitor", monitor.to_json()}
+                };
+        }
+        #endif
+    };
+    using utils = detail::krylov_utils<vector_operations_type, Log, residual_regulaization_t, dense_operations_t>;
+    using params_hierarchy = detail::krylov_params_hierarchy<params, Preconditioner>;
+    using utils_hierarchy = detail::krylov_utils_hierarchy<utils, Preconditioner>;
+
+private:
+    using T = scalar_type;
+    using T_vec = vector_type;
+    using T_mvec = multivector_type;
+    using Ord = typename VectorOperations::Ord;
+
+    using D_vec = typename dense_operations_t::vector_type;
+    using D_mat = typename dense_operations_t::matrix_type;
+
+    using block_apply_t = detail::block_apply<VectorOperations, LinearOperator>;
+
+    //V_ is krylov basis (basis_size+block_size vectors), Z_ and W_ are input and output blocks of operator,
+    //R_ is residuals of all right hand sides
+    mutable T_mvec V_;
+    mutable T_mvec Z_, W_, R_;
+    mutable T_mvec b_single_, x_single_;
+    mutable T_vec w_;
+    mutable T_vec y_;
+    mutable T_vec x_tmp_;
+    mutable T_vec f_tmp_;
+
+    //parameters:
+    params prms_;
+    int m_;
+    int bs_;
+    detail::gram_schmidt<VectorOperations> orth_;
+
+    //host dense operations vectors and matrices:
+    //H_ is block hessenberg matrix, S_ is triangular factor of residual block, d_ is least squares solution
+    mutable D_mat H_, S_;
+    mutable D_vec c_, d_;
+    //QR factorizations of H_ by Givens rotations for each column of the residual block
+    mutable std::vector<std::unique_ptr<detail::givens_least_squares<dense_operations_t>>> lsq_;
+    //host buffer for Gram-Schmidt and linear combinations coefficients
+    mutable std::vector<T> orth_coeffs_;
+    //monitors of right hand sides 1..block_size-1, monitor of 0th one is parent monitor_
+    std::vector<std::unique_ptr<monitor_type>> monitors_;
+    //columns that are not finished yet and columns used in current cycle
+    mutable std::vector<int> active_, block_;
+    //flags of block columns converged by ritz estimate in current cycle
+    mutable std::vector<char> ritz_converged_;
+
+
+    monitor_type &monitor_of(int l)const
+    {
+        return (l == 0 ? monitor_ : *monitors_[l-1]);
+    }
+
+    void init_host()
+    {
+        dense_ops_->init_matrices(H_, S_);
+        dense_ops_->init_col_vectors(c_, d_);
+        for(int q = 0; q < bs_; q++)
+        {
+            lsq_.emplace_back( new detail::givens_least_squares<dense_operations_t>() );
+            lsq_.back()->init(dense_ops_);
+        }
+    }
+
+    void free_host_()
+    {
+        dense_ops_->free_matrices(H_, S_);
+        dense_ops_->free_col_vectors(c_, d_);
+        for(auto &lsq: lsq_)
+        {
+            lsq->free();
+        }
+    }
+
+    void init_all() const
+    {
+        vec_ops_->init_vector( w_ );
+        vec_ops_->init_vector( y_ );
+        vec_ops_->init_vector( x_tmp_ );
+        vec_ops_->init_vector( f_tmp_ );
+        vec_ops_->init_multivector( V_, m_+bs_ );
+        vec_ops_->init_multivector( Z_, bs_ );
+        vec_ops_->init_multivector( W_, bs_ );
+        vec_ops_->init_multivector( R_, bs_ );
+        vec_ops_->init_multivector( b_single_, 1 );
+        vec_ops_->init_multivector( x_single_, 1 );
+    }
+    void start_use_all() const
+    {
+        vec_ops_->start_use_vector( w_ );
+        vec_ops_->start_use_vector( y_ );
+        vec_ops_->start_use_vector( x_tmp_ );
+        vec_ops_->start_use_vector( f_tmp_ );
+        vec_ops_->start_use_multivector( V_, m_+bs_ );
+        vec_ops_->start_use_multivector( Z_, bs_ );
+        vec_ops_->start_use_multivector( W_, bs_ );
+        vec_ops_->start_use_multivector( R_, bs_ );
+    }
+    void stop_use_all() const
+    {
+        vec_ops_->stop_use_vector( w_ );
+        vec_ops_->stop_use_vector( y_ );
+        vec_ops_->stop_use_vector( x_tmp_ );
+        vec_ops_->stop_use_vector( f_tmp_ );
+        vec_ops_->stop_use_multivector( V_, m_+bs_ );
+        vec_ops_->stop_use_multivector( Z_, bs_ );
+        vec_ops_->stop_use_multivector( W_, bs_ );
+        vec_ops_->stop_use_multivector( R_, bs_ );
+    }
+    void free_all() const
+    {
+        vec_ops_->free_vector( w_ );
+        vec_ops_->free_vector( y_ );
+        vec_ops_->free_vector( x_tmp_ );
+        vec_ops_->free_vector( f_tmp_ );
+        vec_ops_->free_multivector( V_, m_+bs_ );
+        vec_ops_->free_multivector( Z_, bs_ );
+        vec_ops_->free_multivector( W_, bs_ );
+        vec_ops_->free_multivector( R_, bs_ );
+        vec_ops_->free_multivector( b_single_, 1 );
+        vec_ops_->free_multivector( x_single_, 1 );
+    }
+
+    /// R(0:n) := B - A*X (left preconditioned)
+    void calc_residuals(const linear_operator_type &A, const T_mvec &B, const T_mvec &X, const int n) const
+    {
+        for(int l = 0; l < n; l++)
+        {
+            vec_ops_->assign(X, n, l, w_);
+            vec_ops_->assign(w_, Z_, bs_, l);
+        }
+        block_apply_t::apply(*vec_ops_, A, Z_, W_, bs_, n, x_tmp_, f_tmp_);
+        for(int l = 0; l < n; l++)
+        {
+            vec_ops_->assign(W_, bs_, l, w_);
+            vec_ops_->add_lin_comb(static_cast<T>(1), B, n, l, static_cast<T>(-1), w_);
+            if ((prec_ != nullptr)&&(prms_.preconditioner_side == 'L'))
+            {
+                prec_->apply(w_);
+            }
+            residual_reg_->apply(w_);
+            vec_ops_->assign(w_, R_, bs_, l);
+        }
+    }
+
+    /// W(0:p) := K*Z(0:p), where K is A, M^{-1}A or AM^{-1}; Z may be changed
+    void calc_krylov_block(const linear_operator_type &A, const int p) const
+    {
+        if ((prec_ != nullptr)&&(prms_.preconditioner_side == 'R'))
+        {
+            for(int l = 0; l < p; l++)
+            {
+                vec_ops_->assign(Z_, bs_, l, w_);
+                prec_->apply(w_);
+                vec_ops_->assign(w_, Z_, bs_, l);
+            }
+        }
+        block_apply_t::apply(*vec_ops_, A, Z_, W_, bs_, p, x_tmp_, f_tmp_);
+        for(int l = 0; l < p; l++)
+        {
+            vec_ops_->assign(W_, bs_, l, w_);
+            if ((prec_ != nullptr)&&(prms_.preconditioner_side == 'L'))
+            {
+                prec_->apply(w_);
+            }
+            residual_reg_->apply(w_);
+            vec_ops_->assign(w_, W_, bs_, l);
+        }
+    }
+
+    /// orthogonalizes w_ against V(0:n) by classical Gram-Schmidt with reorthogonalization,
+    /// coefficients are written into M(0:n,col); returns norm of w_ before orthogonalization
+    T orthogonalize(const int n, D_mat &M, const int col) const
+    {
+        T norm0 = vec_ops_->norm(w_);
+        orth_.project(*vec_ops_, V_, m_+bs_, n, w_, orth_coeffs_.data());
+        for(int k = 0; k < n; k++)
+        {
+            M(k, col) = orth_coeffs_[k];
+        }
+        return norm0;
+    }
+
+    /// QR of residuals of active columns, R = V(0:p)*S; columns with residual (numerically) dependent on previous ones
+    /// are postponed; returns p, block_ gets used columns
+    int init_block() const
+    {
+        dense_ops_->assign_scalar_matrix(0, S_);
+        block_.clear();
+        int p = 0;
+        for(int l: active_)
+        {
+            vec_ops_->assign(R_, bs_, l, w_);
+            T norm0 = orthogonalize(p, S_, p);
+            T rho = vec_ops_->norm(w_);
+            if(!(rho > std::sqrt(std::numeric_limits<T>::epsilon())*norm0))
+            {
+                continue;
+            }
+            S_(p, p) = rho;
+            vec_ops_->scale(static_cast<T>(1)/rho, w_);
+            vec_ops_->assign(w_, V_, m_+bs_, p);
+            block_.push_back(l);
+            p++;
+        }
+        return p;
+    }
+
+    /// X(block_) += V(0:cols)*Y(0:cols,:), where Y(:,q) solves q-th least squares problem
+    void update_solution(T_mvec &X, const int n, const int cols) const
+    {
+        for(int q = 0; q < static_cast<int>(block_.size()); q++)
+        {
+            lsq_[q]->solve(d_);
+            for(int i = 0; i < cols; i++)
+            {
+                orth_coeffs_[i] = d_(i);
+            }
+            vec_ops_->assign_scalar(static_cast<T>(0), y_);
+            vec_ops_->multi_add_lin_comb(orth_coeffs_.data(), V_, m_+bs_, 0, cols, static_cast<T>(1), y_);
+            if ((prec_ != nullptr)&&(prms_.preconditioner_side == 'R'))
+            {
+                prec_->apply(y_);
+            }
+            residual_reg_->apply(y_);
+            vec_ops_->assign(X, n, block_[q], x_tmp_);
+            vec_ops_->add_lin_comb(static_cast<T>(1), y_, static_cast<T>(1), x_tmp_);
+            vec_ops_->assign(x_tmp_, X, n, block_[q]);
+        }
+    }
+
+    /// checks true residuals of active columns, finished ones are removed from active_
+    void check_active(const T_mvec &X, const int n) const
+    {
+        std::vector<int> still_active;
+        for(int l: active_)
+        {
+            vec_ops_->assign(X, n, l, x_tmp_);
+            vec_ops_->assign(R_, bs_, l, w_);
+            if(!monitor_of(l).check_finished(x_tmp_, w_))
+            {
+                still_active.push_back(l);
+            }
+        }
+        active_.swap(still_active);
+    }
+
+protected:
+    using parent_t::monitor_;
+    using parent_t::vec_ops_;
+    using parent_t::prec_;
+    std::shared_ptr<dense_operations_t> dense_ops_;
+    std::shared_ptr<residual_regulaization_t> residual_reg_;
+
+public:
+    ~block_gmres()
+    {
+        free_host_();
+        free_all();
+    }
+
+    block_gmres(
+        std::shared_ptr<vector_operations_type> vec_ops,
+        Log *log = nullptr,
+        const params& prm = params(),
+        std::shared_ptr<preconditioner_type> prec = nullptr,
+        std::shared_ptr<residual_regulaization_t> residual_reg = std::make_shared<residual_regulaization_t>(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        parent_t(std::move(vec_ops), log, prm, prm.monitor, std::move(prec) ),
+        prms_(prm),
+        m_(prm.basis_size),
+        bs_(prm.block_size),
+        orth_("cgs2", false, prm.basis_size+prm.block_size, "block_gmres"),
+        dense_ops_(std::move(dense_ops)),
+        residual_reg_(std::move(residual_reg))
+    {
+        if((prm.block_size < 1)||(prm.block_size > prm.basis_size))
+        {
+            throw std::logic_error("block_gmres: block_size must be in [1,basis_size]");
+        }
+        for(int l = 1; l < bs_; l++)
+        {
+            typename monitor_type::params monitor_prm = prm.monitor;
+            monitor_prm.log_msg_prefix += "rhs" + std::to_string(l) + "::";
+            monitors_.emplace_back( new monitor_type(*vec_ops_, log, monitor_prm) );
+        }
+        orth_coeffs_.resize(prm.basis_size+prm.block_size);
+        dense_ops_->init(prm.basis_size+prm.block_size, prm.basis_size);
+        init_host();
+        init_all();
+    }
+    block_gmres(
+        std::shared_ptr<const linear_operator_type> A,
+        std::shared_ptr<vector_operations_type> vec_ops,
+        Log *log = nullptr,
+        const params& prm = params(),
+        std::shared_ptr<preconditioner_type> prec = nullptr,
+        std::shared_ptr<residual_regulaization_t> residual_reg = std::make_shared<residual_regulaization_t>(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        block_gmres(std::move(vec_ops),log,prm,std::move(prec),std::move(residual_reg),std::move(dense_ops))
+    {
+        parent_t::set_operator(std::move(A));
+    }
+
+    block_gmres(
+        const utils_hierarchy& utils,
+        const params_hierarchy& prm = params_hierarchy()
+    ) :
+        block_gmres(
+            utils.vec_ops, utils.log, prm,
+            nmfd::detail::algo_hierarchy_creator<preconditioner_type>::get(utils.preconditioner,prm.preconditioner),
+            utils.residual_reg, utils.dense_ops
+        )
+    {
+    }
+
+    const std::shared_ptr<preconditioner_type> &preconditioner()const
+    {
+        return prec_;
+    }
+
+    using parent_t::monitor;
+    /// monitor of l-th right hand side of the last solve_multi call
+    Monitor         &monitor(int l) { return monitor_of(l); }
+    const Monitor   &monitor(int l)const { return monitor_of(l); }
+
+    /// solves A*X(i) = B(i) for i in [0,n), n <= block_size; B and X are multivectors of n vectors
+    bool solve_multi(const linear_operator_type &A, const T_mvec &B, T_mvec &X, int n)const
+    {
+        if((n < 1)||(n > bs_))
+        {
+            throw std::logic_error("block_gmres: number of right hand sides must be in [1,block_size]");
+        }
+        start_use_all();
+
+        for(int l = 0; l < n; l++)
+        {
+            vec_ops_->assign(B, n, l, w_);
+            if ((prec_ != nullptr)&&(prms_.preconditioner_side == 'L'))
+            {
+                prec_->apply(w_);
+                residual_reg_->apply(w_);
+            }
+            monitor_of(l).start(w_);
+        }
+
+        calc_residuals(A, B, X, n);
+        active_.clear();
+        for(int l = 0; l < n; l++)
+        {
+            active_.push_back(l);
+        }
+        check_active(X, n);
+        std::size_t total_steps = 0;
+
+        while(!active_.empty())
+        {
+            const int p = init_block();
+            if(p == 0)
+            {
+                break;
+            }
+            const int nb = m_/p;
+            dense_ops_->assign_scalar_matrix(0, H_);
+            for(int q = 0; q < p; q++)
+            {
+                dense_ops_->assign_scalar_col_vector(0, c_);
+                for(int i = 0; i <= q; i++)
+                {
+                    c_(i) = S_(i, q);
+                }
+                lsq_[q]->reset(c_, q+1);
+            }
+            bool all_converged_by_ritz = false, breakdown = false;
+            ritz_converged_.assign(p, 0);
+            int j = -1;
+            do
+            {
+                ++j;
+                for(int l: block_)
+                {
+                    ++monitor_of(l);
+                }
+                for(int l = 0; l < p; l++)
+                {
+                    vec_ops_->assign(V_, m_+bs_, j*p+l, w_);
+                    vec_ops_->assign(w_, Z_, bs_, l);
+                }
+                calc_krylov_block(A, p);
+                for(int l = 0; l < p; l++)
+                {
+                    const int col = j*p+l, row = (j+1)*p+l;
+                    vec_ops_->assign(W_, bs_, l, w_);
+                    T norm0 = orthogonalize(row, H_, col);
+                    T h = vec_ops_->norm(w_);
+                    if(!(h > std::numeric_limits<T>::epsilon()*norm0))
+                    {
+                        //krylov space became invariant in this direction: finish the cycle
+                        breakdown = true;
+                        H_(row, col) = static_cast<T>(0);
+                        vec_ops_->assign_scalar(static_cast<T>(0), w_);
+                    }
+                    else
+                    {
+                        H_(row, col) = h;
+                        vec_ops_->scale(static_cast<T>(1)/h, w_);
+                    }
+                    vec_ops_->assign(w_, V_, m_+bs_, row);
+                }
+
+                total_steps++;
+                all_converged_by_ritz = true;
+                T max_resid_estimate = 0;
+                for(int q = 0; q < p; q++)
+                {
+                    T resid_estimate = static_cast<T>(0);
+                    for(int l = 0; l < p; l++)
+                    {
+                        resid_estimate = lsq_[q]->add_column(H_, j*p+l, (j+1)*p+l+1);
+                    }
+                    max_resid_estimate = std::max(max_resid_estimate, monitor_of(block_[q]).norm_out(resid_estimate));
+                    if(!ritz_converged_[q])
+                    {
+                        ritz_converged_[q] = monitor_of(block_[q]).check_finished_by_ritz_estimate(resid_estimate);
+                    }
+                    all_converged_by_ritz = all_converged_by_ritz && ritz_converged_[q];
+                }
+                if((total_steps%prms_.batch_size == 0)||(j+1 == nb))
+                {
+                    logged_obj_t::info_f("block step = %i(%i), block size = %i, max resid_estimate = %e", static_cast<int>(total_steps), j+1, p, max_resid_estimate );
+                }
+            }
+            while( !all_converged_by_ritz && !breakdown && (j+1 < nb) );
+
+            update_solution(X, n, (j+1)*p);
+            calc_residuals(A, B, X, n);
+            check_active(X, n);
+        }
+
+        bool res = true;
+        for(int l = 0; l < n; l++)
+        {
+            res = res && monitor_of(l).converged();
+            monitor_of(l).stop();
+        }
+        if(!res)
+            logged_obj_t::error_f("solve_multi: linear solver failed to converge");
+
+        stop_use_all();
+
+        return res;
+    }
+
+    bool solve_multi(const T_mvec &B, T_mvec &X, int n)const
+    {
+        return solve_multi(*parent_t::A_, B, X, n);
+    }
+
+    virtual bool solve(const linear_operator_type &A, const T_vec &b, T_vec &x)const
+    {
+        vec_ops_->start_use_multivector( b_single_, 1 );
+        vec_ops_->start_use_multivector( x_single_, 1 );
+        vec_ops_->assign(b, b_single_, 1, 0);
+        vec_ops_->assign(x, x_single_, 1, 0);
+        bool res = solve_multi(A, b_single_, x_single_, 1);
+        vec_ops_->assign(x_single_, 1, 0, x);
+        vec_ops_->stop_use_multivector( b_single_, 1 );
+        vec_ops_->stop_use_multivector( x_single_, 1 );
+        return res;
+    }
+
+    bool solve(const vector_type &b, vector_type &x)const
+    {
+        return solve(*parent_t::A_, b, x);
+    }
+};
+
+}
+}
+
+#endif //__NMFD_BLOCK_GMRES_H__
@@ -0,0 +1,297 @@
+// Copyright © 2016-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_BROYDEN_ITERATION_H__
+#define __NMFD_BROYDEN_ITERATION_H__
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#include <nmfd/detail/algo_hierarchy_macro.h>
+#include <nmfd/detail/algo_hierarchy_creator.h>
+#include <nmfd/detail/linearization_point_hook.h>
+
+namespace nmfd
+{
+namespace solvers
+{
+
+/**
+*   Limited memory "good" Broyden quasi-newton iteration operator for nonlinear_solver.
+*   Inverse jacobian approximation is kept in product form
+*
+*   H_k = (I + u_{k-1}*s_{k-1}^T)*...*(I + u_0*s_0^T)*H_0,  u_j = (s_j - H_j*y_j)/(s_j^T*H_j*y_j),
+*
+*   where s_j = x_{j+1} - x_j is the actually made step (after damping by convergence strategy) and
+*   y_j = F(x_{j+1}) - F(x_j); pairs (u_j, s_j) are stored in two multivectors, so each step costs
+*   one application of H_0 and O(k) vector operations, no transposed operators are needed.
+*   H_0 is either LinearSolver for the jacobian at the first point of the solve (jacobian is linearized and
+*   LinearSolver::set_operator is called only then and on restarts if refresh_on_restart is set), or, for
+*   LinearSolver = void, identity_scale*I (NonlinearOperator then only needs apply(x, f) const).
+*   Iteration restarts (pairs are discarded) when memory pairs are stored or when s^T*H*y is (numerically) zero.
+*   memory = 0 gives chord iteration with H_0 (Picard iteration for identity, newton for refresh_on_restart).
+*/
+template<class VectorSpace, class NonlinearOperator, class LinearSolver = void>
+class broyden_iteration
+{
+    using T = typename VectorSpace::scalar_type;
+    using T_vec = typename VectorSpace::vector_type;
+    using T_mvec = typename VectorSpace::multivector_type;
+    using Ord = typename VectorSpace::Ord;
+    static constexpr bool has_lin_solver = !std::is_void<LinearSolver>::value;
+public:
+    using scalar_type = typename VectorSpace::scalar_type;
+    using vector_type = typename VectorSpace::vector_type;
+    using vector_space_type = VectorSpace;
+
+    struct params
+    {
+        std::string log_msg_prefix;
+        int memory;
+        bool refresh_on_restart;
+        T identity_scale;
+
+        params(const std::string &log_prefix = "", const std::string & = "broyden_iteration::") :
+            log_msg_prefix(log_prefix), memory(10), refresh_on_restart(true), identity_scale(T(1))
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            memory = j.value("memory", memory);
+            refresh_on_restart = j.value("refresh_on_restart", refresh_on_restart);
+            identity_scale = j.value("identity_scale", identity_scale);
+        }
+        nlohmann::json to_json() const
+        {
+            return
+                nlohmann::json
+                {
+                    {"type", "broyden_iteration"},
+                    {"memory", memory},
+                    {"refresh_on_restart", refresh_on_restart},
+                    {"identity_scale", identity_scale}
+                };
+        }
+        #endif
+    };
+    struct utils
+    {
+        std::shared_ptr<VectorSpace> vec_space;
+        utils() = default;
+        utils(std::shared_ptr<VectorSpace> vec_space_) : vec_space(std::move(vec_space_))
+        {
+        }
+        template<class Backend>
+        utils(Backend &backend, std::shared_ptr<VectorSpace> vec_space_) : utils(vec_space_)
+        {
+        }
+    };
+    NMFD_ALGO_HIERARCHY_TYPES_DEFINE(broyden_iteration,LinearSolver,lin_solver)
+
+    /// lin_solver is ignored (may be nullptr) for LinearSolver = void
+    broyden_iteration(
+        std::shared_ptr<VectorSpace> vec_ops, std::shared_ptr<LinearSolver> lin_solver = nullptr,
+        const params &prm = params()
+    ) :
+        vec_ops_(std::move(vec_ops)), lin_solver_(std::move(lin_solver)), prms_(prm)
+    {
+        if(prms_.memory < 0)
+        {
+            throw std::logic_error("broyden_iteration: memory must be non-negative");
+        }
+        if constexpr (has_lin_solver)
+        {
+            if(!lin_solver_)
+            {
+                throw std::logic_error("broyden_iteration: linear solver for initial jacobian is not set");
+            }
+        }
+        m_ = static_cast<Ord>(prms_.memory);
+        mvec_size_ = std::max(m_, Ord(1));
+        vec_ops_->init_vector(f_); vec_ops_->start_use_vector(f_);
+        vec_ops_->init_vector(p_); vec_ops_->start_use_vector(p_);
+        vec_ops_->init_vector(x_prev_); vec_ops_->start_use_vector(x_prev_);
+        vec_ops_->init_vector(d_prev_); vec_ops_->start_use_vector(d_prev_);
+        vec_ops_->init_multivector(U_, mvec_size_); vec_ops_->start_use_multivector(U_, mvec_size_);
+        vec_ops_->init_multivector(S_, mvec_size_); vec_ops_->start_use_multivector(S_, mvec_size_);
+        reset();
+    }
+    broyden_iteration(
+        const utils_hierarchy& utils,
+        const params_hierarchy& prm = params_hierarchy()
+    ) :
+        broyden_iteration(utils.vec_space, create_lin_solver(utils, prm), prm)
+    {
+    }
+    ~broyden_iteration()
+    {
+        vec_ops_->stop_use_multivector(S_, mvec_size_); vec_ops_->free_multivector(S_, mvec_size_);
+        vec_ops_->stop_use_multivector(U_, mvec_size_); vec_ops_->free_multivector(U_, mvec_size_);
+        vec_ops_->stop_use_vector(d_prev_); vec_ops_->free_vector(d_prev_);
+        vec_ops_->stop_use_vector(x_prev_); vec_ops_->free_vector(x_prev_);
+        vec_ops_->stop_use_vector(p_); vec_ops_->free_vector(p_);
+        vec_ops_->stop_use_vector(f_); vec_ops_->free_vector(f_);
+    }
+
+    bool solve(NonlinearOperator &nonlin_op, const vector_type& x, vector_type& d_x)
+    {
+        nonlin_op.apply(x, f_); // f = F(x)
+        return step(nonlin_op, x, d_x);
+    }
+    /// F(x) is taken from Fx, so the secant pair of the previous step costs no extra residual evaluation
+    bool solve(NonlinearOperator &nonlin_op, const vector_type& x, const vector_type& Fx, vector_type& d_x)
+    {
+        vec_ops_->assign(Fx, f_); // f = F(x)
+        return step(nonlin_op, x, d_x);
+    }
+    /// called by nonlinear_solver at the start of every solve: initial jacobian and pairs refer to the previous problem
+    void start_solve()
+    {
+        reset();
+    }
+    /// forgets all pairs and initial jacobian, next step starts new Broyden sequence
+    void reset()
+    {
+        is_initialized_ = false;
+        has_prev_ = false;
+        k_ = 0;
+    }
+    /// number of stored update pairs
+    int pairs_num()const
+    {
+        return static_cast<int>(k_);
+    }
+    /// number of initial jacobian setups (linearizations) made so far
+    int initial_jacobian_setups_num()const
+    {
+        return setups_num_;
+    }
+
+private:
+    std::shared_ptr<VectorSpace> vec_ops_;
+    std::shared_ptr<LinearSolver> lin_solver_;
+    params prms_;
+    Ord m_, mvec_size_;
+    T_vec f_, p_, x_prev_, d_prev_;
+    T_mvec U_, S_;
+    bool is_initialized_, has_prev_;
+    Ord k_;
+    int setups_num_ = 0;
+
+    static std::shared_ptr<LinearSolver> create_lin_solver(const utils_hierarchy& utils, const params_hierarchy& prm)
+    {
+        if constexpr (has_lin_solver)
+        {
+            return nmfd::detail::algo_hierarchy_creator<LinearSolver>::get(utils.lin_solver,prm.lin_solver);
+        }
+        else
+        {
+            return nullptr;
+        }
+    }
+
+    /// f_ contains F(x); initial jacobian is linearized at x
+    void setup_initial_jacobian(NonlinearOperator &nonlin_op, const vector_type& x)
+    {
+        if constexpr (has_lin_solver)
+        {
+            nmfd::detail::linearization_point_hook<NonlinearOperator,vector_type>::set(nonlin_op, x, f_);
+            lin_solver_->set_operator(nonlin_op.get_jacobi_operator());
+            ++setups_num_;
+        }
+        is_initialized_ = true;
+    }
+    /// p = H_0*rhs
+    bool apply_initial_inverse(const vector_type& rhs, vector_type& p)
+    {
+        if constexpr (has_lin_solver)
+        {
+            vec_ops_->assign_scalar(T(0), p);
+            return lin_solver_->solve(rhs, p);
+        }
+        else
+        {
+            vec_ops_->assign_lin_comb(prms_.identity_scale, rhs, p);
+            return true;
+        }
+    }
+    /// p = H_k*p for the k_ stored pairs, p contains H_0*v on entry
+    void apply_updates(vector_type& p)const
+    {
+        for(Ord j = 0; j < k_; ++j)
+        {
+            T sp = vec_ops_->scalar_prod(S_, mvec_size_, j, p);
+            vec_ops_->add_lin_comb(sp, U_, mvec_size_, j, T(1), p);
+        }
+    }
+    void restart(NonlinearOperator &nonlin_op, const vector_type& x)
+    {
+        k_ = 0;
+        if(prms_.refresh_on_restart)
+        {
+            setup_initial_jacobian(nonlin_op, x);
+        }
+    }
+
+    /// f_ contains F(x)
+    bool step(NonlinearOperator &nonlin_op, const vector_type& x, vector_type& d_x)
+    {
+        if(!is_initialized_)
+        {
+            setup_initial_jacobian(nonlin_op, x);
+            k_ = 0;
+            has_prev_ = false;
+        }
+        bool flag = apply_initial_inverse(f_, p_);
+        apply_updates(p_); // p = H_{k-1}*F_k
+        if(has_prev_)
+        {
+            vec_ops_->add_lin_comb(T(1), x, T(-1), x_prev_); // x_prev_ = s = x_k - x_{k-1}
+            vec_ops_->add_lin_comb(T(1), p_, T(1), d_prev_); // d_prev_ = H_{k-1}*y, d_{k-1} = -H_{k-1}*F_{k-1}
+            const T den = vec_ops_->scalar_prod(x_prev_, d_prev_);
+            const T den_min = std::sqrt(std::numeric_limits<T>::epsilon())*vec_ops_->norm(x_prev_)*vec_ops_->norm(d_prev_);
+            if((k_ == m_)||(!(std::abs(den) > den_min)))
+            {
+                restart(nonlin_op, x);
+                flag = apply_initial_inverse(f_, p_);
+            }
+            else
+            {
+                vec_ops_->assign(x_prev_, S_, mvec_size_, k_);
+                vec_ops_->add_lin_comb(-T(1)/den, d_prev_, T(1)/den, x_prev_); // u = (s - H*y)/(s^T*H*y)
+                vec_ops_->assign(x_prev_, U_, mvec_size_, k_);
+                ++k_;
+                T sp = vec_ops_->scalar_prod(S_, mvec_size_, k_-1, p_);
+                vec_ops_->add_lin_comb(sp, U_, mvec_size_, k_-1, T(1), p_); // p = H_k*F_k
+            }
+        }
+        vec_ops_->assign_lin_comb(T(-1), p_, d_x);
+        vec_ops_->assign(d_x, d_prev_);
+        vec_ops_->assign(x, x_prev_);
+        has_prev_ = true;
+        return flag;
+    }
+};
+
+}
+}
+
+#endif
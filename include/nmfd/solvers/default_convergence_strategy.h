@@ -20,7 +20,9 @@
 convergence rules for Newton iterator for continuation process
 */
 #include <cmath>
+#include <string>
 #include <vector>
+#include <stdexcept>
 #include <scfd/utils/logged_obj_base.h>
 #include <algorithm> // std::min_element
 #include <iterator>  // std::begin, std::end
@@ -28,6 +30,7 @@ convergence rules for Newton iterator for continuation process
 #include <nmfd/operations/zero_functional.h>
 #include <nmfd/detail/algo_hierarchy_macro.h>
 #include <nmfd/detail/algo_hierarchy_creator.h>
+#include <nmfd/detail/jacobi_apply_hook.h>
 
 /// TODO check it!
 /// NOTE originally taken from deflated_continuation timesteppers branch source/continuation/convergence_strategy.h 22.07.2025
@@ -71,6 +74,17 @@ public:
         T newton_weight_mul = T(0.5);
         T relax_tolerance_factor = T(1);
         bool verbose = true, store_norms_history = false;
+        /// "halving": weight is multiplied by newton_weight_mul until norm increase is within maximum_norm_increase;
+        /// "quadratic"/"cubic": backtracking until armijo condition ||F(x+w*dx)||^2 <= ||F(x)||^2 + 2*armijo_c*w*phi'(0)
+        /// holds, next weight minimizes quadratic (cubic, from the second backtrack) interpolant of ||F(x+w*dx)||^2/2
+        /// built on already calculated values and is safeguarded to [line_search_min_factor, line_search_max_factor]
+        /// of the previous weight. phi'(0) = (F(x),J*dx) if line_search_jacobi_slope is set and jacobi operator
+        /// is available (one extra jacobi apply per iteration), otherwise -||F(x)||^2 (exact newton direction).
+        std::string line_search = "halving";
+        T armijo_c = T(1.0e-4);
+        T line_search_min_factor = T(0.1);
+        T line_search_max_factor = T(0.5);
+        bool line_search_jacobi_slope = false;
 
         params(
             const std::string &log_pefix = "", const std::string &log_name = "default_convergence_strategy::"
@@ -95,6 +109,11 @@ public:
             //out_min_resid_norm = j.value("out_min_resid_norm", out_min_resid_norm);
             verbose = j.value("verbose", verbose);
             store_norms_history = j.value("store_norms_history", store_norms_history);
+            line_search = j.value("line_search", line_search);
+            armijo_c = j.value("armijo_c", armijo_c);
+            line_search_min_factor = j.value("line_search_min_factor", line_search_min_factor);
+            line_search_max_factor = j.value("line_search_max_factor", line_search_max_factor);
+            line_search_jacobi_slope = j.value("line_search_jacobi_slope", line_search_jacobi_slope);
             //divide_out_norms_by_rel_base = j.value("divide_out_norms_by_rel_base", divide_out_norms_by_rel_base);
         }
         nlohmann::json to_json() const
@@ -115,6 +134,11 @@ public:
                     //{"out_min_resid_norm", out_min_resid_norm},
                     {"verbose", verbose},
                     {"store_norms_history", store_norms_history},
+                    {"line_search", line_search},
+                    {"armijo_c", armijo_c},
+                    {"line_search_min_factor", line_search_min_factor},
+                    {"line_search_max_factor", line_search_max_factor},
+                    {"line_search_jacobi_slope", line_search_jacobi_slope},
                     //{"divide_out_norms_by_rel_base", divide_out_norms_by_rel_base}
                 };
         }
@@ -141,6 +165,7 @@ public:
     default_convergence_strategy(std::shared_ptr<VectorSpace> vec_space, Log* log, params prm = params()) :
       logged_obj_type(log, prm),
       prm_(prm),
+      line_search_(line_search_from_params(prm)),
       vec_space_(std::move(vec_space)),
       iterations(0)
     {
@@ -226,8 +251,22 @@ public:
         bool finish = false; //states that the newton process should stop.
         // result_status defines on how this process is stoped.
         newton_weight = prm_.newton_weight_initial;
-        nonlin_op->apply(x, Fx);
-        T normFx = vec_space_->norm_l2(Fx);
+        //F(x+delta_x) given by iteration operator is used only for this check; projected x1 differs from x+delta_x
+        const T_vec *step_residual = (project_op ? nullptr : step_residual_);
+        step_residual_ = nullptr;
+        T normFx;
+        if(Fx_is_valid_)
+        {
+            //F(x) was calculated for accepted update on the previous check
+            normFx = Fx_norm_;
+        }
+        else
+        {
+            nonlin_op->apply(x, Fx);
+            normFx = vec_space_->norm_l2(Fx);
+        }
+        //Fx is overwritten by trial updates below, it is valid again only when x is replaced by accepted x1
+        Fx_is_valid_ = false;
         if(!std::isfinite(normFx)) //set result_status = 2 if the provided vector is inconsistent
         {
             result_status = 2;
@@ -246,6 +285,7 @@ public:
             vec_space_->assign(x, x1_storage);
             Fx1_storage_norm_ = normFx;
             Fx_initial_norm_ = normFx;
+            set_residual_valid(normFx);
             /// postulate continue (other cases checked earlier) and continue
             result_status = 1;
             iterations++;
@@ -253,10 +293,44 @@ public:
         }
         T normFx1;
         result_status = 3;
+        const bool use_line_search = (line_search_ != line_search_t::halving);
+        //phi(w) = ||F(x+w*dx)||^2/2; phi(0) and phi'(0) for armijo condition and interpolation
+        const T phi0 = T(0.5)*normFx*normFx;
+        T dphi0 = -normFx*normFx;
+        if(use_line_search && prm_.line_search_jacobi_slope)
+        {
+            //x1 is free until the first trial update
+            if(nmfd::detail::jacobi_apply_hook<NonlinearOperator,T_vec>::apply(*nonlin_op, delta_x, x1))
+            {
+                T slope = vec_space_->scalar_prod_l2(Fx, x1);
+                if(slope < T(0))
+                {
+                    dphi0 = slope;
+                }
+                else
+                {
+                    logged_obj_type::warning_f("check: (F(x),J*dx) = %le is not descent, exact newton slope is used", (double)slope);
+                }
+            }
+        }
+        T w_prev = T(0), phi_prev = phi0;
         do
         {
             //update solution
-            normFx1 = update_solution(nonlin_op, project_op, x, delta_x, x1);
+            const bool globalized_step = (step_residual != nullptr);
+            if(globalized_step)
+            {
+                //step is globalized by iteration operator: F(x+delta_x) is known and unit weight is tried first
+                newton_weight = T(1);
+                vec_space_->assign_lin_comb(static_cast<T>(1.0), x, newton_weight, delta_x, x1);
+                vec_space_->assign(*step_residual, Fx);
+                normFx1 = vec_space_->norm_l2(Fx);
+                step_residual = nullptr;
+            }
+            else
+            {
+                normFx1 = update_solution(nonlin_op, project_op, x, delta_x, x1);
+            }
             logged_obj_type::info_f("increase threshold: %.01f, weight update from %le to %le with weight: %le and weight threshold: %le ", prm_.maximum_norm_increase, normFx, normFx1, newton_weight,  prm_.newton_weight_threshold);
             if(std::isfinite(normFx1))
             {
@@ -266,13 +340,26 @@ public:
                 {
                     //norms_storage.push_back(normFx1);
                     vec_space_->assign(x1, x);
+                    set_residual_valid(normFx1);
                     result_status = 0;
                     finish = true;
                     break;
                 }
-                if ((normFx1 - normFx) <= prm_.maximum_norm_increase*normFx)
+                const T phi = T(0.5)*normFx1*normFx1;
+                bool accept;
+                if(use_line_search && !globalized_step)
+                {
+                    accept = (phi <= phi0 + prm_.armijo_c*newton_weight*dphi0);
+                }
+                else
+                {
+                    //globalized step is not along newton direction, so it is only checked not to increase the norm
+                    accept = ((normFx1 - normFx) <= prm_.maximum_norm_increase*normFx);
+                }
+                if (accept)
                 {
                     vec_space_->assign(x1, x);
+                    set_residual_valid(normFx1);
                     if( std::abs(normFx1 - normFx) < 1.0e-6*normFx )
                     {
                         stagnation++;
@@ -284,8 +371,22 @@ public:
                     }
                     break;
                 }
+                if(use_line_search)
+                {
+                    T w = newton_weight;
+                    newton_weight = line_search_weight(phi0, dphi0, w, phi, w_prev, phi_prev);
+                    w_prev = w;
+                    phi_prev = phi;
+                }
+                else
+                {
+                    newton_weight *= prm_.newton_weight_mul;
+                }
+            }
+            else
+            {
+                newton_weight *= prm_.newton_weight_mul;
             }
-            newton_weight *= prm_.newton_weight_mul;
             if(newton_weight < prm_.newton_weight_threshold)
             {
                 if (result_status != 3) result_status = 4;
@@ -326,6 +427,7 @@ public:
                 /// NOTE x1 is actually not needed anymore just for convinience (mb delete it?)
                 vec_space_->assign(x1_storage, x1);
                 vec_space_->assign(x1_storage, x);
+                Fx_is_valid_ = false;
                 normFx1 = Fx1_storage_norm_;
                 //signal that relaxed tolerance converged and put it into vector of signals
                 if( normFx1 <= tol()*prm_.relax_tolerance_factor  )
@@ -370,9 +472,31 @@ public:
     {
         return result_status;
     }
+    /// F(x) for x passed to the last check_convergence call that returned false (i.e. for point of the next iteration),
+    /// so iteration operator can use it instead of calculating again; nullptr if it is not available
+    const T_vec *residual()const
+    {
+        return Fx_is_valid_ ? &Fx : nullptr;
+    }
+    /// must be called if x is changed outside between check_convergence calls
+    void invalidate_residual()
+    {
+        Fx_is_valid_ = false;
+    }
+    /// F(x+delta_x) for delta_x which will be passed to the next check_convergence call, calculated by iteration
+    /// operator which globalizes the step itself (like trust_region_iteration); nullptr if it is not available.
+    /// Such step is tried with unit weight without recalculation of F; if the norm increase exceeds maximum_norm_increase
+    /// (e.g. trust region step returned after max_rejections) the step is damped as usual.
+    /// Vector must stay unchanged until the next check_convergence call.
+    void set_step_residual(const T_vec *F_step)
+    {
+        step_residual_ = F_step;
+    }
     void reset_iterations()
     {
         iterations = 0;
+        Fx_is_valid_ = false;
+        step_residual_ = nullptr;
         //reset_weight();
         norms_evolution.clear();
         stagnation = 0;
@@ -387,7 +511,18 @@ public:
     }
 
 private:
+    enum class line_search_t { halving, quadratic, cubic };
+
+    static line_search_t line_search_from_params(const params &p)
+    {
+        if(p.line_search == "halving") return line_search_t::halving;
+        if(p.line_search == "quadratic") return line_search_t::quadratic;
+        if(p.line_search == "cubic") return line_search_t::cubic;
+        throw std::logic_error("default_convergence_strategy: unknown line_search " + p.line_search);
+    }
+
     params prm_;
+    line_search_t line_search_;
       
     std::shared_ptr<VectorSpace> vec_space_;
     
@@ -398,6 +533,11 @@ private:
 
     T_vec x1, x1_storage, Fx;
     T Fx_initial_norm_;
+    //Fx = F(x) for current x, so it is not recalculated on the next check and in iteration operator
+    bool Fx_is_valid_ = false;
+    T Fx_norm_;
+    //F(x+delta_x) of the step globalized by iteration operator, see set_step_residual
+    const T_vec *step_residual_ = nullptr;
     T Fx1_storage_norm_;
     T newton_weight;
     std::vector<T> norms_evolution;
@@ -406,10 +546,51 @@ private:
     T d_step;
     int current_relax_step;*/
 
+    void set_residual_valid(T normFx)
+    {
+        Fx_is_valid_ = true;
+        Fx_norm_ = normFx;
+    }
+
+    /// next backtracking weight after rejected weight w with phi = phi(w); w_prev, phi_prev is the previous
+    /// rejected trial (w_prev = 0 for the first backtrack)
+    T line_search_weight(T phi0, T dphi0, T w, T phi, T w_prev, T phi_prev)const
+    {
+        T w_new;
+        if((line_search_ == line_search_t::cubic)&&(w_prev > T(0)))
+        {
+            //cubic a*w^3 + b*w^2 + dphi0*w + phi0 through (w, phi) and (w_prev, phi_prev)
+            const T r1 = phi - phi0 - dphi0*w, r2 = phi_prev - phi0 - dphi0*w_prev;
+            const T den = w - w_prev;
+            const T a = (r1/(w*w) - r2/(w_prev*w_prev))/den;
+            const T b = (-w_prev*r1/(w*w) + w*r2/(w_prev*w_prev))/den;
+            if(a == T(0))
+            {
+                w_new = -dphi0/(T(2)*b);
+            }
+            else
+            {
+                const T disc = b*b - T(3)*a*dphi0;
+                w_new = (disc >= T(0)) ? (-b + std::sqrt(disc))/(T(3)*a) : prm_.line_search_max_factor*w;
+            }
+        }
+        else
+        {
+            //minimum of quadratic through phi0, dphi0 and (w, phi)
+            const T den = T(2)*(phi - phi0 - dphi0*w);
+            w_new = (den > T(0)) ? -dphi0*w*w/den : prm_.line_search_max_factor*w;
+        }
+        if(!std::isfinite(w_new))
+        {
+            w_new = prm_.line_search_max_factor*w;
+        }
+        return std::min(std::max(w_new, prm_.line_search_min_factor*w), prm_.line_search_max_factor*w);
+    }
+
     //updates a solution with a newton weight value provided
     T inline update_solution(NonlinearOperator *nonlin_op, ProjectOperator *project_op, T_vec& x, T_vec& delta_x, T_vec& x1)
     {
-        vec_space_->assign_mul(static_cast<T>(1.0), x, newton_weight, delta_x, x1);
+        vec_space_->assign_lin_comb(static_cast<T>(1.0), x, newton_weight, delta_x, x1);
         if (project_op)
         {
             project_op->apply(x1); // project to invariant solution subspace. Should be blank if nothing is needed to be projected.
@@ -159,7 +159,7 @@ public:
     //TODO add separate function to control tolerances and behaviour
     void set_temp_tolerance(T rel_tol)
     {
-        rel_tol_save_ = rel_tol;
+        rel_tol_save_ = prms_.rel_tol;
         prms_.rel_tol = rel_tol;   
     }
     void restore_tolerance()
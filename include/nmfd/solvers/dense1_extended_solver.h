@@ -20,6 +20,7 @@
 #include <string>
 #include <memory>
 #include <stdexcept>
+#include <utility>
 #include <nmfd/operations/static_vector_space.h>
 #include <nmfd/operations/pair_vector_space.h>
 #include <nmfd/operations/dense1_extended_operator.h>
@@ -30,6 +31,79 @@ namespace nmfd
 {
 namespace solvers
 {
+namespace detail
+{
+
+/// Solves A*x = b and A*r = u for dense1_extended_solver: with two solve calls in general case and
+/// with one solve_multi call if OriginalSolver supports it (like block_gmres), so that both systems share operator sweeps.
+template<class OriginalSolver, class OrigVectorSpace, class = int>
+class dense1_extended_pair_solve
+{
+    using orig_vector_type = typename OrigVectorSpace::vector_type;
+public:
+    dense1_extended_pair_solve(const OrigVectorSpace &orig_vec_space)
+    {
+    }
+
+    bool solve(OriginalSolver &solver, const orig_vector_type &b, orig_vector_type &x, const orig_vector_type &u, orig_vector_type &r)
+    {
+        bool flag1 = solver.solve(b, x); // x := A^-1*b
+        bool flag2 = solver.solve(u, r); // r := A^-1*u
+        return flag1 && flag2;
+    }
+};
+
+template<class OriginalSolver, class OrigVectorSpace>
+class dense1_extended_pair_solve
+<
+    OriginalSolver, OrigVectorSpace,
+    decltype
+    (
+        (void)(std::declval<const OriginalSolver&>().solve_multi(
+            std::declval<const typename OrigVectorSpace::multivector_type&>(),
+            std::declval<typename OrigVectorSpace::multivector_type&>(), int(2)
+        )),
+        int(0)
+    )
+>
+{
+    using orig_vector_type = typename OrigVectorSpace::vector_type;
+    using orig_multivector_type = typename OrigVectorSpace::multivector_type;
+public:
+    dense1_extended_pair_solve(const OrigVectorSpace &orig_vec_space) :
+        orig_vec_space_(orig_vec_space)
+    {
+        orig_vec_space_.init_multivector(rhs_, 2);
+        orig_vec_space_.init_multivector(sol_, 2);
+    }
+    ~dense1_extended_pair_solve()
+    {
+        orig_vec_space_.free_multivector(rhs_, 2);
+        orig_vec_space_.free_multivector(sol_, 2);
+    }
+
+    bool solve(OriginalSolver &solver, const orig_vector_type &b, orig_vector_type &x, const orig_vector_type &u, orig_vector_type &r)
+    {
+        orig_vec_space_.start_use_multivector(rhs_, 2);
+        orig_vec_space_.start_use_multivector(sol_, 2);
+        orig_vec_space_.assign(b, rhs_, 2, 0);
+        orig_vec_space_.assign(u, rhs_, 2, 1);
+        orig_vec_space_.assign(x, sol_, 2, 0);
+        orig_vec_space_.assign(r, sol_, 2, 1);
+        bool flag = solver.solve_multi(rhs_, sol_, 2); // [x r] := A^-1*[b u]
+        orig_vec_space_.assign(sol_, 2, 0, x);
+        orig_vec_space_.assign(sol_, 2, 1, r);
+        orig_vec_space_.stop_use_multivector(rhs_, 2);
+        orig_vec_space_.stop_use_multivector(sol_, 2);
+        return flag;
+    }
+
+private:
+    const OrigVectorSpace &orig_vec_space_;
+    orig_multivector_type rhs_, sol_;
+};
+
+}
 
 /**
 General solver for the block linear system of size (n+1 \times n+1) (rank one update):
@@ -70,7 +144,8 @@ public:
         operator_(op),
         r_wrap_(*orig_vec_space_),
         vx_wrap_(*scalar_space_),
-        vr_wrap_(*scalar_space_)
+        vr_wrap_(*scalar_space_),
+        pair_solve_(*orig_vec_space_)
     {
         if (orig_solver_ && operator_) {
             orig_solver_->set_operator(operator_->get_orig_operator());
@@ -108,9 +183,8 @@ public:
         const orig_vector_type &v = operator_->v();
         const scalar_vector_type &w = operator_->w();
 
-        // 1. Solving two systems
-        bool flag1 = orig_solver_->solve(b, x); // x := A^-1*b
-        bool flag2 = orig_solver_->solve(u, *r_wrap_); // r_ := A^-1*u
+        // 1. Solving two systems: x := A^-1*b, r_ := A^-1*u
+        bool flag = pair_solve_.solve(*orig_solver_, b, x, u, *r_wrap_);
 
         scalar_space_->assign_scalar(orig_vec_space_->scalar_prod(v, x), *vx_wrap_); // vx := v^T*x
         scalar_space_->assign_scalar(orig_vec_space_->scalar_prod(v, *r_wrap_), *vr_wrap_); // vr := v^T*r_
@@ -121,18 +195,18 @@ public:
         scalar_space_->div_pointwise(y, 1.0, *vr_wrap_); // y := y / 1.0*vr
 
         // 3. Calculating x = A^-1*b - A^-1*u*y
-        orig_vec_space_->add_lin_comb(-scalar_space_->get_value_at_point(0, y), *r_wrap_, x); // x := -y[0]*r_ + x
+        orig_vec_space_->add_lin_comb(-scalar_space_->get_value_at_point(0, y), *r_wrap_, static_cast<scalar_type>(1), x); // x := -y[0]*r_ + x
 
         // 4. Returning result
         orig_vec_space_->assign(x, res.first);
         scalar_space_->assign(y, res.second);
 
-        return flag1 && flag2;
+        return flag;
     }
 
 private:
-    using orig_vector_wrap_t = detail::vector_wrap<orig_space_type, true, true>;
-    using scalar_vector_wrap_t = detail::vector_wrap<scalar_space_type, true, true>;
+    using orig_vector_wrap_t = nmfd::detail::vector_wrap<orig_space_type, true, true>;
+    using scalar_vector_wrap_t = nmfd::detail::vector_wrap<scalar_space_type, true, true>;
 
     std::shared_ptr<orig_space_type> orig_vec_space_;
     std::shared_ptr<scalar_space_type> scalar_space_;
@@ -144,6 +218,7 @@ private:
     orig_vector_wrap_t r_wrap_;
     scalar_vector_wrap_t vx_wrap_;
     scalar_vector_wrap_t vr_wrap_;
+    detail::dense1_extended_pair_solve<orig_solver_type, orig_space_type> pair_solve_;
 };
 
 }
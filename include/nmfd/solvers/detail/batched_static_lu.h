@@ -0,0 +1,164 @@
+// Copyright © 2016-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_DETAIL_BATCHED_STATIC_LU_H__
+#define __NMFD_DETAIL_BATCHED_STATIC_LU_H__
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include <nmfd/operations/batched_static_vector_space.h>
+
+namespace nmfd
+{
+namespace solvers
+{
+namespace detail
+{
+
+/**
+*   Gaussian elimination with partial pivoting for a batch of Dim x Dim systems stored as structure of arrays
+*   (see operations::batched_static_matrix). All loops are over contiguous systems, row interchanges are done
+*   by per system selects instead of branches, so systems with different pivots do not break vectorization.
+*   Systems with zero (or non finite) pivot get ok_b = 0 and zero solution, the rest of the batch is not affected.
+*/
+template<class T, int Dim>
+class batched_static_lu
+{
+public:
+    using matrix_type = operations::batched_static_matrix<T,Dim>;
+    using vector_type = operations::batched_static_vector<T,Dim>;
+    using mask_type = std::vector<unsigned char>;
+
+    void init(std::size_t batch_size)
+    {
+        n_ = batch_size;
+        piv_.assign(n_, 0);
+        amax_.assign(n_, T(0));
+        inv_diag_.assign(Dim*n_, T(0));
+        l_.assign(n_, T(0));
+    }
+
+    /// solves a_b*x_b = rhs_b inplace (x contains rhs on entry), a is destroyed; ok_b is reset for singular systems
+    void solve(matrix_type &a, vector_type &x, mask_type &ok)
+    {
+        for(int k = 0; k < Dim; ++k)
+        {
+            //pivot search
+            {
+                const T *a_kk = a.component(k,k);
+                for(std::size_t b = 0; b < n_; ++b)
+                {
+                    piv_[b] = k;
+                    amax_[b] = std::abs(a_kk[b]);
+                }
+            }
+            for(int r = k+1; r < Dim; ++r)
+            {
+                const T *a_rk = a.component(r,k);
+                for(std::size_t b = 0; b < n_; ++b)
+                {
+                    const bool s = std::abs(a_rk[b]) > amax_[b];
+                    piv_[b] = s?r:piv_[b];
+                    amax_[b] = s?std::abs(a_rk[b]):amax_[b];
+                }
+            }
+            //row interchange
+            for(int r = k+1; r < Dim; ++r)
+            {
+                for(int j = k; j < Dim; ++j)
+                {
+                    swap_rows(piv_.data(), r, a.component(k,j), a.component(r,j));
+                }
+                swap_rows(piv_.data(), r, x.component(k), x.component(r));
+            }
+            //pivot check and elimination
+            const T *a_kk = a.component(k,k);
+            T *inv_k = inv_diag_.data() + k*n_;
+            for(std::size_t b = 0; b < n_; ++b)
+            {
+                const bool valid = (a_kk[b] != T(0))&&std::isfinite(a_kk[b]);
+                ok[b] = valid?ok[b]:static_cast<unsigned char>(0);
+                inv_k[b] = valid?T(1)/a_kk[b]:T(0);
+            }
+            const T *x_k = x.component(k);
+            for(int r = k+1; r < Dim; ++r)
+            {
+                const T *a_rk = a.component(r,k);
+                for(std::size_t b = 0; b < n_; ++b)
+                {
+                    l_[b] = a_rk[b]*inv_k[b];
+                }
+                for(int j = k+1; j < Dim; ++j)
+                {
+                    const T *a_kj = a.component(k,j);
+                    T *a_rj = a.component(r,j);
+                    for(std::size_t b = 0; b < n_; ++b)
+                    {
+                        a_rj[b] -= l_[b]*a_kj[b];
+                    }
+                }
+                T *x_r = x.component(r);
+                for(std::size_t b = 0; b < n_; ++b)
+                {
+                    x_r[b] -= l_[b]*x_k[b];
+                }
+            }
+        }
+        //back substitution
+        for(int k = Dim-1; k >= 0; --k)
+        {
+            T *x_k = x.component(k);
+            for(int j = k+1; j < Dim; ++j)
+            {
+                const T *a_kj = a.component(k,j);
+                const T *x_j = x.component(j);
+                for(std::size_t b = 0; b < n_; ++b)
+                {
+                    x_k[b] -= a_kj[b]*x_j[b];
+                }
+            }
+            const T *inv_k = inv_diag_.data() + k*n_;
+            for(std::size_t b = 0; b < n_; ++b)
+            {
+                x_k[b] = ok[b]?x_k[b]*inv_k[b]:T(0);
+            }
+        }
+    }
+
+private:
+    std::size_t n_ = 0;
+    std::vector<int> piv_;
+    std::vector<T> amax_, inv_diag_, l_;
+
+    /// exchanges values of rows k and r for systems with piv_b == r
+    void swap_rows(const int *piv, int r, T *v_k, T *v_r)const
+    {
+        for(std::size_t b = 0; b < n_; ++b)
+        {
+            const bool s = (piv[b] == r);
+            const T t_k = v_k[b], t_r = v_r[b];
+            v_k[b] = s?t_r:t_k;
+            v_r[b] = s?t_k:t_r;
+        }
+    }
+};
+
+} // namespace detail
+} // namespace solvers
+} // namespace nmfd
+
+#endif
@@ -0,0 +1,81 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_BLOCK_APPLY_H__
+#define __NMFD_BLOCK_APPLY_H__
+
+#include <utility>
+
+namespace nmfd {
+namespace solvers {
+namespace detail {
+
+/// f(0:n) := A*x(0:n) for multivectors x and f with m columns.
+/// If LinearOperator has apply_multi(x, f, m, n) it is called, so operator data (matrix, stencil coefficients)
+/// is streamed once for the whole block; otherwise columns are copied into x_tmp and operator is applied one by one.
+template<class VectorOperations, class LinearOperator, class = int>
+struct block_apply
+{
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using Ord = typename VectorOperations::Ord;
+
+    static void apply(
+        const VectorOperations &vec_ops, const LinearOperator &A, const multivector_type &x, multivector_type &f, Ord m, Ord n,
+        vector_type &x_tmp, vector_type &f_tmp
+    )
+    {
+        for(Ord k = 0; k < n; ++k)
+        {
+            vec_ops.assign(x, m, k, x_tmp);
+            A.apply(x_tmp, f_tmp);
+            vec_ops.assign(f_tmp, f, m, k);
+        }
+    }
+};
+
+template<class VectorOperations, class LinearOperator>
+struct block_apply
+<
+    VectorOperations, LinearOperator,
+    decltype
+    (
+        (void)(std::declval<const LinearOperator&>().apply_multi(
+            std::declval<const typename VectorOperations::multivector_type&>(), std::declval<typename VectorOperations::multivector_type&>(),
+            std::declval<typename VectorOperations::Ord>(), std::declval<typename VectorOperations::Ord>()
+        )),
+        int(0)
+    )
+>
+{
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using Ord = typename VectorOperations::Ord;
+
+    static void apply(
+        const VectorOperations &, const LinearOperator &A, const multivector_type &x, multivector_type &f, Ord m, Ord n,
+        vector_type &, vector_type &
+    )
+    {
+        A.apply_multi(x, f, m, n);
+    }
+};
+
+}
+}
+}
+
+#endif
@@ -24,6 +24,10 @@
 #include <iomanip>
 #include <memory>
 #include <random>
+#include <limits>
+#include <algorithm>
+#include <complex>
+#include <vector>
 
 #include <scfd/memory/host.h>
 #include <scfd/arrays/tensor_array_nd.h>
@@ -411,7 +415,352 @@ public:
         H(col+1,col) = static_cast<T>(0); //remove numerical noise below diagonal
         apply_plane_rotation(s(col), s(col+1), cs_(col), sn_(col) );
     }
-    
+
+    /// R(0:n,0:n) is upper triangular factor of thin QR factorization A = Q*R of n columns. Removes the first column
+    /// of A: columns of R are shifted left and the upper Hessenberg result is reduced back to triangular form by plane
+    /// rotations (cs(j),sn(j)) of rows j,j+1, j = 0..n-2. The same rotations must be applied to columns j,j+1 of Q
+    /// (see apply_plane_rotation), after that the first n-1 columns of Q and R(0:n-1,0:n-1) factorize reduced A.
+    void qr_delete_first_column(matrix_type& R, const Card n, vector_type& cs, vector_type& sn) const
+    {
+        for(Card j = 0; j+1 < n; ++j)
+        {
+            for(Card i = 0; i <= j+1; ++i)
+            {
+                R(i,j) = R(i,j+1);
+            }
+        }
+        for(Card i = 0; i < n; ++i)
+        {
+            R(i,n-1) = static_cast<T>(0);
+        }
+        for(Card j = 0; j+1 < n; ++j)
+        {
+            generate_plane_rotation(R(j,j), R(j+1,j), cs(j), sn(j));
+            for(Card k = j; k+1 < n; ++k)
+            {
+                apply_plane_rotation(R(j,k), R(j+1,k), cs(j), sn(j));
+            }
+            R(j+1,j) = static_cast<T>(0); //remove numerical noise below diagonal
+        }
+    }
+
+    /// inplace Cholesky factorization A(0:n,0:n) = R^T*R of the leading n x n block,
+    /// only upper triangle of A is used, R is stored in the upper triangle, lower one is zeroed.
+    /// returns false if the block is not (numerically) positive definite.
+    bool cholesky_upper(matrix_type& A, const Card n) const
+    {
+        for(Card j = 0; j < n; ++j)
+        {
+            T d = A(j,j);
+            for(Card k = 0; k < j; ++k)
+            {
+                d -= A(k,j)*A(k,j);
+            }
+            if(!(d > static_cast<T>(0)))
+            {
+                return false;
+            }
+            A(j,j) = std::sqrt(d);
+            for(Card l = j+1; l < n; ++l)
+            {
+                T v = A(j,l);
+                for(Card k = 0; k < j; ++k)
+                {
+                    v -= A(k,j)*A(k,l);
+                }
+                A(j,l) = v/A(j,j);
+            }
+            for(Card l = 0; l < j; ++l)
+            {
+                A(j,l) = static_cast<T>(0);
+            }
+        }
+        return true;
+    }
+
+    /// inplace reduction of the leading n x n block of A to upper Hessenberg form by Householder similarity
+    /// transformations (eigenvalues are preserved), entries below subdiagonal are zeroed.
+    void reduce_to_hessenberg(matrix_type& A, const Card n) const
+    {
+        std::vector<T> v(n);
+        for(Card k = 0; k+2 < n; ++k)
+        {
+            T alpha = 0;
+            for(Card i = k+1; i < n; ++i) alpha += A(i,k)*A(i,k);
+            alpha = std::sqrt(alpha);
+            if(alpha == static_cast<T>(0)) continue;
+            if(A(k+1,k) > static_cast<T>(0)) alpha = -alpha;
+            T vv = 0;
+            for(Card i = k+1; i < n; ++i)
+            {
+                v[i] = A(i,k);
+                if(i == k+1) v[i] -= alpha;
+                vv += v[i]*v[i];
+            }
+            if(vv == static_cast<T>(0)) continue;
+            for(Card j = k; j < n; ++j)
+            {
+                T s = 0;
+                for(Card i = k+1; i < n; ++i) s += v[i]*A(i,j);
+                s *= static_cast<T>(2)/vv;
+                for(Card i = k+1; i < n; ++i) A(i,j) -= s*v[i];
+            }
+            for(Card i = 0; i < n; ++i)
+            {
+                T s = 0;
+                for(Card l = k+1; l < n; ++l) s += A(i,l)*v[l];
+                s *= static_cast<T>(2)/vv;
+                for(Card l = k+1; l < n; ++l) A(i,l) -= s*v[l];
+            }
+            for(Card i = k+2; i < n; ++i) A(i,k) = static_cast<T>(0);
+        }
+    }
+
+    /// eigenvalues (wr + i*wi) of the leading n x n block of upper Hessenberg matrix H.
+    /// H is copied into work matrix W (which is destroyed). Francis implicit double shift QR iterations
+    /// (Golub, Van Loan, Matrix Computations, sec. 7.5) are applied to the active unreduced diagonal block,
+    /// subdiagonal entries below eps*(|W(k-1,k-1)|+|W(k,k)|) are set to zero, 1x1 and 2x2 blocks split off
+    /// give eigenvalues. Only the active block is updated, since its eigenvalues do not depend on the rest.
+    /// complex conjugate pair is stored in adjacent positions, with positive imaginary part first.
+    /// returns false if iterations failed to converge.
+    bool hessenberg_eigenvalues(const matrix_type& H, const Card n, matrix_type& W, vector_type& wr, vector_type& wi) const
+    {
+        const T eps = std::numeric_limits<T>::epsilon();
+        const int max_iters_per_eigenvalue = 30*std::max(static_cast<int>(n), 2);
+        for(Card j = 0; j < n; ++j)
+        {
+            for(Card k = 0; k < n; ++k)
+            {
+                W(j,k) = ( (j <= k+1) ? H(j,k) : static_cast<T>(0) );
+            }
+        }
+        T h_norm = 0;
+        for(Card j = 0; j < n; ++j)
+        {
+            for(Card k = (j > 0 ? j-1 : 0); k < n; ++k)
+            {
+                h_norm = std::max(h_norm, std::abs(W(j,k)));
+            }
+        }
+        int hi = static_cast<int>(n)-1, iters = 0;
+        while(hi >= 0)
+        {
+            //lo is the first row of the unreduced block ending at hi
+            int lo = hi;
+            while(lo > 0)
+            {
+                T diag = std::abs(W(lo-1,lo-1)) + std::abs(W(lo,lo));
+                if(diag == static_cast<T>(0)) diag = h_norm;
+                if(std::abs(W(lo,lo-1)) <= eps*diag)
+                {
+                    W(lo,lo-1) = static_cast<T>(0);
+                    break;
+                }
+                --lo;
+            }
+            if(lo == hi)
+            {
+                wr(hi) = W(hi,hi);
+                wi(hi) = static_cast<T>(0);
+                hi -= 1;
+                iters = 0;
+                continue;
+            }
+            if(lo == hi-1)
+            {
+                eigenvalues_2x2(W(hi-1,hi-1), W(hi-1,hi), W(hi,hi-1), W(hi,hi), wr(hi-1), wi(hi-1), wr(hi), wi(hi));
+                hi -= 2;
+                iters = 0;
+                continue;
+            }
+            if(++iters > max_iters_per_eigenvalue) return false;
+            //shifts are eigenvalues of the trailing 2x2 block: polynomial z^2 - s*z + t
+            T s = W(hi-1,hi-1) + W(hi,hi);
+            T t = W(hi-1,hi-1)*W(hi,hi) - W(hi-1,hi)*W(hi,hi-1);
+            if(iters%11 == 0)
+            {
+                //ad hoc shift breaks possible cycling of the standard one
+                const T e = std::abs(W(hi,hi-1)) + std::abs(W(hi-1,hi-2));
+                s = static_cast<T>(1.5)*e + W(hi,hi);
+                t = e*e + s*W(hi,hi) - W(hi,hi)*W(hi,hi);
+            }
+            //first column of (W - z1*I)(W - z2*I) has three nonzero entries
+            T x = W(lo,lo)*W(lo,lo) + W(lo,lo+1)*W(lo+1,lo) - s*W(lo,lo) + t;
+            T y = W(lo+1,lo)*(W(lo,lo) + W(lo+1,lo+1) - s);
+            T z = W(lo+1,lo)*W(lo+2,lo+1);
+            for(int k = lo; k <= hi-2; ++k)
+            {
+                T v[3];
+                T beta = householder_vector(x, y, z, v);
+                if(beta != static_cast<T>(0))
+                {
+                    const int c0 = std::max(lo, k-1), r1 = std::min(k+3, hi);
+                    for(int j = c0; j <= hi; ++j)
+                    {
+                        const T p = beta*(v[0]*W(k,j) + v[1]*W(k+1,j) + v[2]*W(k+2,j));
+                        W(k,j) -= p*v[0]; W(k+1,j) -= p*v[1]; W(k+2,j) -= p*v[2];
+                    }
+                    for(int i = lo; i <= r1; ++i)
+                    {
+                        const T p = beta*(W(i,k)*v[0] + W(i,k+1)*v[1] + W(i,k+2)*v[2]);
+                        W(i,k) -= p*v[0]; W(i,k+1) -= p*v[1]; W(i,k+2) -= p*v[2];
+                    }
+                }
+                //bulge moves one column down
+                x = W(k+1,k);
+                y = W(k+2,k);
+                z = (k < hi-2 ? W(k+3,k) : static_cast<T>(0));
+            }
+            //last reflector acts on two rows only
+            T v[3];
+            T beta = householder_vector(x, y, static_cast<T>(0), v);
+            if(beta != static_cast<T>(0))
+            {
+                for(int j = hi-2; j <= hi; ++j)
+                {
+                    const T p = beta*(v[0]*W(hi-1,j) + v[1]*W(hi,j));
+                    W(hi-1,j) -= p*v[0]; W(hi,j) -= p*v[1];
+                }
+                for(int i = lo; i <= hi; ++i)
+                {
+                    const T p = beta*(W(i,hi-1)*v[0] + W(i,hi)*v[1]);
+                    W(i,hi-1) -= p*v[0]; W(i,hi) -= p*v[1];
+                }
+            }
+            //entries below subdiagonal are rounding noise of the bulge chase
+            for(int i = lo+2; i <= hi; ++i)
+            {
+                for(int j = lo; j <= i-2; ++j) W(i,j) = static_cast<T>(0);
+            }
+        }
+        return true;
+    }
+
+    /// solves A(0:n,0:n)*x = b (or A^T*x = b if transposed) by Gaussian elimination with partial pivoting.
+    /// A is copied into work matrix W, b is replaced with solution.
+    /// returns false if matrix is (numerically) singular.
+    bool solve_linear_system(const matrix_type& A, const Card n, matrix_type& W, vector_type& b, bool transposed = false) const
+    {
+        for(Card j = 0; j < n; ++j)
+        {
+            for(Card k = 0; k < n; ++k)
+            {
+                W(j,k) = (transposed ? A(k,j) : A(j,k));
+            }
+        }
+        for(Card k = 0; k < n; ++k)
+        {
+            Card p = k;
+            for(Card j = k+1; j < n; ++j)
+            {
+                if(std::abs(W(j,k)) > std::abs(W(p,k))) p = j;
+            }
+            if(W(p,k) == static_cast<T>(0))
+            {
+                return false;
+            }
+            if(p != k)
+            {
+                for(Card l = k; l < n; ++l) std::swap(W(k,l), W(p,l));
+                std::swap(b(k), b(p));
+            }
+            for(Card j = k+1; j < n; ++j)
+            {
+                T f = W(j,k)/W(k,k);
+                for(Card l = k+1; l < n; ++l)
+                {
+                    W(j,l) -= f*W(k,l);
+                }
+                b(j) -= f*b(k);
+                W(j,k) = static_cast<T>(0);
+            }
+        }
+        solve_upper_triangular_subsystem(W, b, n);
+        return true;
+    }
+
+    /// eigenvector of the leading n x n block of A corresponding to the eigenvalue lr + i*li
+    /// (as found, for example, by hessenberg_eigenvalues) by inverse iteration in complex arithmetics.
+    /// real and imaginary parts are written into vr and vi, for real eigenvalue vi is zero.
+    /// vector is normalized in 2-norm.
+    void eigenvector_inverse_iteration(const matrix_type& A, const Card n, const T lr, const T li, vector_type& vr, vector_type& vi, const int iters_num = 3) const
+    {
+        using C = std::complex<T>;
+        T anorm = 0;
+        for(Card j = 0; j < n; ++j)
+        {
+            for(Card k = 0; k < n; ++k)
+            {
+                anorm = std::max(anorm, std::abs(A(j,k)));
+            }
+        }
+        if(anorm == static_cast<T>(0)) anorm = static_cast<T>(1);
+        //shift is perturbed, so that shifted matrix is not exactly singular
+        const T eps = std::numeric_limits<T>::epsilon()*anorm*static_cast<T>(n);
+        const C shift(lr + eps, li);
+        std::vector<C> lu(n*n), v(n, C(1));
+        std::vector<Card> piv(n);
+        for(Card j = 0; j < n; ++j)
+        {
+            for(Card k = 0; k < n; ++k)
+            {
+                lu[j*n+k] = C(A(j,k));
+            }
+            lu[j*n+j] -= shift;
+        }
+        for(Card k = 0; k < n; ++k)
+        {
+            Card p = k;
+            for(Card j = k+1; j < n; ++j)
+            {
+                if(std::abs(lu[j*n+k]) > std::abs(lu[p*n+k])) p = j;
+            }
+            piv[k] = p;
+            if(p != k)
+            {
+                for(Card l = 0; l < n; ++l) std::swap(lu[k*n+l], lu[p*n+l]);
+            }
+            if(std::abs(lu[k*n+k]) < eps) lu[k*n+k] = C(eps);
+            for(Card j = k+1; j < n; ++j)
+            {
+                C f = lu[j*n+k]/lu[k*n+k];
+                lu[j*n+k] = f;
+                for(Card l = k+1; l < n; ++l)
+                {
+                    lu[j*n+l] -= f*lu[k*n+l];
+                }
+            }
+        }
+        for(int it = 0; it < iters_num; ++it)
+        {
+            for(Card k = 0; k < n; ++k)
+            {
+                if(piv[k] != k) std::swap(v[k], v[piv[k]]);
+                for(Card j = k+1; j < n; ++j)
+                {
+                    v[j] -= lu[j*n+k]*v[k];
+                }
+            }
+            for(Card j = n; j-->0;)
+            {
+                for(Card l = j+1; l < n; ++l)
+                {
+                    v[j] -= lu[j*n+l]*v[l];
+                }
+                v[j] /= lu[j*n+j];
+            }
+            T norm = 0;
+            for(Card j = 0; j < n; ++j) norm += std::norm(v[j]);
+            norm = std::sqrt(norm);
+            for(Card j = 0; j < n; ++j) v[j] /= norm;
+        }
+        for(Card j = 0; j < n; ++j)
+        {
+            vr(j) = v[j].real();
+            vi(j) = (li == static_cast<T>(0) ? static_cast<T>(0) : v[j].imag());
+        }
+    }
+
     void print_col_vector(const vector_type& vec, int prec = 2)
     {
         if(prec > 2)
@@ -454,6 +803,42 @@ public:
         }
     }
 
+
+private:
+    /// Householder reflector I - beta*v*v^T which maps (x,y,z) to multiple of e_0; returns beta (zero for zero vector)
+    static T householder_vector(const T x, const T y, const T z, T v[3])
+    {
+        const T scale = std::abs(x) + std::abs(y) + std::abs(z);
+        if(scale == static_cast<T>(0))
+        {
+            v[0] = v[1] = v[2] = static_cast<T>(0);
+            return static_cast<T>(0);
+        }
+        v[0] = x/scale; v[1] = y/scale; v[2] = z/scale;
+        const T norm = std::sqrt(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+        v[0] += (v[0] >= static_cast<T>(0) ? norm : -norm);
+        return static_cast<T>(2)/(v[0]*v[0] + v[1]*v[1] + v[2]*v[2]);
+    }
+    /// eigenvalues of [a b;c d]; for real pair the root of larger magnitude shift is calculated directly
+    /// and the other one from the determinant to avoid cancellation
+    static void eigenvalues_2x2(const T a, const T b, const T c, const T d, T& re1, T& im1, T& re2, T& im2)
+    {
+        const T half_diff = static_cast<T>(0.5)*(a - d);
+        const T disc = half_diff*half_diff + b*c;
+        if(disc >= static_cast<T>(0))
+        {
+            const T shift = half_diff + (half_diff >= static_cast<T>(0) ? std::sqrt(disc) : -std::sqrt(disc));
+            re1 = d + shift;
+            re2 = (shift != static_cast<T>(0) ? d - b*c/shift : d);
+            im1 = im2 = static_cast<T>(0);
+        }
+        else
+        {
+            re1 = re2 = d + half_diff;
+            im1 = std::sqrt(-disc);
+            im2 = -std::sqrt(-disc);
+        }
+    }
 };
 
 }
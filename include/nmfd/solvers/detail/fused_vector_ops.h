@@ -0,0 +1,229 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_FUSED_VECTOR_OPS_H__
+#define __NMFD_FUSED_VECTOR_OPS_H__
+
+#include <utility>
+
+/**
+*   Wrappers around optional fused BLAS1 operations of VectorOperations.
+*   If VectorOperations provides the operation it is called (one sweep over data),
+*   otherwise it is composed from basic VectorOperations concept methods.
+*/
+
+namespace nmfd {
+namespace solvers {
+namespace detail {
+
+/// mx[k] := mul_x*x; NOTE x is scaled in place by the fallback, so its value is undefined after the call
+template<class VectorOperations, class = int>
+struct fused_scale_assign
+{
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using Ord = typename VectorOperations::Ord;
+
+    static void apply(const VectorOperations &vec_ops, scalar_type mul_x, vector_type &x, multivector_type &mx, Ord m, Ord k)
+    {
+        vec_ops.scale(mul_x, x);
+        vec_ops.assign(x, mx, m, k);
+    }
+};
+
+template<class VectorOperations>
+struct fused_scale_assign
+<
+    VectorOperations,
+    decltype
+    (
+        (void)(std::declval<const VectorOperations&>().scale_assign(
+            std::declval<typename VectorOperations::scalar_type>(), std::declval<const typename VectorOperations::vector_type&>(),
+            std::declval<typename VectorOperations::multivector_type&>(),
+            std::declval<typename VectorOperations::Ord>(), std::declval<typename VectorOperations::Ord>()
+        )),
+        int(0)
+    )
+>
+{
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using Ord = typename VectorOperations::Ord;
+
+    static void apply(const VectorOperations &vec_ops, scalar_type mul_x, vector_type &x, multivector_type &mx, Ord m, Ord k)
+    {
+        vec_ops.scale_assign(mul_x, x, mx, m, k);
+    }
+};
+
+/// y := mul_x*mx[k] + mul_y*y; returns (y,y) of the updated y
+template<class VectorOperations, class = int>
+struct fused_axpy_dot
+{
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using Ord = typename VectorOperations::Ord;
+
+    static scalar_type apply(
+        const VectorOperations &vec_ops, scalar_type mul_x, const multivector_type &mx, Ord m, Ord k, scalar_type mul_y, vector_type &y
+    )
+    {
+        vec_ops.add_lin_comb(mul_x, mx, m, k, mul_y, y);
+        return vec_ops.scalar_prod(y, y);
+    }
+};
+
+template<class VectorOperations>
+struct fused_axpy_dot
+<
+    VectorOperations,
+    decltype
+    (
+        (void)(std::declval<const VectorOperations&>().axpy_dot(
+            std::declval<typename VectorOperations::scalar_type>(), std::declval<const typename VectorOperations::multivector_type&>(),
+            std::declval<typename VectorOperations::Ord>(), std::declval<typename VectorOperations::Ord>(),
+            std::declval<typename VectorOperations::scalar_type>(), std::declval<typename VectorOperations::vector_type&>()
+        )),
+        int(0)
+    )
+>
+{
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using Ord = typename VectorOperations::Ord;
+
+    static scalar_type apply(
+        const VectorOperations &vec_ops, scalar_type mul_x, const multivector_type &mx, Ord m, Ord k, scalar_type mul_y, vector_type &y
+    )
+    {
+        return vec_ops.axpy_dot(mul_x, mx, m, k, mul_y, y);
+    }
+};
+
+/// res[0] := (mx[k],y), res[1] := (x,y); res is host array
+template<class VectorOperations, class = int>
+struct fused_dot2
+{
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using Ord = typename VectorOperations::Ord;
+
+    static void apply(
+        const VectorOperations &vec_ops, const multivector_type &mx, Ord m, Ord k, const vector_type &x, const vector_type &y, scalar_type *res
+    )
+    {
+        res[0] = vec_ops.scalar_prod(mx, m, k, y);
+        res[1] = vec_ops.scalar_prod(x, y);
+    }
+};
+
+template<class VectorOperations>
+struct fused_dot2
+<
+    VectorOperations,
+    decltype
+    (
+        (void)(std::declval<const VectorOperations&>().dot2(
+            std::declval<const typename VectorOperations::multivector_type&>(),
+            std::declval<typename VectorOperations::Ord>(), std::declval<typename VectorOperations::Ord>(),
+            std::declval<const typename VectorOperations::vector_type&>(), std::declval<const typename VectorOperations::vector_type&>(),
+            std::declval<typename VectorOperations::scalar_type*>()
+        )),
+        int(0)
+    )
+>
+{
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using Ord = typename VectorOperations::Ord;
+
+    static void apply(
+        const VectorOperations &vec_ops, const multivector_type &mx, Ord m, Ord k, const vector_type &x, const vector_type &y, scalar_type *res
+    )
+    {
+        vec_ops.dot2(mx, m, k, x, y, res);
+    }
+};
+
+
+/// res[(l-l0)*(k1-k0) + (k-k0)] := (mx[k],my[l]) for k0 <= k < k1, l0 <= l < l1 (column-major block Gram product); res is host array
+/// if VectorOperations has no multivector-multivector multi_scalar_prod, it is composed column by column
+/// from the vector multi_scalar_prod (one reduction per column of my); tmp is work vector for this fallback
+template<class VectorOperations, class = int>
+struct fused_block_scalar_prod
+{
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using Ord = typename VectorOperations::Ord;
+
+    static void apply(
+        const VectorOperations &vec_ops, const multivector_type &mx, Ord m, Ord k0, Ord k1,
+        const multivector_type &my, Ord my_m, Ord l0, Ord l1, scalar_type *res, vector_type &tmp
+    )
+    {
+        for(Ord l = l0; l < l1; l++)
+        {
+            vec_ops.assign(my, my_m, l, tmp);
+            vec_ops.multi_scalar_prod(mx, m, k0, k1, tmp, res + (l-l0)*(k1-k0));
+        }
+    }
+};
+
+template<class VectorOperations>
+struct fused_block_scalar_prod
+<
+    VectorOperations,
+    decltype
+    (
+        (void)(std::declval<const VectorOperations&>().multi_scalar_prod(
+            std::declval<const typename VectorOperations::multivector_type&>(),
+            std::declval<typename VectorOperations::Ord>(), std::declval<typename VectorOperations::Ord>(),
+            std::declval<typename VectorOperations::Ord>(),
+            std::declval<const typename VectorOperations::multivector_type&>(),
+            std::declval<typename VectorOperations::Ord>(), std::declval<typename VectorOperations::Ord>(),
+            std::declval<typename VectorOperations::Ord>(),
+            std::declval<typename VectorOperations::scalar_type*>()
+        )),
+        int(0)
+    )
+>
+{
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using Ord = typename VectorOperations::Ord;
+
+    static void apply(
+        const VectorOperations &vec_ops, const multivector_type &mx, Ord m, Ord k0, Ord k1,
+        const multivector_type &my, Ord my_m, Ord l0, Ord l1, scalar_type *res, vector_type &
+    )
+    {
+        vec_ops.multi_scalar_prod(mx, m, k0, k1, my, my_m, l0, l1, res);
+    }
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,161 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_GIVENS_LEAST_SQUARES_H__
+#define __NMFD_GIVENS_LEAST_SQUARES_H__
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include <algorithm>
+
+/**
+*   Least squares problem min||c - A*y|| of GMRES family solvers, A is built column by column.
+*   QR factorization of A is updated by plane rotations when a column is appended: all stored rotations are
+*   applied to the new column and then its entries below the diagonal are annihilated from bottom to top.
+*   So Hessenberg column costs O(cols) operations and one new rotation, while columns with several subdiagonal
+*   entries (block Hessenberg matrices, dense leading blocks after deflated restart) are handled as well.
+*   Host matrices are allocated by DenseOperations, which must be initialized with at least (max_rows, max_cols)
+*   before init.
+*/
+
+namespace nmfd {
+namespace solvers {
+namespace detail {
+
+template<class DenseOperations>
+class givens_least_squares
+{
+public:
+    using scalar_type = typename DenseOperations::scalar_type;
+    using vector_type = typename DenseOperations::vector_type;
+    using matrix_type = typename DenseOperations::matrix_type;
+
+private:
+    using T = scalar_type;
+
+    struct rotation
+    {
+        int row; //acts on rows row, row+1
+        T cs, sn;
+    };
+
+    std::shared_ptr<DenseOperations> dense_ops_;
+    int rows_, cols_;
+    matrix_type R_;
+    vector_type w_; //rotated right hand side
+    std::vector<rotation> rotations_;
+
+public:
+    givens_least_squares() : rows_(0), cols_(0)
+    {
+    }
+
+    void init(std::shared_ptr<DenseOperations> dense_ops)
+    {
+        dense_ops_ = std::move(dense_ops);
+        dense_ops_->init_matrix(R_);
+        dense_ops_->init_col_vector(w_);
+        rows_ = cols_ = 0;
+    }
+    void free()
+    {
+        dense_ops_->free_matrix(R_);
+        dense_ops_->free_col_vector(w_);
+    }
+
+    /// starts new problem with right hand side c(0:rows), A has no columns
+    void reset(const vector_type &c, int rows)
+    {
+        dense_ops_->assign_scalar_col_vector(0, w_);
+        for(int j = 0; j < rows; j++)
+        {
+            w_(j) = c(j);
+        }
+        rows_ = rows;
+        cols_ = 0;
+        rotations_.clear();
+    }
+    /// starts new problem with right hand side beta*e_0
+    void reset(T beta)
+    {
+        dense_ops_->assign_scalar_col_vector(0, w_);
+        w_(0) = beta;
+        rows_ = 1;
+        cols_ = 0;
+        rotations_.clear();
+    }
+
+    /// appends column A(0:len,col) of A; returns norm of the least squares residual
+    T add_column(const matrix_type &A, const int col, const int len)
+    {
+        const int k = cols_;
+        for(int j = 0; j < len; j++)
+        {
+            R_(j, k) = A(j, col);
+        }
+        for(int j = len; j < rows_; j++)
+        {
+            R_(j, k) = static_cast<T>(0);
+        }
+        for(const rotation &q: rotations_)
+        {
+            dense_ops_->apply_plane_rotation(R_(q.row, k), R_(q.row+1, k), q.cs, q.sn);
+        }
+        for(int j = len-1; j > k; j--)
+        {
+            if(R_(j, k) == static_cast<T>(0)) continue;
+            rotation q;
+            q.row = j-1;
+            dense_ops_->generate_plane_rotation(R_(j-1, k), R_(j, k), q.cs, q.sn);
+            dense_ops_->apply_plane_rotation(R_(j-1, k), R_(j, k), q.cs, q.sn);
+            R_(j, k) = static_cast<T>(0); //remove numerical noise below diagonal
+            dense_ops_->apply_plane_rotation(w_(j-1), w_(j), q.cs, q.sn);
+            rotations_.push_back(q);
+        }
+        rows_ = std::max(rows_, len);
+        cols_ = k+1;
+        return residual_norm();
+    }
+
+    int cols() const
+    {
+        return cols_;
+    }
+
+    /// norm of the least squares residual for the current columns
+    T residual_norm() const
+    {
+        T res = static_cast<T>(0);
+        for(int j = cols_; j < rows_; j++)
+        {
+            res += w_(j)*w_(j);
+        }
+        return std::sqrt(res);
+    }
+
+    /// y(0:cols()) := solution of the least squares problem
+    void solve(vector_type &y) const
+    {
+        dense_ops_->solve_upper_triangular_subsystem(R_, w_, y, cols_);
+    }
+};
+
+}
+}
+}
+
+#endif
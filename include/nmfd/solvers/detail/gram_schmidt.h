@@ -0,0 +1,203 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_GRAM_SCHMIDT_H__
+#define __NMFD_GRAM_SCHMIDT_H__
+
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include "fused_vector_ops.h"
+
+/**
+*   Gram-Schmidt orthogonalization of a vector against leading columns of orthonormal multivector,
+*   shared by GMRES family solvers.
+*   mgs:  modified Gram-Schmidt, one reduction per column;
+*   cgs:  classical Gram-Schmidt, all inner products in one batched reduction followed by one batched update;
+*   cgs2: cgs repeated twice (classical Gram-Schmidt with reorthogonalization).
+*   reorthogonalization flag is used by mgs only: projection onto each column is iteratively corrected while
+*   the correction exceeds eps*||1||*||w||, where ||w|| is norm of the vector before orthogonalization.
+*   For classical variant reorthogonalization is chosen with cgs2.
+*/
+
+namespace nmfd {
+namespace solvers {
+namespace detail {
+
+enum class orthogonalization_type { mgs, cgs, cgs2 };
+
+inline orthogonalization_type orthogonalization_type_from_string(const std::string &name, const std::string &algo_name)
+{
+    if(name == "mgs") return orthogonalization_type::mgs;
+    if(name == "cgs") return orthogonalization_type::cgs;
+    if(name == "cgs2") return orthogonalization_type::cgs2;
+    throw std::logic_error(algo_name + ": unknown orthogonalization " + name);
+}
+
+template<class VectorOperations>
+class gram_schmidt
+{
+public:
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using Ord = typename VectorOperations::Ord;
+
+private:
+    using T = scalar_type;
+    using fused_axpy_dot_t = fused_axpy_dot<VectorOperations>;
+    using fused_dot2_t = fused_dot2<VectorOperations>;
+
+    static constexpr int max_correction_iterations = 10;
+
+    orthogonalization_type type_;
+    bool reorthogonalization_;
+    T tol_;
+    //host buffers for batched coefficients
+    mutable std::vector<T> coeffs_, corr_;
+    mutable bool correction_failed_;
+
+    T apply(const VectorOperations &vec_ops, const multivector_type &mx, Ord mx_sz, int n, vector_type &w, T *h, bool calc_norm) const
+    {
+        correction_failed_ = false;
+        if(n == 0)
+        {
+            return (calc_norm ? vec_ops.norm(w) : static_cast<T>(0));
+        }
+        if(type_ == orthogonalization_type::mgs)
+        {
+            // norm of w before orthogonalization is needed only by reorthogonalization criterion
+            T w_norm0 = 0;
+            bool fused_norm = (!reorthogonalization_)&&(calc_norm);
+            T w_norm = 0;
+            for(int k = 0; k < n; k++)
+            {
+                T alpha;
+                if((k == 0)&&(reorthogonalization_))
+                {
+                    T prods[2];
+                    fused_dot2_t::apply(vec_ops, mx, mx_sz, 0, w, w, prods); // (mx[0],w) and (w,w) in one sweep
+                    alpha = prods[0];
+                    w_norm0 = std::sqrt(prods[1]);
+                }
+                else
+                {
+                    alpha = vec_ops.scalar_prod(mx, mx_sz, k, w);
+                }
+                if((k == n-1)&&(fused_norm))
+                {
+                    // last update, norm of the result is calculated in the same sweep
+                    w_norm = std::sqrt(fused_axpy_dot_t::apply(vec_ops, -alpha, mx, mx_sz, k, static_cast<T>(1), w));
+                }
+                else
+                {
+                    vec_ops.add_lin_comb(-alpha, mx, mx_sz, k, static_cast<T>(1), w);
+                }
+                if(reorthogonalization_)
+                {
+                    //iterative correction
+                    T c_norm = std::abs(alpha);
+                    int correction_iterations = 0;
+                    while(c_norm > tol_*w_norm0)
+                    {
+                        if(++correction_iterations > max_correction_iterations)
+                        {
+                            correction_failed_ = true;
+                            break;
+                        }
+                        T c = vec_ops.scalar_prod(mx, mx_sz, k, w);
+                        c_norm = std::abs(c);
+                        vec_ops.add_lin_comb(-c, mx, mx_sz, k, static_cast<T>(1), w);
+                        alpha += c;
+                    }
+                }
+                h[k] = alpha;
+            }
+            if(fused_norm)
+            {
+                return w_norm;
+            }
+        }
+        else
+        {
+            int passes = (type_ == orthogonalization_type::cgs2 ? 2 : 1);
+            for(int k = 0; k < n; k++)
+            {
+                h[k] = static_cast<T>(0);
+            }
+            for(int pass = 0; pass < passes; pass++)
+            {
+                vec_ops.multi_scalar_prod(mx, mx_sz, 0, n, w, coeffs_.data());
+                for(int k = 0; k < n; k++)
+                {
+                    corr_[k] = -coeffs_[k];
+                    h[k] += coeffs_[k];
+                }
+                vec_ops.multi_add_lin_comb(corr_.data(), mx, mx_sz, 0, n, static_cast<T>(1), w);
+            }
+        }
+        return (calc_norm ? vec_ops.norm(w) : static_cast<T>(0));
+    }
+
+public:
+    /// throws std::logic_error with algo_name prefix for unknown orthogonalization
+    gram_schmidt(const std::string &orthogonalization, bool reorthogonalization, int max_cols, const std::string &algo_name) :
+        type_(orthogonalization_type_from_string(orthogonalization, algo_name)),
+        reorthogonalization_(reorthogonalization),
+        tol_(std::numeric_limits<T>::epsilon()),
+        coeffs_(max_cols),
+        corr_(max_cols),
+        correction_failed_(false)
+    {
+    }
+
+    orthogonalization_type type() const
+    {
+        return type_;
+    }
+
+    /// sets reorthogonalization threshold to eps*||1||; tmp is work vector which must be in use
+    void init_tolerance(const VectorOperations &vec_ops, vector_type &tmp)
+    {
+        vec_ops.assign_scalar(static_cast<T>(1), tmp);
+        tol_ = std::numeric_limits<T>::epsilon()*std::sqrt(vec_ops.scalar_prod(tmp, tmp));
+    }
+
+    /// w := w - mx(0:n)*h with h(0:n) = mx(0:n)^T*w (mx has mx_sz columns, h is host array); returns ||w|| of the result
+    T orthogonalize(const VectorOperations &vec_ops, const multivector_type &mx, Ord mx_sz, int n, vector_type &w, T *h) const
+    {
+        return apply(vec_ops, mx, mx_sz, n, w, h, true);
+    }
+    /// the same as orthogonalize but without norm of the result (when other projections follow)
+    void project(const VectorOperations &vec_ops, const multivector_type &mx, Ord mx_sz, int n, vector_type &w, T *h) const
+    {
+        apply(vec_ops, mx, mx_sz, n, w, h, false);
+    }
+
+    /// true if iterative correction of the last call did not reach the threshold
+    bool correction_failed() const
+    {
+        return correction_failed_;
+    }
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,117 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_KRYLOV_HIERARCHY_H__
+#define __NMFD_KRYLOV_HIERARCHY_H__
+
+#include <memory>
+#include <string>
+#ifdef NMFD_ENABLE_NLOHMANN
+#include <nlohmann/json.hpp>
+#endif
+#include <nmfd/detail/algo_utils_hierarchy.h>
+#include <nmfd/detail/algo_params_hierarchy.h>
+
+/**
+*   utils, params_hierarchy and utils_hierarchy structures common for GMRES family solvers
+*   (all of them are parametrized by preconditioner only).
+*/
+
+namespace nmfd {
+namespace solvers {
+namespace detail {
+
+template<class VectorOperations, class Log, class ResidualRegularization, class DenseOperations>
+struct krylov_utils
+{
+    std::shared_ptr<VectorOperations> vec_ops;
+    Log *log;
+    std::shared_ptr<ResidualRegularization> residual_reg;
+    std::shared_ptr<DenseOperations> dense_ops;
+    krylov_utils() = default;
+    krylov_utils(
+        std::shared_ptr<VectorOperations> vec_ops_, Log *log_ = nullptr,
+        std::shared_ptr<ResidualRegularization> residual_reg_ = std::make_shared<ResidualRegularization>(),
+        std::shared_ptr<DenseOperations> dense_ops_ = std::make_shared<DenseOperations>()
+    ) :
+        vec_ops(vec_ops_), log(log_), residual_reg(residual_reg_), dense_ops(dense_ops_)
+    {
+    }
+};
+
+template<class Params, class Preconditioner>
+struct krylov_params_hierarchy : public Params
+{
+    using preconditioner_params_hierarchy_type = typename nmfd::detail::algo_params_hierarchy<Preconditioner>::type;
+
+    preconditioner_params_hierarchy_type preconditioner;
+
+    krylov_params_hierarchy(const std::string &log_prefix = "") :
+        Params(log_prefix),
+        preconditioner(this->log_msg_prefix)
+    {
+    }
+    krylov_params_hierarchy(const std::string &log_prefix, const std::string &log_name) :
+        Params(log_prefix, log_name),
+        preconditioner(this->log_msg_prefix)
+    {
+    }
+    krylov_params_hierarchy(
+        const Params &prm_,
+        const preconditioner_params_hierarchy_type &preconditioner_
+    ) : Params(prm_), preconditioner(preconditioner_)
+    {
+    }
+    #ifdef NMFD_ENABLE_NLOHMANN
+    void from_json(const nlohmann::json& j)
+    {
+        Params::from_json(j);
+        preconditioner.from_json(j.at("preconditioner"));
+    }
+    nlohmann::json to_json() const
+    {
+        nlohmann::json  j = Params::to_json(),
+                        j_prec = preconditioner.to_json();
+        j["preconditioner"] = j_prec;
+        return j;
+    }
+    #endif
+};
+
+template<class Utils, class Preconditioner>
+struct krylov_utils_hierarchy : public Utils
+{
+    using preconditioner_utils_hierarchy_type = typename nmfd::detail::algo_utils_hierarchy<Preconditioner>::type;
+
+    preconditioner_utils_hierarchy_type preconditioner;
+
+    krylov_utils_hierarchy() = default;
+    template<class ...Args>
+    krylov_utils_hierarchy(
+        preconditioner_utils_hierarchy_type preconditioner_,
+        Args... args
+    ) :
+        Utils(args...),
+        preconditioner(preconditioner_)
+    {
+    }
+};
+
+}
+}
+}
+
+#endif
@@ -0,0 +1,83 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_PRECONDITIONED_OPERATOR_H__
+#define __NMFD_PRECONDITIONED_OPERATOR_H__
+
+/**
+*   Left/right preconditioned operator and residual evaluations common for GMRES family solvers.
+*   prec may be nullptr (no preconditioner), side is 'L' or 'R'.
+*/
+
+namespace nmfd {
+namespace solvers {
+namespace detail {
+
+/// r := A*x, r := P*r for left preconditioner; for right one x := P*x first, so x is overwritten
+template<class LinearOperator, class Preconditioner, class Vector>
+void apply_preconditioned_operator(const LinearOperator &A, Preconditioner *prec, char side, Vector &x, Vector &r)
+{
+    if((prec != nullptr)&&(side == 'R'))
+    {
+        prec->apply(x);
+    }
+    A.apply(x, r);
+    if((prec != nullptr)&&(side == 'L'))
+    {
+        prec->apply(r);
+    }
+}
+
+/// r := K*x, where K is A, P*A (left preconditioner) or A*P (right one), then r is regularized;
+/// x is overwritten for right preconditioner, so it may be used as tmp buffer only
+template<class LinearOperator, class Preconditioner, class ResidualRegularization, class Vector>
+void calc_krylov_vector(
+    const LinearOperator &A, Preconditioner *prec, char side, ResidualRegularization *residual_reg, Vector &x, Vector &r
+)
+{
+    apply_preconditioned_operator(A, prec, side, x, r);
+    residual_reg->apply(r);
+}
+
+/// r := b - A*x, r := P*r for left preconditioner
+template<class VectorOperations, class LinearOperator, class Preconditioner, class Vector>
+void calc_left_preconditioned_residual(
+    const VectorOperations &vec_ops, const LinearOperator &A, Preconditioner *prec, char side, const Vector &x, const Vector &b, Vector &r
+)
+{
+    A.apply(x, r);
+    vec_ops.add_lin_comb(static_cast<typename VectorOperations::scalar_type>(1), b, static_cast<typename VectorOperations::scalar_type>(-1), r);
+    if((prec != nullptr)&&(side == 'L'))
+    {
+        prec->apply(r);
+    }
+}
+
+/// x := P*x for right preconditioner
+template<class Preconditioner, class Vector>
+void apply_right_preconditioner(Preconditioner *prec, char side, Vector &x)
+{
+    if((prec != nullptr)&&(side == 'R'))
+    {
+        prec->apply(x);
+    }
+}
+
+}
+}
+}
+
+#endif
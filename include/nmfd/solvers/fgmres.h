@@ -0,0 +1,395 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_FGMRES_H__
+#define __NMFD_FGMRES_H__
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cmath>
+#ifdef NMFD_ENABLE_NLOHMANN
+#include <nlohmann/json.hpp>
+#endif
+#include "detail/monitor_call_wrap.h"
+#include <nmfd/detail/algo_utils_hierarchy.h>
+#include <nmfd/detail/algo_params_hierarchy.h>
+#include <nmfd/detail/algo_hierarchy_creator.h>
+#include "iter_solver_base.h"
+#include "detail/dense_operations.h"
+#include "detail/gram_schmidt.h"
+#include "detail/givens_least_squares.h"
+#include "detail/krylov_hierarchy.h"
+#include "detail/residual_regularization_dummy.h"
+#include <nmfd/preconditioners/dummy.h>
+
+namespace nmfd
+{
+namespace solvers
+{
+
+/**
+ * Flexible restarted GMRES (right preconditioned only).
+ * Preconditioned directions Z(j) = M^{-1}V(j) are stored, so preconditioner may change
+ * from one iteration to another (inner iterative solvers, multigrid with iterative coarse solver, etc.)
+ * and solution update is constructed directly from Z without any additional preconditioner application.
+ * Costs one more multivector of basis_size vectors compared with gmres.
+ * Template parameters demands are the same as for gmres.
+ **/
+
+template
+<
+     class VectorOperations, class Monitor, class Log,
+     class LinearOperator, class Preconditioner = preconditioners::dummy<VectorOperations,LinearOperator>,
+     class ResidualRegulariation = detail::residual_regularization_dummy,
+     class DenseOperations = detail::dense_operations<typename VectorOperations::Ord, typename VectorOperations::scalar_type>
+>
+class fgmres : public iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, Preconditioner>
+{
+    using parent_t = iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, Preconditioner>;
+    using logged_obj_t = typename parent_t::logged_obj_t;
+    using logged_obj_params_t = typename parent_t::logged_obj_params_t;
+
+public:
+    using scalar_type =  typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using linear_operator_type =  LinearOperator;
+    using preconditioner_type = Preconditioner;
+    using vector_operations_type = VectorOperations;
+    using dense_operations_t = DenseOperations;
+    using monitor_type = Monitor;
+    using log_type = Log;
+    using residual_regulaization_t = ResidualRegulariation;
+
+
+    struct params : public logged_obj_params_t
+    {
+        unsigned basis_size; //size of the krylov basis
+        unsigned batch_size; //residual estimate is logged each batch_size iterations
+        std::string orthogonalization; //mgs, cgs or cgs2
+        bool reorthogonalization; //iterative correction of projections in mgs (see detail/gram_schmidt.h)
+        typename Monitor::params monitor;
+
+        params(const std::string &log_prefix = "", const std::string &log_name = "fgmres::") :
+            logged_obj_params_t(0, log_prefix+log_name),
+            basis_size(20),
+            batch_size(5),
+            orthogonalization("mgs"),
+            reorthogonalization(false),
+            monitor( typename Monitor::params(this->log_msg_prefix) )
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            basis_size = j.value("basis_size", basis_size);
+            batch_size = j.value("batch_size", batch_size);
+            orthogonalization = j.value("orthogonalization", orthogonalization);
+            reorthogonalization = j.value("reorthogonalization", reorthogonalization);
+            monitor.from_json(j.at("monitor"));
+        }
+        nlohmann::json to_json() const
+        {
+            return
+                nlohmann::json
+                {
+                    {"type", "fgmres"},
+                    {"basis_size", basis_size},
+                    {"batch_size", batch_size},
+                    {"orthogonalization", orthogonalization},
+                    {"reorthogonalization", reorthogonalization},
+                    {"monitor", monitor.to_json()}
+                };
+        }
+        #endif
+    };
+    using utils = detail::krylov_utils<vector_operations_type, Log, residual_regulaization_t, dense_operations_t>;
+    using params_hierarchy = detail::krylov_params_hierarchy<params, Preconditioner>;
+    using utils_hierarchy = detail::krylov_utils_hierarchy<utils, Preconditioner>;
+
+private:
+    using T = scalar_type;
+    using T_vec = vector_type;
+    using T_mvec = multivector_type;
+
+    using D_vec = typename dense_operations_t::vector_type;
+    using D_mat = typename dense_operations_t::matrix_type;
+
+    using monitor_call_wrap_t = detail::monitor_call_wrap<VectorOperations, Monitor>;
+
+    mutable T_mvec V_;
+    mutable T_mvec Z_;
+    mutable T_vec r_;
+    mutable T_vec y_;
+    mutable T_vec x_tmp_;
+
+    //parameters:
+    params prms_;
+    int m_;
+    detail::gram_schmidt<VectorOperations> orth_;
+
+    //host dense operations vectors and matrices
+    mutable D_mat H_;
+    mutable D_vec s_h_;
+    //QR factorization of H_ by Givens rotations
+    mutable detail::givens_least_squares<dense_operations_t> lsq_;
+    //host buffer for Gram-Schmidt and solution coefficients
+    mutable std::vector<T> orth_coeffs_;
+
+
+    void calc_residual(const linear_operator_type &A, const T_vec &x, const T_vec &b, T_vec &r)const
+    {
+        A.apply(x, r);
+        vec_ops_->add_lin_comb(static_cast<T>(1.0), b, static_cast<T>(-1.0), r);
+        residual_reg_->apply(r);
+    }
+
+    void init_host()
+    {
+        dense_ops_->init_matrix(H_);
+        dense_ops_->init_col_vector(s_h_);
+        lsq_.init(dense_ops_);
+    }
+
+    void free_host_()
+    {
+        dense_ops_->free_matrix(H_);
+        dense_ops_->free_col_vector(s_h_);
+        lsq_.free();
+    }
+
+    void init_all() const
+    {
+        vec_ops_->init_vector( r_ );
+        vec_ops_->init_vector( y_ );
+        vec_ops_->init_vector( x_tmp_ );
+        vec_ops_->init_multivector( V_, m_+1 );
+        vec_ops_->init_multivector( Z_, m_ );
+    }
+    void start_use_all() const
+    {
+        vec_ops_->start_use_vector( r_ );
+        vec_ops_->start_use_vector( y_ );
+        vec_ops_->start_use_vector( x_tmp_ );
+        vec_ops_->start_use_multivector( V_, m_+1 );
+        vec_ops_->start_use_multivector( Z_, m_ );
+    }
+    void stop_use_all() const
+    {
+        vec_ops_->stop_use_vector( r_ );
+        vec_ops_->stop_use_vector( y_ );
+        vec_ops_->stop_use_vector( x_tmp_ );
+        vec_ops_->stop_use_multivector( V_, m_+1 );
+        vec_ops_->stop_use_multivector( Z_, m_ );
+    }
+    void free_all() const
+    {
+        vec_ops_->free_vector( r_ );
+        vec_ops_->free_vector( y_ );
+        vec_ops_->free_vector( x_tmp_ );
+        vec_ops_->free_multivector( V_, m_+1 );
+        vec_ops_->free_multivector( Z_, m_ );
+    }
+
+    /// orthogonalizes r_ against V(0:i), writes coefficients into H(0:i,i) and returns norm of orthogonalized r_
+    T orthogonalize(const int i) const
+    {
+        T h_ip = orth_.orthogonalize(*vec_ops_, V_, m_+1, i+1, r_, orth_coeffs_.data());
+        if(orth_.correction_failed())
+        {
+            logged_obj_t::warning_f("failed in Gram-Schmidt reorthogonalization in iteration %i", i);
+        }
+        for(int k = 0; k <= i; k++)
+        {
+            H_(k, i) = orth_coeffs_[k];
+        }
+        return h_ip;
+    }
+
+    /// x := x + Z(0:i)*y, where y solves least squares problem; r_ gets new residual
+    void update_solution(const linear_operator_type &A, const int i, const T_vec &b, T_vec &x) const
+    {
+        lsq_.solve(s_h_);
+        for(int j = 0; j <= i; j++)
+        {
+            orth_coeffs_[j] = s_h_(j);
+        }
+        vec_ops_->assign_scalar(static_cast<T>(0), y_);
+        vec_ops_->multi_add_lin_comb(orth_coeffs_.data(), Z_, m_, 0, i+1, static_cast<T>(1), y_);
+        residual_reg_->apply(y_);
+        vec_ops_->add_lin_comb(static_cast<T>(1), y_, static_cast<T>(1), x);
+        calc_residual(A, x, b, r_);
+    }
+
+protected:
+    using parent_t::monitor_;
+    using parent_t::vec_ops_;
+    using parent_t::prec_;
+    std::shared_ptr<dense_operations_t> dense_ops_;
+    std::shared_ptr<residual_regulaization_t> residual_reg_;
+
+public:
+    ~fgmres()
+    {
+        free_host_();
+        free_all();
+    }
+
+    fgmres(
+        std::shared_ptr<vector_operations_type> vec_ops,
+        Log *log = nullptr,
+        const params& prm = params(),
+        std::shared_ptr<preconditioner_type> prec = nullptr,
+        std::shared_ptr<residual_regulaization_t> residual_reg = std::make_shared<residual_regulaization_t>(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        parent_t(std::move(vec_ops), log, prm, prm.monitor, std::move(prec) ),
+        prms_(prm),
+        m_(prm.basis_size),
+        orth_(prm.orthogonalization, prm.reorthogonalization, prm.basis_size+1, "fgmres"),
+        dense_ops_(std::move(dense_ops)),
+        residual_reg_(std::move(residual_reg))
+    {
+        orth_coeffs_.resize(prm.basis_size+1);
+        dense_ops_->init(prm.basis_size+1, prm.basis_size);
+        init_host();
+        init_all();
+        vec_ops_->start_use_vector(y_);
+        orth_.init_tolerance(*vec_ops_, y_);
+        vec_ops_->stop_use_vector(y_);
+    }
+    fgmres(
+        std::shared_ptr<const linear_operator_type> A,
+        std::shared_ptr<vector_operations_type> vec_ops,
+        Log *log = nullptr,
+        const params& prm = params(),
+        std::shared_ptr<preconditioner_type> prec = nullptr,
+        std::shared_ptr<residual_regulaization_t> residual_reg = std::make_shared<residual_regulaization_t>(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        fgmres(std::move(vec_ops),log,prm,std::move(prec),std::move(residual_reg),std::move(dense_ops))
+    {
+        parent_t::set_operator(std::move(A));
+    }
+
+    fgmres(
+        const utils_hierarchy& utils,
+        const params_hierarchy& prm = params_hierarchy()
+    ) :
+        fgmres(
+            utils.vec_ops, utils.log, prm,
+            nmfd::detail::algo_hierarchy_creator<preconditioner_type>::get(utils.preconditioner,prm.preconditioner),
+            utils.residual_reg, utils.dense_ops
+        )
+    {
+    }
+
+    const std::shared_ptr<preconditioner_type> &preconditioner()const
+    {
+        return prec_;
+    }
+
+    virtual bool solve(const linear_operator_type &A, const T_vec &b, T_vec &x)const
+    {
+        start_use_all();
+        monitor_call_wrap_t monitor_wrap(monitor_);
+        monitor_wrap.start(b);
+
+        calc_residual(A, x, b, r_);
+        bool converged_by_checked_ritz_norm = false;
+        std::size_t total_iterations = 0;
+
+        if( !monitor_.check_finished(x, r_) )
+        {
+            do
+            {
+                T beta = vec_ops_->norm(r_);
+                vec_ops_->scale(static_cast<T>(1)/beta, r_);
+                vec_ops_->assign(r_, V_, m_+1, 0);
+                lsq_.reset(beta);
+
+                int i = -1;
+                do
+                {
+                    ++i;
+                    ++monitor_;
+                    //Z(i) = M^{-1}V(i), r_ = A*Z(i)
+                    vec_ops_->assign(V_, m_+1, i, y_);
+                    if(prec_ != nullptr)
+                    {
+                        prec_->apply(y_);
+                    }
+                    vec_ops_->assign(y_, Z_, m_, i);
+                    A.apply(y_, r_);
+                    residual_reg_->apply(r_);
+
+                    T h_ip = orthogonalize(i);
+                    H_(i+1, i) = h_ip;
+                    vec_ops_->scale(static_cast<T>(1)/h_ip, r_);
+                    vec_ops_->assign(r_, V_, m_+1, i+1);
+
+                    T resid_estimate = lsq_.add_column(H_, i, i+2);
+                    total_iterations++;
+                    if((total_iterations%prms_.batch_size == 0)||(i+1 == m_))
+                    {
+                        logged_obj_t::info_f("iter = %i(%i), resid_estimate = %e", static_cast<int>(total_iterations), i+1, monitor_.norm_out(resid_estimate) );
+                    }
+
+                    if ( monitor_.check_finished_by_ritz_estimate(resid_estimate) )
+                    {
+                        vec_ops_->assign(x, x_tmp_);
+                        update_solution(A, i, b, x);
+                        if (monitor_.check_finished(x, r_))
+                        {
+                            converged_by_checked_ritz_norm = true;
+                            break;
+                        }
+                        else
+                        {
+                            vec_ops_->assign(x_tmp_, x);
+                        }
+                    }
+                }
+                while( i + 1 < m_ );
+
+                if(!converged_by_checked_ritz_norm)
+                {
+                    update_solution(A, i, b, x);
+                }
+            }
+            while(!converged_by_checked_ritz_norm && !monitor_.check_finished(x, r_) );
+        }
+
+        bool res = monitor_.converged();
+        if(!res)
+            logged_obj_t::error_f("solve: linear solver failed to converge");
+
+        stop_use_all();
+
+        return res;
+    }
+
+    bool solve(const vector_type &b, vector_type &x)const
+    {
+        return solve(*parent_t::A_, b, x);
+    }
+};
+
+}
+}
+
+#endif //__NMFD_FGMRES_H__
@@ -0,0 +1,774 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_GCRO_DR_H__
+#define __NMFD_GCRO_DR_H__
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <limits>
+#ifdef NMFD_ENABLE_NLOHMANN
+#include <nlohmann/json.hpp>
+#endif
+#include "detail/monitor_call_wrap.h"
+#include <nmfd/detail/algo_utils_hierarchy.h>
+#include <nmfd/detail/algo_params_hierarchy.h>
+#include <nmfd/detail/algo_hierarchy_creator.h>
+#include "iter_solver_base.h"
+#include "detail/dense_operations.h"
+#include "detail/gram_schmidt.h"
+#include "detail/givens_least_squares.h"
+#include "detail/krylov_hierarchy.h"
+#include "detail/preconditioned_operator.h"
+#include "detail/residual_regularization_dummy.h"
+#include <nmfd/preconditioners/dummy.h>
+
+namespace nmfd
+{
+namespace solvers
+{
+
+/**
+ * GCRO-DR: restarted GMRES with deflated restarting and krylov subspace recycling (M.L. Parks et al.).
+ * Recycle space U of recycle_size approximate eigenvectors (harmonic Ritz vectors corresponding to the smallest
+ * harmonic Ritz values) together with C = K*U (K is preconditioned operator, C is orthonormal) is kept not only
+ * between restarts but also between solve calls, so sequence of systems with slowly changing operators
+ * (like consecutive Newton steps) do not have to rebuild it from scratch.
+ * Each cycle minimizes residual over span(U) + krylov space of (I - C*C^T)*K with basis_size-recycle_size vectors.
+ * When operator changes update_recycle_space(A) must be called (newton_iteration does it automatically),
+ * then C = K*U is recalculated at the beginning of next solve at the cost of recycle_size operator applications;
+ * recycle space is also recalculated if solve is called for another operator object.
+ * Keeps 4*(recycle_size+1) vectors for recycle space (U, C and update buffers) in addition to krylov basis.
+ * Template parameters demands are the same as for gmres.
+ **/
+
+template
+<
+     class VectorOperations, class Monitor, class Log,
+     class LinearOperator, class Preconditioner = preconditioners::dummy<VectorOperations,LinearOperator>,
+     class ResidualRegulariation = detail::residual_regularization_dummy,
+     class DenseOperations = detail::dense_operations<typename VectorOperations::Ord, typename VectorOperations::scalar_type>
+>
+class gcro_dr : public iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, Preconditioner>
+{
+    using parent_t = iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, Preconditioner>;
+    using logged_obj_t = typename parent_t::logged_obj_t;
+    using logged_obj_params_t = typename parent_t::logged_obj_params_t;
+
+public:
+    using scalar_type =  typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using linear_operator_type =  LinearOperator;
+    using preconditioner_type = Preconditioner;
+    using vector_operations_type = VectorOperations;
+    using dense_operations_t = DenseOperations;
+    using monitor_type = Monitor;
+    using log_type = Log;
+    using residual_regulaization_t = ResidualRegulariation;
+
+
+    struct params : public logged_obj_params_t
+    {
+        unsigned basis_size; //size of the krylov basis
+        unsigned recycle_size; //dimension of recycle space, must not exceed basis_size-2
+        unsigned batch_size; //residual estimate is logged each batch_size iterations
+        char preconditioner_side; //can be L for left and R for right
+        std::string orthogonalization; //mgs, cgs or cgs2
+        bool reorthogonalization; //iterative correction of projections in mgs (see detail/gram_schmidt.h)
+        typename Monitor::params monitor;
+
+        params(const std::string &log_prefix = "", const std::string &log_name = "gcro_dr::") :
+            logged_obj_params_t(0, log_prefix+log_name),
+            basis_size(20),
+            recycle_size(5),
+            batch_size(5),
+            preconditioner_side('R'),
+            orthogonalization("cgs2"),
+            reorthogonalization(false),
+            monitor( typename Monitor::params(this->log_msg_prefix) )
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            basis_size = j.value("basis_size", basis_size);
+            recycle_size = j.value("recycle_size", recycle_size);
+            batch_size = j.value("batch_size", batch_size);
+            preconditioner_side = j.value("preconditioner_side", preconditioner_side);
+            orthogonalization = j.value("orthogonalization", orthogonalization);
+            reorthogonalization = j.value("reorthogonalization", reorthogonalization);
+            monitor.from_json(j.at("monitor"));
+        }
+        nlohmann::json to_json() const
+        {
+            return
+                nlohmann::json
+                {
+                    {"type", "gcro_dr"},
+                    {"basis_size", basis_size},
+                    {"recycle_size", recycle_size},
+                    {"batch_size", batch_size},
+                    {"preconditioner_side", preconditioner_side},
+                    {"orthogonalization", orthogonalization},
+                    {"reorthogonalization", reorthogonalization},
+                    {"monitor", monitor.to_json()}
+                };
+        }
+        #endif
+    };
+    using utils = detail::krylov_utils<vector_operations_type, Log, residual_regulaization_t, dense_operations_t>;
+    using params_hierarchy = detail::krylov_params_hierarchy<params, Preconditioner>;
+    using utils_hierarchy = detail::krylov_utils_hierarchy<utils, Preconditioner>;
+
+private:
+    using T = scalar_type;
+    using T_vec = vector_type;
+    using T_mvec = multivector_type;
+
+    using D_vec = typename dense_operations_t::vector_type;
+    using D_mat = typename dense_operations_t::matrix_type;
+
+    using monitor_call_wrap_t = detail::monitor_call_wrap<VectorOperations, Monitor>;
+
+    //V_ is krylov basis, U_ and C_ are recycle space with K*U(i) = C(i)*u_scale_[i], C is orthonormal, U has unit columns;
+    //U_new_ and C_new_ are buffers for recycle space update
+    mutable T_mvec V_;
+    mutable T_mvec U_, C_;
+    mutable T_mvec U_new_, C_new_;
+    mutable T_vec r_;
+    mutable T_vec y_;
+    mutable T_vec w_;
+    mutable T_vec x_tmp_;
+
+    //parameters:
+    params prms_;
+    int m_;
+    int k_;
+    detail::gram_schmidt<VectorOperations> orth_;
+
+    //current recycle space state
+    mutable int k_u_;
+    mutable bool recycle_outdated_;
+    mutable const linear_operator_type *recycle_op_;
+
+    //host dense operations vectors and matrices:
+    //G_ is matrix of relation K*[U V(0:nd)] = [C V(0:nd+1)]*G, where nd is number of arnoldi steps in cycle,
+    //c_ is residual in [C V] basis, d_ is least squares solution; others are used for recycle space update
+    mutable D_mat G_, work_mat_, A_h_, WtV_, M_, P_, Q_;
+    mutable D_vec c_, d_, col_, wr_, wi_, gr_, gi_;
+    //QR factorization of G_ by Givens rotations
+    mutable detail::givens_least_squares<dense_operations_t> lsq_;
+    //host buffers for batched Gram-Schmidt and linear combinations coefficients
+    mutable std::vector<T> orth_coeffs_, orth_corr_, coeffs_v_, u_scale_, u_scale_new_;
+
+
+    void calc_left_preconditioned_residual(const linear_operator_type &A, const T_vec &x, const T_vec &b, T_vec &r)const
+    {
+        detail::calc_left_preconditioned_residual(*vec_ops_, A, prec_.get(), prms_.preconditioner_side, x, b, r);
+    }
+
+    void calc_right_precond_solution(T_vec &x) const
+    {
+        detail::apply_right_preconditioner(prec_.get(), prms_.preconditioner_side, x);
+    }
+
+    void init_host()
+    {
+        dense_ops_->init_matrices(G_, work_mat_, A_h_, WtV_, M_, P_, Q_);
+        dense_ops_->init_col_vectors(c_, d_, col_, wr_, wi_, gr_, gi_);
+        lsq_.init(dense_ops_);
+    }
+
+    void free_host_()
+    {
+        dense_ops_->free_matrices(G_, work_mat_, A_h_, WtV_, M_, P_, Q_);
+        dense_ops_->free_col_vectors(c_, d_, col_, wr_, wi_, gr_, gi_);
+        lsq_.free();
+    }
+
+    void init_all() const
+    {
+        vec_ops_->init_vector( r_ );
+        vec_ops_->init_vector( y_ );
+        vec_ops_->init_vector( w_ );
+        vec_ops_->init_vector( x_tmp_ );
+        vec_ops_->init_multivector( V_, m_+1 );
+        vec_ops_->init_multivector( U_, k_+1 );
+        vec_ops_->init_multivector( C_, k_+1 );
+        vec_ops_->init_multivector( U_new_, k_+1 );
+        vec_ops_->init_multivector( C_new_, k_+1 );
+    }
+    void start_use_all() const
+    {
+        vec_ops_->start_use_vector( r_ );
+        vec_ops_->start_use_vector( y_ );
+        vec_ops_->start_use_vector( w_ );
+        vec_ops_->start_use_vector( x_tmp_ );
+        vec_ops_->start_use_multivector( V_, m_+1 );
+        //recycle space contents survive between solve calls, only its use is limited to solve
+        vec_ops_->start_use_multivector( U_, k_+1 );
+        vec_ops_->start_use_multivector( C_, k_+1 );
+        vec_ops_->start_use_multivector( U_new_, k_+1 );
+        vec_ops_->start_use_multivector( C_new_, k_+1 );
+    }
+    void stop_use_all() const
+    {
+        vec_ops_->stop_use_vector( r_ );
+        vec_ops_->stop_use_vector( y_ );
+        vec_ops_->stop_use_vector( w_ );
+        vec_ops_->stop_use_vector( x_tmp_ );
+        vec_ops_->stop_use_multivector( V_, m_+1 );
+        vec_ops_->stop_use_multivector( U_, k_+1 );
+        vec_ops_->stop_use_multivector( C_, k_+1 );
+        vec_ops_->stop_use_multivector( U_new_, k_+1 );
+        vec_ops_->stop_use_multivector( C_new_, k_+1 );
+    }
+    void free_all() const
+    {
+        vec_ops_->free_vector( r_ );
+        vec_ops_->free_vector( y_ );
+        vec_ops_->free_vector( w_ );
+        vec_ops_->free_vector( x_tmp_ );
+        vec_ops_->free_multivector( V_, m_+1 );
+        vec_ops_->free_multivector( U_, k_+1 );
+        vec_ops_->free_multivector( C_, k_+1 );
+        vec_ops_->free_multivector( U_new_, k_+1 );
+        vec_ops_->free_multivector( C_new_, k_+1 );
+    }
+
+    /// orthogonalizes r_ against C(0:k_u) and V(0:j+1), writes coefficients into G(0:k_u+j+1,k_u+j)
+    /// and returns norm of orthogonalized r_
+    T orthogonalize(const int j) const
+    {
+        orth_.project(*vec_ops_, C_, k_+1, k_u_, r_, orth_coeffs_.data());
+        for(int i = 0; i < k_u_; i++)
+        {
+            G_(i, k_u_+j) = orth_coeffs_[i];
+        }
+        T h_ip = orth_.orthogonalize(*vec_ops_, V_, m_+1, j+1, r_, orth_coeffs_.data());
+        if(orth_.correction_failed())
+        {
+            logged_obj_t::warning_f("failed in Gram-Schmidt reorthogonalization in iteration %i", j);
+        }
+        for(int l = 0; l <= j; l++)
+        {
+            G_(k_u_+l, k_u_+j) = orth_coeffs_[l];
+        }
+        return h_ip;
+    }
+
+    /// y := mx1(0:n1)*coeffs1 + mx2(0:n2)*coeffs2
+    void combine(const T_mvec &mx1, const int mx1_sz, const int n1, const T *coeffs1, const T_mvec &mx2, const int mx2_sz, const int n2, const T *coeffs2, T_vec &y) const
+    {
+        vec_ops_->assign_scalar(static_cast<T>(0), y);
+        if(n1 > 0)
+        {
+            vec_ops_->multi_add_lin_comb(coeffs1, mx1, mx1_sz, 0, n1, static_cast<T>(1), y);
+        }
+        if(n2 > 0)
+        {
+            vec_ops_->multi_add_lin_comb(coeffs2, mx2, mx2_sz, 0, n2, static_cast<T>(1), y);
+        }
+    }
+
+    /// x := x + [U V(0:n-k_u)]*d(0:n), r_ gets new residual
+    void update_solution(const linear_operator_type &A, const int n, const T_vec &b, T_vec &x) const
+    {
+        lsq_.solve(d_);
+        for(int i = 0; i < k_u_; i++)
+        {
+            orth_coeffs_[i] = d_(i);
+        }
+        for(int l = 0; l < n-k_u_; l++)
+        {
+            coeffs_v_[l] = d_(k_u_+l);
+        }
+        combine(U_, k_+1, k_u_, orth_coeffs_.data(), V_, m_+1, n-k_u_, coeffs_v_.data(), y_);
+        calc_right_precond_solution(y_);
+        residual_reg_->apply(y_);
+        vec_ops_->add_lin_comb(static_cast<T>(1), y_, static_cast<T>(1), x);
+        calc_left_preconditioned_residual(A, x, b, r_);
+        residual_reg_->apply(r_);
+    }
+
+    /// C := K*U for the current operator, C is orthonormalized and U is transformed accordingly
+    void recalc_recycle_space(const linear_operator_type &A) const
+    {
+        for(int i = 0; i < k_u_; i++)
+        {
+            vec_ops_->assign(U_, k_+1, i, y_);
+            detail::calc_krylov_vector(A, prec_.get(), prms_.preconditioner_side, residual_reg_.get(), y_, w_);
+            vec_ops_->assign(w_, C_, k_+1, i);
+        }
+        //QR of C by Gram-Schmidt with reorthogonalization, same transformations applied to U preserve K*U = C
+        for(int i = 0; i < k_u_; i++)
+        {
+            vec_ops_->assign(C_, k_+1, i, w_);
+            vec_ops_->assign(U_, k_+1, i, y_);
+            T norm0 = vec_ops_->norm(w_);
+            for(int pass = 0; pass < 2; pass++)
+            {
+                for(int l = 0; l < i; l++)
+                {
+                    T alpha = vec_ops_->scalar_prod(C_, k_+1, l, w_);
+                    vec_ops_->add_lin_comb(-alpha, C_, k_+1, l, static_cast<T>(1), w_);
+                    vec_ops_->add_lin_comb(-alpha, U_, k_+1, l, static_cast<T>(1), y_);
+                }
+            }
+            T rho = vec_ops_->norm(w_);
+            if(!(rho > std::sqrt(std::numeric_limits<T>::epsilon())*norm0))
+            {
+                logged_obj_t::warning_f("recycle space became degenerate for the new operator and is dropped");
+                k_u_ = 0;
+                return;
+            }
+            vec_ops_->scale(static_cast<T>(1)/rho, w_);
+            vec_ops_->scale(static_cast<T>(1)/rho, y_);
+            vec_ops_->assign(w_, C_, k_+1, i);
+            vec_ops_->assign(y_, U_, k_+1, i);
+        }
+        for(int i = 0; i < k_u_; i++)
+        {
+            vec_ops_->assign(U_, k_+1, i, y_);
+            u_scale_[i] = static_cast<T>(1)/vec_ops_->norm(y_);
+            vec_ops_->scale(u_scale_[i], y_);
+            vec_ops_->assign(y_, U_, k_+1, i);
+        }
+        recycle_outdated_ = false;
+        recycle_op_ = &A;
+    }
+
+    /// r_ := (I - C*C^T)*r_ and x is corrected accordingly
+    void project_residual(T_vec &x) const
+    {
+        vec_ops_->multi_scalar_prod(C_, k_+1, 0, k_u_, r_, orth_coeffs_.data());
+        for(int i = 0; i < k_u_; i++)
+        {
+            orth_corr_[i] = -orth_coeffs_[i];
+            orth_coeffs_[i] /= u_scale_[i];
+        }
+        vec_ops_->multi_add_lin_comb(orth_corr_.data(), C_, k_+1, 0, k_u_, static_cast<T>(1), r_);
+        vec_ops_->assign_scalar(static_cast<T>(0), y_);
+        vec_ops_->multi_add_lin_comb(orth_coeffs_.data(), U_, k_+1, 0, k_u_, static_cast<T>(1), y_);
+        calc_right_precond_solution(y_);
+        residual_reg_->apply(y_);
+        vec_ops_->add_lin_comb(static_cast<T>(1), y_, static_cast<T>(1), x);
+    }
+
+    /// orthonormalizes column col of Q_ (rows 0:rows) against columns 0:col, coefficients are written into R(0:col+1,col);
+    /// returns false if column is lost
+    bool orthonormalize_column(D_mat &Q, D_mat &R, const int rows, const int col) const
+    {
+        T norm0 = 0;
+        for(int r = 0; r < rows; r++) norm0 += Q(r, col)*Q(r, col);
+        norm0 = std::sqrt(norm0);
+        for(int l = 0; l < col; l++) R(l, col) = static_cast<T>(0);
+        for(int pass = 0; pass < 2; pass++)
+        {
+            for(int l = 0; l < col; l++)
+            {
+                T alpha = 0;
+                for(int r = 0; r < rows; r++) alpha += Q(r, l)*Q(r, col);
+                for(int r = 0; r < rows; r++) Q(r, col) -= alpha*Q(r, l);
+                R(l, col) += alpha;
+            }
+        }
+        T norm = 0;
+        for(int r = 0; r < rows; r++) norm += Q(r, col)*Q(r, col);
+        norm = std::sqrt(norm);
+        if(!(norm > std::sqrt(std::numeric_limits<T>::epsilon())*norm0))
+        {
+            return false;
+        }
+        for(int r = 0; r < rows; r++) Q(r, col) /= norm;
+        R(col, col) = norm;
+        return true;
+    }
+
+    /// new recycle space from harmonic Ritz vectors of K with respect to span[U V(0:nd)] after cycle with nd arnoldi steps.
+    /// Harmonic Ritz pairs solve G^T*G*z = theta*G^T*[C V(0:nd+1)]^T*[U V(0:nd)]*z, they are found as
+    /// eigenpairs of M = (G^T*G)^{-1}*G^T*[C V]^T*[U V] with the largest |mu| = 1/|theta|.
+    /// returns false if update failed.
+    bool update_recycle_space_from_cycle(const int nd) const
+    {
+        const int n = k_u_+nd;
+        for(int i = 0; i < n; i++)
+        {
+            for(int j = 0; j < n; j++)
+            {
+                T val = 0;
+                for(int r = 0; r <= n; r++) val += G_(r, i)*G_(r, j);
+                A_h_(i, j) = val;
+            }
+        }
+        dense_ops_->assign_scalar_matrix(0, WtV_);
+        for(int l = 0; l < k_u_; l++)
+        {
+            vec_ops_->assign(U_, k_+1, l, y_);
+            vec_ops_->multi_scalar_prod(C_, k_+1, 0, k_u_, y_, orth_coeffs_.data());
+            vec_ops_->multi_scalar_prod(V_, m_+1, 0, nd+1, y_, coeffs_v_.data());
+            for(int i = 0; i < k_u_; i++) WtV_(i, l) = orth_coeffs_[i];
+            for(int r = 0; r <= nd; r++) WtV_(k_u_+r, l) = coeffs_v_[r];
+        }
+        for(int l = 0; l < nd; l++)
+        {
+            WtV_(k_u_+l, k_u_+l) = static_cast<T>(1);
+        }
+        for(int j = 0; j < n; j++)
+        {
+            for(int i = 0; i < n; i++)
+            {
+                T val = 0;
+                for(int r = 0; r <= n; r++) val += G_(r, i)*WtV_(r, j);
+                col_(i) = val;
+            }
+            if(!dense_ops_->solve_linear_system(A_h_, n, work_mat_, col_))
+            {
+                return false;
+            }
+            for(int i = 0; i < n; i++) M_(i, j) = col_(i);
+        }
+        dense_ops_->assign_matrix(M_, work_mat_);
+        dense_ops_->reduce_to_hessenberg(work_mat_, n);
+        if(!dense_ops_->hessenberg_eigenvalues(work_mat_, n, P_, wr_, wi_))
+        {
+            return false;
+        }
+        std::vector<int> ind(n);
+        for(int j = 0; j < n; j++) ind[j] = j;
+        std::stable_sort(ind.begin(), ind.end(), [this](int a, int b)
+        {
+            return std::hypot(wr_(a), wi_(a)) > std::hypot(wr_(b), wi_(b));
+        });
+        //complex conjugate pair is represented by real and imaginary parts of the eigenvector, so kk may be k_+1
+        int kk = 0;
+        const int kk_max = std::min(k_+1, n);
+        dense_ops_->assign_scalar_matrix(0, P_);
+        for(int l = 0; (l < n)&&(kk < std::min(k_, n)); l++)
+        {
+            int j = ind[l];
+            if(wi_(j) < static_cast<T>(0)) continue;
+            int need = (wi_(j) > static_cast<T>(0) ? 2 : 1);
+            if(kk+need > kk_max) break;
+            dense_ops_->eigenvector_inverse_iteration(M_, n, wr_(j), wi_(j), gr_, gi_);
+            for(int r = 0; r < n; r++) P_(r, kk) = gr_(r);
+            if(need == 2)
+            {
+                for(int r = 0; r < n; r++) P_(r, kk+1) = gi_(r);
+            }
+            kk += need;
+        }
+        if(kk == 0)
+        {
+            return false;
+        }
+        //G*P = Q*R, R is stored in A_h_
+        for(int l = 0; l < kk; l++)
+        {
+            for(int r = 0; r <= n; r++)
+            {
+                T val = 0;
+                for(int i = 0; i < n; i++) val += G_(r, i)*P_(i, l);
+                Q_(r, l) = val;
+            }
+        }
+        for(int l = 0; l < kk; l++)
+        {
+            if(!orthonormalize_column(Q_, A_h_, n+1, l))
+            {
+                return false;
+            }
+        }
+        //P := P*R^{-1}, so that K*[U V]*P = [C V]*Q
+        for(int l = 0; l < kk; l++)
+        {
+            for(int r = 0; r < n; r++)
+            {
+                T val = P_(r, l);
+                for(int i = 0; i < l; i++) val -= P_(r, i)*A_h_(i, l);
+                P_(r, l) = val/A_h_(l, l);
+            }
+        }
+        for(int l = 0; l < kk; l++)
+        {
+            for(int i = 0; i < k_u_; i++) orth_coeffs_[i] = Q_(i, l);
+            for(int r = 0; r <= nd; r++) coeffs_v_[r] = Q_(k_u_+r, l);
+            combine(C_, k_+1, k_u_, orth_coeffs_.data(), V_, m_+1, nd+1, coeffs_v_.data(), y_);
+            vec_ops_->assign(y_, C_new_, k_+1, l);
+            for(int i = 0; i < k_u_; i++) orth_coeffs_[i] = P_(i, l);
+            for(int r = 0; r < nd; r++) coeffs_v_[r] = P_(k_u_+r, l);
+            combine(U_, k_+1, k_u_, orth_coeffs_.data(), V_, m_+1, nd, coeffs_v_.data(), y_);
+            u_scale_new_[l] = static_cast<T>(1)/vec_ops_->norm(y_);
+            vec_ops_->scale(u_scale_new_[l], y_);
+            vec_ops_->assign(y_, U_new_, k_+1, l);
+        }
+        for(int l = 0; l < kk; l++)
+        {
+            vec_ops_->assign(C_new_, k_+1, l, y_);
+            vec_ops_->assign(y_, C_, k_+1, l);
+            vec_ops_->assign(U_new_, k_+1, l, y_);
+            vec_ops_->assign(y_, U_, k_+1, l);
+            u_scale_[l] = u_scale_new_[l];
+        }
+        k_u_ = kk;
+        return true;
+    }
+
+protected:
+    using parent_t::monitor_;
+    using parent_t::vec_ops_;
+    using parent_t::prec_;
+    std::shared_ptr<dense_operations_t> dense_ops_;
+    std::shared_ptr<residual_regulaization_t> residual_reg_;
+
+public:
+    ~gcro_dr()
+    {
+        free_host_();
+        free_all();
+    }
+
+    gcro_dr(
+        std::shared_ptr<vector_operations_type> vec_ops,
+        Log *log = nullptr,
+        const params& prm = params(),
+        std::shared_ptr<preconditioner_type> prec = nullptr,
+        std::shared_ptr<residual_regulaization_t> residual_reg = std::make_shared<residual_regulaization_t>(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        parent_t(std::move(vec_ops), log, prm, prm.monitor, std::move(prec) ),
+        prms_(prm),
+        m_(prm.basis_size),
+        k_(prm.recycle_size),
+        orth_(prm.orthogonalization, prm.reorthogonalization, prm.basis_size+1, "gcro_dr"),
+        k_u_(0),
+        recycle_outdated_(false),
+        recycle_op_(nullptr),
+        dense_ops_(std::move(dense_ops)),
+        residual_reg_(std::move(residual_reg))
+    {
+        if(prm.recycle_size+2 > prm.basis_size)
+        {
+            throw std::logic_error("gcro_dr: recycle_size must not exceed basis_size-2");
+        }
+        orth_coeffs_.resize(prm.basis_size+1);
+        orth_corr_.resize(prm.basis_size+1);
+        coeffs_v_.resize(prm.basis_size+1);
+        u_scale_.resize(prm.recycle_size+1);
+        u_scale_new_.resize(prm.recycle_size+1);
+        dense_ops_->init(prm.basis_size+1, prm.basis_size);
+        init_host();
+        init_all();
+        vec_ops_->start_use_vector(y_);
+        orth_.init_tolerance(*vec_ops_, y_);
+        vec_ops_->stop_use_vector(y_);
+    }
+    gcro_dr(
+        std::shared_ptr<const linear_operator_type> A,
+        std::shared_ptr<vector_operations_type> vec_ops,
+        Log *log = nullptr,
+        const params& prm = params(),
+        std::shared_ptr<preconditioner_type> prec = nullptr,
+        std::shared_ptr<residual_regulaization_t> residual_reg = std::make_shared<residual_regulaization_t>(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        gcro_dr(std::move(vec_ops),log,prm,std::move(prec),std::move(residual_reg),std::move(dense_ops))
+    {
+        parent_t::set_operator(std::move(A));
+    }
+
+    gcro_dr(
+        const utils_hierarchy& utils,
+        const params_hierarchy& prm = params_hierarchy()
+    ) :
+        gcro_dr(
+            utils.vec_ops, utils.log, prm,
+            nmfd::detail::algo_hierarchy_creator<preconditioner_type>::get(utils.preconditioner,prm.preconditioner),
+            utils.residual_reg, utils.dense_ops
+        )
+    {
+    }
+
+    const std::shared_ptr<preconditioner_type> &preconditioner()const
+    {
+        return prec_;
+    }
+
+    /// operator (or preconditioner) has changed: C = K*U will be recalculated in the next solve
+    void update_recycle_space(const linear_operator_type &)
+    {
+        recycle_outdated_ = true;
+    }
+    void reset_recycle_space()
+    {
+        k_u_ = 0;
+    }
+    int recycle_space_size()const
+    {
+        return k_u_;
+    }
+
+    virtual bool solve(const linear_operator_type &A, const T_vec &b, T_vec &x)const
+    {
+        start_use_all();
+        monitor_call_wrap_t monitor_wrap(monitor_);
+
+        if ((prec_ != nullptr)&&(prms_.preconditioner_side == 'L'))
+        {
+            vec_ops_->assign(b, r_);
+            prec_->apply(r_);
+            residual_reg_->apply(r_);
+            monitor_wrap.start(r_);
+        }
+        else
+        {
+            monitor_wrap.start(b);
+        }
+
+        calc_left_preconditioned_residual(A, x, b, r_);
+        residual_reg_->apply(r_);
+        bool converged_by_checked_ritz_norm = false;
+        std::size_t total_iterations = 0;
+
+        if( !monitor_.check_finished(x, r_) )
+        {
+            if( (k_u_ > 0)&&(recycle_outdated_ || (recycle_op_ != &A)) )
+            {
+                recalc_recycle_space(A);
+            }
+            do
+            {
+                if(k_u_ > 0)
+                {
+                    project_residual(x);
+                }
+                T beta = vec_ops_->norm(r_);
+                if(beta == static_cast<T>(0))
+                {
+                    //solution is found in recycle space, loop condition checks true residual;
+                    //projection is counted as iteration, so the loop can not spin without limit
+                    ++monitor_;
+                    calc_left_preconditioned_residual(A, x, b, r_);
+                    residual_reg_->apply(r_);
+                    continue;
+                }
+                dense_ops_->assign_scalar_matrix(0, G_);
+                for(int i = 0; i < k_u_; i++)
+                {
+                    G_(i, i) = u_scale_[i];
+                }
+                vec_ops_->scale(static_cast<T>(1)/beta, r_);
+                vec_ops_->assign(r_, V_, m_+1, 0);
+                dense_ops_->assign_scalar_col_vector(0, c_);
+                c_(k_u_) = beta;
+                lsq_.reset(c_, k_u_+1);
+                for(int i = 0; i < k_u_; i++)
+                {
+                    lsq_.add_column(G_, i, i+1);
+                }
+
+                const int nd_max = m_-k_u_;
+                int j = -1;
+                bool breakdown = false;
+                do
+                {
+                    ++j;
+                    ++monitor_;
+                    vec_ops_->assign(V_, m_+1, j, y_);
+                    detail::calc_krylov_vector(A, prec_.get(), prms_.preconditioner_side, residual_reg_.get(), y_, r_);
+                    T h_ip = orthogonalize(j);
+                    if(!(h_ip > static_cast<T>(0)))
+                    {
+                        //happy breakdown: krylov space is invariant, least squares solution is exact
+                        breakdown = true;
+                        h_ip = static_cast<T>(0);
+                        vec_ops_->assign_scalar(static_cast<T>(0), r_);
+                    }
+                    else
+                    {
+                        vec_ops_->scale(static_cast<T>(1)/h_ip, r_);
+                    }
+                    G_(k_u_+j+1, k_u_+j) = h_ip;
+                    vec_ops_->assign(r_, V_, m_+1, j+1);
+
+                    T resid_estimate = lsq_.add_column(G_, k_u_+j, k_u_+j+2);
+                    total_iterations++;
+                    if((total_iterations%prms_.batch_size == 0)||(j+1 == nd_max))
+                    {
+                        logged_obj_t::info_f("iter = %i(%i), resid_estimate = %e", static_cast<int>(total_iterations), j+1, monitor_.norm_out(resid_estimate) );
+                    }
+
+                    if ( monitor_.check_finished_by_ritz_estimate(resid_estimate) )
+                    {
+                        vec_ops_->assign(x, x_tmp_);
+                        update_solution(A, k_u_+j+1, b, x);
+                        if (monitor_.check_finished(x, r_))
+                        {
+                            converged_by_checked_ritz_norm = true;
+                            break;
+                        }
+                        else
+                        {
+                            vec_ops_->assign(x_tmp_, x);
+                        }
+                    }
+                }
+                while( !breakdown && (j + 1 < nd_max) );
+
+                if(!converged_by_checked_ritz_norm)
+                {
+                    update_solution(A, k_u_+j+1, b, x);
+                }
+                if(k_ > 0)
+                {
+                    if(!update_recycle_space_from_cycle(j+1))
+                    {
+                        logged_obj_t::warning_f("recycle space update failed, recycle space is dropped");
+                        k_u_ = 0;
+                    }
+                    else
+                    {
+                        recycle_op_ = &A;
+                        recycle_outdated_ = false;
+                    }
+                }
+            }
+            while(!converged_by_checked_ritz_norm && !monitor_.check_finished(x, r_) );
+        }
+
+        bool res = monitor_.converged();
+        if(!res)
+            logged_obj_t::error_f("solve: linear solver failed to converge");
+
+        stop_use_all();
+
+        return res;
+    }
+
+    bool solve(const vector_type &b, vector_type &x)const
+    {
+        return solve(*parent_t::A_, b, x);
+    }
+};
+
+}
+}
+
+#endif //__NMFD_GCRO_DR_H__
@@ -17,6 +17,8 @@
 #ifndef __NMFD_GMRES_H__
 #define __NMFD_GMRES_H__
 
+#include <string>
+#include <vector>
 #include <stdexcept>
 #include <cmath>
 #include <limits>
@@ -29,6 +31,11 @@
 #include <nmfd/detail/algo_hierarchy_creator.h>
 #include "iter_solver_base.h"
 #include "detail/dense_operations.h"
+#include "detail/fused_vector_ops.h"
+#include "detail/gram_schmidt.h"
+#include "detail/givens_least_squares.h"
+#include "detail/krylov_hierarchy.h"
+#include "detail/preconditioned_operator.h"
 #include "detail/residual_regularization_dummy.h"
 #include <nmfd/preconditioners/dummy.h>
 
@@ -76,7 +83,8 @@ public:
         unsigned basis_size; //size of the krylov basis
         unsigned batch_size; //size of the batch size s.t. Ritz vector converhence is checked each batch_size inside the krylov bass size
         char preconditioner_side; //can be L for left and R for right
-        bool reorthogonalization; //apply additional reorthogonalization in Gram-Schmidt process
+        bool reorthogonalization; //apply additional reorthogonalization in Gram-Schmidt process (mgs only)
+        std::string orthogonalization; //mgs, cgs or cgs2; cgs and cgs2 use batched multivector reductions
         bool do_restart_on_false_ritz_convergence;
         typename Monitor::params monitor;
 
@@ -86,6 +94,7 @@ public:
             batch_size(5), 
             preconditioner_side('R'), 
             reorthogonalization(false), 
+            orthogonalization("mgs"),
             do_restart_on_false_ritz_convergence(false),
             monitor( typename Monitor::params(this->log_msg_prefix) )
         {
@@ -97,6 +106,7 @@ public:
             batch_size = j.value("batch_size", batch_size);
             preconditioner_side = j.value("preconditioner_side", preconditioner_side);
             reorthogonalization = j.value("reorthogonalization", reorthogonalization);
+            orthogonalization = j.value("orthogonalization", orthogonalization);
             do_restart_on_false_ritz_convergence = j.value("do_restart_on_false_ritz_convergence", do_restart_on_false_ritz_convergence);
             monitor.from_json(j.at("monitor"));
         }
@@ -110,76 +120,16 @@ public:
                     {"batch_size", batch_size},
                     {"preconditioner_side", preconditioner_side},
                     {"reorthogonalization", reorthogonalization},
+                    {"orthogonalization", orthogonalization},
                     {"do_restart_on_false_ritz_convergence", do_restart_on_false_ritz_convergence},
                     {"monitor", monitor.to_json()}
                 };
         }
         #endif
     };
-    struct utils
-    {
-        std::shared_ptr<vector_operations_type> vec_ops;
-        Log *log;
-        std::shared_ptr<residual_regulaization_t> residual_reg;
-        std::shared_ptr<dense_operations_t> dense_ops;
-        utils() = default;
-        utils(
-            std::shared_ptr<vector_operations_type> vec_ops_, Log *log_ = nullptr,
-            std::shared_ptr<residual_regulaization_t> residual_reg_ = std::make_shared<residual_regulaization_t>(),
-            std::shared_ptr<dense_operations_t> dense_ops_ = std::make_shared<dense_operations_t>()
-        ) : 
-            vec_ops(vec_ops_), log(log_), residual_reg(residual_reg_), dense_ops(dense_ops_) 
-        {
-        }
-    };
-    using preconditioner_params_hierarchy_type = typename nmfd::detail::algo_params_hierarchy<Preconditioner>::type;
-    struct params_hierarchy : public params
-    {
-        preconditioner_params_hierarchy_type preconditioner;
-
-        params_hierarchy(const std::string &log_prefix = "", const std::string &log_name = "gmres::") : 
-            params(log_prefix, log_name),
-            preconditioner(this->log_msg_prefix)
-        {
-        }
-        params_hierarchy(
-            const params &prm_, 
-            const preconditioner_params_hierarchy_type &preconditioner_
-        ) : params(prm_), preconditioner(preconditioner_)
-        {
-        }
-        #ifdef NMFD_ENABLE_NLOHMANN
-        void from_json(const nlohmann::json& j)
-        {
-            params::from_json(j);
-            preconditioner.from_json(j.at("preconditioner"));
-        }
-        nlohmann::json to_json() const
-        {
-            nlohmann::json  j = params::to_json(),
-                            j_prec = preconditioner.to_json();
-            j["preconditioner"] = j_prec;
-            return j;
-        }
-        #endif
-    };
-
-    using preconditioner_utils_hierarchy_type = typename nmfd::detail::algo_utils_hierarchy<Preconditioner>::type;
-    struct utils_hierarchy : public utils
-    {
-        preconditioner_utils_hierarchy_type preconditioner;
-
-        utils_hierarchy() = default;
-        template<class ...Args>
-        utils_hierarchy(
-            preconditioner_utils_hierarchy_type preconditioner_,
-            Args... args
-        ) : 
-            utils(args...),
-            preconditioner(preconditioner_)
-        {        
-        }
-    };
+    using utils = detail::krylov_utils<vector_operations_type, Log, residual_regulaization_t, dense_operations_t>;
+    using params_hierarchy = detail::krylov_params_hierarchy<params, Preconditioner>;
+    using utils_hierarchy = detail::krylov_utils_hierarchy<utils, Preconditioner>;
 
 private:
     using T = scalar_type;
@@ -191,9 +141,11 @@ private:
 
 
     using monitor_call_wrap_t = detail::monitor_call_wrap<VectorOperations, Monitor>;
+    //fused BLAS1 operations are used if VectorOperations provides them (see detail/fused_vector_ops.h)
+    using fused_scale_assign_t = detail::fused_scale_assign<VectorOperations>;
+    using gram_schmidt_t = detail::gram_schmidt<VectorOperations>;
 
 
-    T error_L2_basic_type_;
     mutable T_mvec V_;
     mutable T_vec r_;
     mutable T_vec y_;
@@ -201,70 +153,48 @@ private:
     
     //parameters:
     params prms_;
+    //orthogonalization type is parsed once on construction
+    gram_schmidt_t orth_;
 
     //host dense operations vectors and matrices
     mutable D_mat H_;
-    mutable D_vec s_;
-    mutable D_vec cs_;
-    mutable D_vec sn_;
     mutable D_vec s_h_;
     mutable D_vec rr;
+    //QR factorization of H_ by Givens rotations
+    mutable detail::givens_least_squares<dense_operations_t> lsq_;
+    //host buffer for Gram-Schmidt coefficients
+    mutable std::vector<T> orth_coeffs_;
 
 
     void calc_left_preconditioned_residual(const linear_operator_type &A, const T_vec &x, const T_vec &b, T_vec &r)const
     {
-        
-        A.apply(x, r);
-        vec_ops_->add_lin_comb(static_cast<T>(1.0), b, static_cast<T>(-1.0), r);
-        
-        if ((prec_ != nullptr)&&(prms_.preconditioner_side == 'L'))
-        {
-            prec_->apply(r);
-        }
+        detail::calc_left_preconditioned_residual(*vec_ops_, A, prec_.get(), prms_.preconditioner_side, x, b, r);
     }
 
     void calc_right_precond_solution(T_vec &x) const
     {
-        if ((prec_ != nullptr)&&(prms_.preconditioner_side == 'R'))
-        {
-            prec_->apply(x);
-        }
+        detail::apply_right_preconditioner(prec_.get(), prms_.preconditioner_side, x);
     }
 
-
-    void calc_krylov_vector(const linear_operator_type &A, const T_vec &x, T_vec &r)const
+    /// r := A*x with preconditioner applied; x is overwritten for right preconditioner
+    void calc_krylov_vector(const linear_operator_type &A, T_vec &x, T_vec &r)const
     {
-        if(prec_ == nullptr)
-        {
-            A.apply(x, r);
-        }
-        else
-        {
-            if(prms_.preconditioner_side == 'L') 
-            {
-                A.apply(x, r);
-                prec_->apply(r);
-            }
-            else if(prms_.preconditioner_side == 'R') 
-            {
-                vec_ops_->assign(x, y_);
-                prec_->apply(y_);
-                A.apply(y_, r);
-            }
-        }
+        detail::apply_preconditioned_operator(A, prec_.get(), prms_.preconditioner_side, x, r);
     }
 
 
     void init_host()
     {
         dense_ops_->init_matrix(H_);
-        dense_ops_->init_col_vectors(s_, cs_, sn_, s_h_, rr);
+        dense_ops_->init_col_vectors(s_h_, rr);
+        lsq_.init(dense_ops_);
     }
 
     void free_host_()
     {
         dense_ops_->free_matrix(H_);
-        dense_ops_->free_col_vectors(s_, cs_, sn_, s_h_, rr);
+        dense_ops_->free_col_vectors(s_h_, rr);
+        lsq_.free();
     }
 
     void init_all() const
@@ -275,11 +205,10 @@ private:
         vec_ops_->init_multivector( V_, prms_.basis_size+1);
     }
 
-    void init_error_L2_basic_type()
+    void init_orth_tolerance()
     {
         vec_ops_->start_use_vector(y_);
-        vec_ops_->assign_scalar(T(1), y_);
-        error_L2_basic_type_ = (std::numeric_limits<T>::epsilon() )*std::sqrt(vec_ops_->scalar_prod(y_,y_));
+        orth_.init_tolerance(*vec_ops_, y_);
         vec_ops_->stop_use_vector(y_);
     }
 
@@ -306,13 +235,25 @@ private:
         vec_ops_->free_multivector( V_, prms_.basis_size+1 );
     }
 
-    void zero_host_H() const
+    /// orthogonalizes r_ against V(0:i), writes coefficients into H(0:i,i) and returns norm of orthogonalized r_
+    T orthogonalize(const int i) const
     {
-        dense_ops_->assign_scalar_matrix(0, H_);
+        T h_ip = orth_.orthogonalize(*vec_ops_, V_, prms_.basis_size+1, i+1, r_, orth_coeffs_.data());
+        if(orth_.correction_failed())
+        {
+            //if we are here, then the method will probably diverge.
+            logged_obj_t::warning_f("failed in Gram-Schmidt reorthogonalization in iteration %i", i);
+        }
+        for(int k = 0; k <= i; k++)
+        {
+            dense_ops_->matrix_at(H_, k, i) = orth_coeffs_[k];
+        }
+        return h_ip;
     }
-    void zero_host_s() const
+
+    void zero_host_H() const
     {
-        dense_ops_->assign_scalar_col_vector(0, s_);
+        dense_ops_->assign_scalar_matrix(0, H_);
     }
 
 
@@ -359,13 +300,15 @@ public:
     ) : 
         parent_t(std::move(vec_ops), log, prm, prm.monitor, std::move(prec) ), 
         prms_(prm),
+        orth_(prm.orthogonalization, prm.reorthogonalization, prm.basis_size+1, "gmres"),
         residual_reg_(std::move(residual_reg)),
         dense_ops_(std::move(dense_ops))
     {
+        orth_coeffs_.resize(prm.basis_size+1);
         dense_ops_->init(prm.basis_size+1, prm.basis_size);
         init_host();
         init_all();
-        init_error_L2_basic_type();
+        init_orth_tolerance();
     }
     gmres(  
         std::shared_ptr<const linear_operator_type> A,
@@ -449,57 +392,19 @@ public:
             {
                 T beta = vec_ops_->norm(r_);
                 //T_vec V_0 = vec_ops_->at(V_, restart_+1, 0); //old version
-                vec_ops_->scale(1.0/beta, r_);
                 //vec_ops_->assign(r_, V_0); //old version
-                vec_ops_->assign(r_, V_, restart_+1, 0);
-                zero_host_s(); // s(:) = 0;
-                dense_ops_->vector_at(s_, 0) = beta;
+                fused_scale_assign_t::apply(*vec_ops_, static_cast<T>(1)/beta, r_, V_, restart_+1, 0); // V(0) = r/beta
+                lsq_.reset(beta); // s(:) = beta*e_0
                 // std::cout << "s[0] = " << dense_ops_->vector_at(s_, 0) << std::endl;
                 i = -1;
                 do
                 {
                     ++i;
                     ++monitor_;
-                    vec_ops_->assign(r_, y_);
+                    vec_ops_->assign(V_, restart_+1, i, y_);
                     calc_krylov_vector(A, y_, r_);
                     residual_reg_->apply(r_);
-                    T next_r_norm = vec_ops_->norm(r_);
-                    // std::cout << "||r|| = " << next_r_norm << std::endl;
-                    // Gram-Schmidt with iterative correction
-                    for( int k = 0; k <= i; k++)
-                    {
-                        ////old version
-                        //T_vec V_k = vec_ops_->at(V_, restart_+1, k);
-                        //T alpha = vec_ops_->scalar_prod(V_k, r_); // H(k,i) = (V[k],V[i+1])
-
-                        T alpha = vec_ops_->scalar_prod(V_, restart_+1, k, r_); // H(k,i) = (V[k],V[i+1])                        
-                        // std::cout << "i = " << i << ", k = " << k << ", (v_k,r_) = " << alpha  << ", ||v_k|| = " << vec_ops_->norm(V_k) << std::endl;
-
-                        ////old version
-                        //vec_ops_->add_lin_comb(-alpha, V_k, 1.0, r_); // V(i+1) -= H(k, i) * V(k)
-
-                        vec_ops_->add_lin_comb(-alpha, V_, restart_+1, k, 1.0, r_); // V(i+1) -= H(k, i) * V(k)
-
-                        T c_norm = alpha;
-                        int correction_iterations = 0;
-                        while( (prms_.reorthogonalization)&&(c_norm > error_L2_basic_type_*next_r_norm )) //iterative correction
-                        {
-                            correction_iterations++;
-                            //T c = vec_ops_->scalar_prod(V_k, r_); // H(k,i) = (V[k], V[i+1]) //old version
-                            T c = vec_ops_->scalar_prod(V_, restart_+1, k, r_); // H(k,i) = (V[k], V[i+1])
-                            c_norm = std::abs(c);
-                            //vec_ops_->add_lin_comb(-c, V_k, 1.0, r_); //old version
-                            vec_ops_->add_lin_comb(-c, V_, restart_+1, k, 1.0, r_);
-                            alpha += c;
-                            if(correction_iterations>10)
-                            {
-                                //if we are here, then the method will probably diverge.
-                                logged_obj_t::warning_f("failed in Gram-Schmidt reorthogonalization in iteration %i, restart %i with error %e", k, i, c_norm); 
-                                break;
-                            }
-                        }
-                        dense_ops_->matrix_at(H_, k, i) = alpha;
-                    }
+                    T h_ip = orthogonalize(i);
 
                     // for(int ll=0;ll<=i;ll++)
                     // {
@@ -510,20 +415,15 @@ public:
                     // }
 
 
-                    T h_ip = vec_ops_->norm(r_);
                     // H_[(i + 1)*restart_ + i] = h_ip;
                     dense_ops_->matrix_at(H_, i+1, i) = h_ip;
 
                     //T_vec V_ip1 = vec_ops_->at(V_, restart_+1, i+1); //old version
                     
-                    vec_ops_->scale(1.0/h_ip, r_);
                     //vec_ops_->assign(r_, V_ip1); //old version
-                    vec_ops_->assign(r_, V_, restart_+1, i+1);
+                    fused_scale_assign_t::apply(*vec_ops_, static_cast<T>(1)/h_ip, r_, V_, restart_+1, i+1); // V(i+1) = r/h_ip
                     
-                    // plane_rotation_(H_, cs_, sn_, s_, i); //QR via Givens rotations
-                    dense_ops_->plane_rotation_col(H_, cs_, sn_, s_, i);
-
-                    T resid_estimate = std::abs(dense_ops_->vector_at(s_, i+1));
+                    T resid_estimate = lsq_.add_column(H_, i, i+2); //QR via Givens rotations
 
                     reduction_rates.push_back(resid_estimate/previous_res);
                     if((total_iterations%prms_.batch_size == 0)||(i+1 == restart_))
@@ -548,7 +448,7 @@ public:
                         vec_ops_->assign(x, x_tmp_);
                     //      check real solution
                     // Ritz value may not be acurate in approx arithmetics
-                        dense_ops_->solve_upper_triangular_subsystem(H_, s_, s_h_, i+1);
+                        lsq_.solve(s_h_);
 
                         // std::cout << "s_:" << std::endl;
                         // dense_ops_->print_col_vector(s_, 9);
@@ -597,7 +497,7 @@ public:
                 {
                     // std::cout << "s_:" << std::endl;
                     // dense_ops_->print_col_vector(s_, 16);
-                    dense_ops_->solve_upper_triangular_subsystem(H_, s_, s_h_, i+1);
+                    lsq_.solve(s_h_);
                     // std::cout << "s_h_:" << std::endl;
                     // dense_ops_->print_col_vector(s_h_, 16);
                         construct_solution(i, s_h_, y_);
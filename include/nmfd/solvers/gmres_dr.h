@@ -0,0 +1,589 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_GMRES_DR_H__
+#define __NMFD_GMRES_DR_H__
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <cmath>
+#include <limits>
+#ifdef NMFD_ENABLE_NLOHMANN
+#include <nlohmann/json.hpp>
+#endif
+#include "detail/monitor_call_wrap.h"
+#include <nmfd/detail/algo_utils_hierarchy.h>
+#include <nmfd/detail/algo_params_hierarchy.h>
+#include <nmfd/detail/algo_hierarchy_creator.h>
+#include "iter_solver_base.h"
+#include "detail/dense_operations.h"
+#include "detail/gram_schmidt.h"
+#include "detail/givens_least_squares.h"
+#include "detail/krylov_hierarchy.h"
+#include "detail/preconditioned_operator.h"
+#include "detail/residual_regularization_dummy.h"
+#include <nmfd/preconditioners/dummy.h>
+
+namespace nmfd
+{
+namespace solvers
+{
+
+/**
+ * Restarted GMRES with deflated restarting (GMRES-DR, R.B. Morgan).
+ * At each restart deflation_size harmonic Ritz vectors corresponding to the smallest harmonic Ritz values
+ * are kept together with the residual as the start of the next cycle, so small outlying eigenvalues,
+ * which usually stall restarted gmres, are deflated. Each cycle after the first one costs basis_size-deflation_size
+ * operator applications. Harmonic Ritz pairs are found from the small projected matrix on the host.
+ * deflation_size = 0 gives plain restarted gmres.
+ * Template parameters demands are the same as for gmres.
+ **/
+
+template
+<
+     class VectorOperations, class Monitor, class Log,
+     class LinearOperator, class Preconditioner = preconditioners::dummy<VectorOperations,LinearOperator>,
+     class ResidualRegulariation = detail::residual_regularization_dummy,
+     class DenseOperations = detail::dense_operations<typename VectorOperations::Ord, typename VectorOperations::scalar_type>
+>
+class gmres_dr : public iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, Preconditioner>
+{
+    using parent_t = iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, Preconditioner>;
+    using logged_obj_t = typename parent_t::logged_obj_t;
+    using logged_obj_params_t = typename parent_t::logged_obj_params_t;
+
+public:
+    using scalar_type =  typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using linear_operator_type =  LinearOperator;
+    using preconditioner_type = Preconditioner;
+    using vector_operations_type = VectorOperations;
+    using dense_operations_t = DenseOperations;
+    using monitor_type = Monitor;
+    using log_type = Log;
+    using residual_regulaization_t = ResidualRegulariation;
+
+
+    struct params : public logged_obj_params_t
+    {
+        unsigned basis_size; //size of the krylov basis
+        unsigned deflation_size; //number of harmonic Ritz vectors kept on restart, must not exceed basis_size-2
+        unsigned batch_size; //residual estimate is logged each batch_size iterations
+        char preconditioner_side; //can be L for left and R for right
+        std::string orthogonalization; //mgs, cgs or cgs2
+        bool reorthogonalization; //iterative correction of projections in mgs (see detail/gram_schmidt.h)
+        typename Monitor::params monitor;
+
+        params(const std::string &log_prefix = "", const std::string &log_name = "gmres_dr::") :
+            logged_obj_params_t(0, log_prefix+log_name),
+            basis_size(20),
+            deflation_size(5),
+            batch_size(5),
+            preconditioner_side('R'),
+            orthogonalization("cgs2"),
+            reorthogonalization(false),
+            monitor( typename Monitor::params(this->log_msg_prefix) )
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            basis_size = j.value("basis_size", basis_size);
+            deflation_size = j.value("deflation_size", deflation_size);
+            batch_size = j.value("batch_size", batch_size);
+            preconditioner_side = j.value("preconditioner_side", preconditioner_side);
+            orthogonalization = j.value("orthogonalization", orthogonalization);
+            reorthogonalization = j.value("reorthogonalization", reorthogonalization);
+            monitor.from_json(j.at("monitor"));
+        }
+        nlohmann::json to_json() const
+        {
+            return
+                nlohmann::json
+                {
+                    {"type", "gmres_dr"},
+                    {"basis_size", basis_size},
+                    {"deflation_size", deflation_size},
+                    {"batch_size", batch_size},
+                    {"preconditioner_side", preconditioner_side},
+                    {"orthogonalization", orthogonalization},
+                    {"reorthogonalization", reorthogonalization},
+                    {"monitor", monitor.to_json()}
+                };
+        }
+        #endif
+    };
+    using utils = detail::krylov_utils<vector_operations_type, Log, residual_regulaization_t, dense_operations_t>;
+    using params_hierarchy = detail::krylov_params_hierarchy<params, Preconditioner>;
+    using utils_hierarchy = detail::krylov_utils_hierarchy<utils, Preconditioner>;
+
+private:
+    using T = scalar_type;
+    using T_vec = vector_type;
+    using T_mvec = multivector_type;
+
+    using D_vec = typename dense_operations_t::vector_type;
+    using D_mat = typename dense_operations_t::matrix_type;
+
+    using monitor_call_wrap_t = detail::monitor_call_wrap<VectorOperations, Monitor>;
+
+    //V_ is krylov basis, W_ is buffer for basis recombination on deflated restart
+    mutable T_mvec V_;
+    mutable T_mvec W_;
+    mutable T_vec r_;
+    mutable T_vec y_;
+    mutable T_vec x_tmp_;
+
+    //parameters:
+    params prms_;
+    int m_;
+    int k_;
+    detail::gram_schmidt<VectorOperations> orth_;
+
+    //host dense operations vectors and matrices:
+    //H_ is (m+1) x m Arnoldi relation matrix (not Hessenberg after deflated restart), c_ is residual in V basis,
+    //d_ is least squares solution, rho_ is least squares residual, P_ is basis of the retained subspace
+    mutable D_mat H_, G_, work_mat_, P_;
+    mutable D_vec c_, d_, rho_, f_, wr_, wi_, gr_, gi_;
+    //QR factorization of H_ updated by one column per iteration
+    mutable detail::givens_least_squares<dense_operations_t> lsq_;
+    //host buffer for Gram-Schmidt and linear combinations coefficients
+    mutable std::vector<T> orth_coeffs_;
+
+
+    void calc_left_preconditioned_residual(const linear_operator_type &A, const T_vec &x, const T_vec &b, T_vec &r)const
+    {
+        detail::calc_left_preconditioned_residual(*vec_ops_, A, prec_.get(), prms_.preconditioner_side, x, b, r);
+    }
+
+    void calc_right_precond_solution(T_vec &x) const
+    {
+        detail::apply_right_preconditioner(prec_.get(), prms_.preconditioner_side, x);
+    }
+
+    void init_host()
+    {
+        dense_ops_->init_matrices(H_, G_, work_mat_, P_);
+        dense_ops_->init_col_vectors(c_, d_, rho_, f_, wr_, wi_, gr_, gi_);
+        lsq_.init(dense_ops_);
+    }
+
+    void free_host_()
+    {
+        dense_ops_->free_matrices(H_, G_, work_mat_, P_);
+        dense_ops_->free_col_vectors(c_, d_, rho_, f_, wr_, wi_, gr_, gi_);
+        lsq_.free();
+    }
+
+    void init_all() const
+    {
+        vec_ops_->init_vector( r_ );
+        vec_ops_->init_vector( y_ );
+        vec_ops_->init_vector( x_tmp_ );
+        vec_ops_->init_multivector( V_, m_+1 );
+        vec_ops_->init_multivector( W_, k_+2 );
+    }
+    void start_use_all() const
+    {
+        vec_ops_->start_use_vector( r_ );
+        vec_ops_->start_use_vector( y_ );
+        vec_ops_->start_use_vector( x_tmp_ );
+        vec_ops_->start_use_multivector( V_, m_+1 );
+        vec_ops_->start_use_multivector( W_, k_+2 );
+    }
+    void stop_use_all() const
+    {
+        vec_ops_->stop_use_vector( r_ );
+        vec_ops_->stop_use_vector( y_ );
+        vec_ops_->stop_use_vector( x_tmp_ );
+        vec_ops_->stop_use_multivector( V_, m_+1 );
+        vec_ops_->stop_use_multivector( W_, k_+2 );
+    }
+    void free_all() const
+    {
+        vec_ops_->free_vector( r_ );
+        vec_ops_->free_vector( y_ );
+        vec_ops_->free_vector( x_tmp_ );
+        vec_ops_->free_multivector( V_, m_+1 );
+        vec_ops_->free_multivector( W_, k_+2 );
+    }
+
+    /// orthogonalizes r_ against V(0:i), writes coefficients into H(0:i,i) and returns norm of orthogonalized r_
+    T orthogonalize(const int i) const
+    {
+        T h_ip = orth_.orthogonalize(*vec_ops_, V_, m_+1, i+1, r_, orth_coeffs_.data());
+        if(orth_.correction_failed())
+        {
+            logged_obj_t::warning_f("failed in Gram-Schmidt reorthogonalization in iteration %i", i);
+        }
+        for(int k = 0; k <= i; k++)
+        {
+            H_(k, i) = orth_coeffs_[k];
+        }
+        return h_ip;
+    }
+
+    /// y := V(0:n)*coeffs(0:n)
+    void combine_basis(const int n, T_vec &y) const
+    {
+        vec_ops_->assign_scalar(static_cast<T>(0), y);
+        vec_ops_->multi_add_lin_comb(orth_coeffs_.data(), V_, m_+1, 0, n, static_cast<T>(1), y);
+    }
+
+    /// x := x + V(0:i)*d, r_ gets new residual
+    void update_solution(const linear_operator_type &A, const int i, const T_vec &b, T_vec &x) const
+    {
+        lsq_.solve(d_);
+        for(int j = 0; j <= i; j++)
+        {
+            orth_coeffs_[j] = d_(j);
+        }
+        combine_basis(i+1, y_);
+        calc_right_precond_solution(y_);
+        residual_reg_->apply(y_);
+        vec_ops_->add_lin_comb(static_cast<T>(1), y_, static_cast<T>(1), x);
+        calc_left_preconditioned_residual(A, x, b, r_);
+        residual_reg_->apply(r_);
+    }
+
+    /// orthonormalizes column col of P_ (rows 0:m) against columns 0:col; returns false if column is lost
+    bool orthonormalize_P_column(const int col) const
+    {
+        T norm0 = 0;
+        for(int r = 0; r <= m_; r++) norm0 += P_(r, col)*P_(r, col);
+        norm0 = std::sqrt(norm0);
+        for(int pass = 0; pass < 2; pass++)
+        {
+            for(int l = 0; l < col; l++)
+            {
+                T alpha = 0;
+                for(int r = 0; r <= m_; r++) alpha += P_(r, l)*P_(r, col);
+                for(int r = 0; r <= m_; r++) P_(r, col) -= alpha*P_(r, l);
+            }
+        }
+        T norm = 0;
+        for(int r = 0; r <= m_; r++) norm += P_(r, col)*P_(r, col);
+        norm = std::sqrt(norm);
+        if(!(norm > std::sqrt(std::numeric_limits<T>::epsilon())*norm0))
+        {
+            return false;
+        }
+        for(int r = 0; r <= m_; r++) P_(r, col) /= norm;
+        return true;
+    }
+
+    /// deflated restart after full cycle with least squares solution d_ of size m:
+    /// V(0:kk+1), H(0:kk+1,0:kk) and c(0:kk+1) are replaced with the ones for the subspace spanned by
+    /// harmonic Ritz vectors and the residual. Returns kk (number of kept harmonic Ritz vectors),
+    /// zero means that deflation failed and plain restart must be done.
+    int deflate() const
+    {
+        //least squares residual rho = c - H*d in the V(0:m+1) basis
+        for(int r = 0; r <= m_; r++)
+        {
+            T val = c_(r);
+            for(int j = 0; j < m_; j++) val -= H_(r, j)*d_(j);
+            rho_(r) = val;
+        }
+        //harmonic Ritz values are eigenvalues of H_m + h_{m+1,m}^2 H_m^{-T} e_m e_m^T
+        dense_ops_->assign_scalar_col_vector(0, f_);
+        f_(m_-1) = static_cast<T>(1);
+        if(!dense_ops_->solve_linear_system(H_, m_, work_mat_, f_, true))
+        {
+            return 0;
+        }
+        const T h_last = H_(m_, m_-1);
+        for(int r = 0; r < m_; r++)
+        {
+            for(int j = 0; j < m_; j++)
+            {
+                G_(r, j) = H_(r, j);
+            }
+            G_(r, m_-1) += h_last*h_last*f_(r);
+        }
+        //after deflated restart leading block of H is full, so G is reduced to Hessenberg form first
+        dense_ops_->assign_matrix(G_, work_mat_);
+        dense_ops_->reduce_to_hessenberg(work_mat_, m_);
+        if(!dense_ops_->hessenberg_eigenvalues(work_mat_, m_, P_, wr_, wi_))
+        {
+            return 0;
+        }
+        std::vector<int> ind(m_);
+        for(int j = 0; j < m_; j++) ind[j] = j;
+        std::stable_sort(ind.begin(), ind.end(), [this](int a, int b)
+        {
+            return std::hypot(wr_(a), wi_(a)) < std::hypot(wr_(b), wi_(b));
+        });
+        //complex conjugate pair is represented by real and imaginary parts of the eigenvector, so kk may be k_+1
+        int kk = 0;
+        dense_ops_->assign_scalar_matrix(0, P_);
+        for(int l = 0; (l < m_)&&(kk < k_); l++)
+        {
+            int j = ind[l];
+            if(wi_(j) < static_cast<T>(0)) continue;
+            dense_ops_->eigenvector_inverse_iteration(G_, m_, wr_(j), wi_(j), gr_, gi_);
+            for(int r = 0; r < m_; r++) P_(r, kk) = gr_(r);
+            if(!orthonormalize_P_column(kk)) return 0;
+            kk++;
+            if(wi_(j) > static_cast<T>(0))
+            {
+                for(int r = 0; r < m_; r++) P_(r, kk) = gi_(r);
+                if(!orthonormalize_P_column(kk)) return 0;
+                kk++;
+            }
+        }
+        for(int r = 0; r <= m_; r++) P_(r, kk) = rho_(r);
+        if(!orthonormalize_P_column(kk)) return 0;
+
+        //H := P(0:m+1,0:kk+1)^T*H*P(0:m,0:kk), G_ holds H*P
+        for(int r = 0; r <= m_; r++)
+        {
+            for(int j = 0; j < kk; j++)
+            {
+                T val = 0;
+                for(int l = 0; l < m_; l++) val += H_(r, l)*P_(l, j);
+                G_(r, j) = val;
+            }
+        }
+        dense_ops_->assign_scalar_matrix(0, H_);
+        for(int i = 0; i <= kk; i++)
+        {
+            for(int j = 0; j < kk; j++)
+            {
+                T val = 0;
+                for(int r = 0; r <= m_; r++) val += P_(r, i)*G_(r, j);
+                H_(i, j) = val;
+            }
+        }
+        //residual lies in span of P, so c := P^T*rho
+        dense_ops_->assign_scalar_col_vector(0, c_);
+        for(int i = 0; i <= kk; i++)
+        {
+            T val = 0;
+            for(int r = 0; r <= m_; r++) val += P_(r, i)*rho_(r);
+            c_(i) = val;
+        }
+        //V(0:kk+1) := V*P
+        for(int i = 0; i <= kk; i++)
+        {
+            for(int r = 0; r <= m_; r++) orth_coeffs_[r] = P_(r, i);
+            combine_basis(m_+1, y_);
+            vec_ops_->assign(y_, W_, k_+2, i);
+        }
+        for(int i = 0; i <= kk; i++)
+        {
+            vec_ops_->assign(W_, k_+2, i, y_);
+            vec_ops_->assign(y_, V_, m_+1, i);
+        }
+        return kk;
+    }
+
+protected:
+    using parent_t::monitor_;
+    using parent_t::vec_ops_;
+    using parent_t::prec_;
+    std::shared_ptr<dense_operations_t> dense_ops_;
+    std::shared_ptr<residual_regulaization_t> residual_reg_;
+
+public:
+    ~gmres_dr()
+    {
+        free_host_();
+        free_all();
+    }
+
+    gmres_dr(
+        std::shared_ptr<vector_operations_type> vec_ops,
+        Log *log = nullptr,
+        const params& prm = params(),
+        std::shared_ptr<preconditioner_type> prec = nullptr,
+        std::shared_ptr<residual_regulaization_t> residual_reg = std::make_shared<residual_regulaization_t>(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        parent_t(std::move(vec_ops), log, prm, prm.monitor, std::move(prec) ),
+        prms_(prm),
+        m_(prm.basis_size),
+        k_(prm.deflation_size),
+        orth_(prm.orthogonalization, prm.reorthogonalization, prm.basis_size+1, "gmres_dr"),
+        dense_ops_(std::move(dense_ops)),
+        residual_reg_(std::move(residual_reg))
+    {
+        if(prm.deflation_size+2 > prm.basis_size)
+        {
+            throw std::logic_error("gmres_dr: deflation_size must not exceed basis_size-2");
+        }
+        orth_coeffs_.resize(prm.basis_size+1);
+        dense_ops_->init(prm.basis_size+1, prm.basis_size);
+        init_host();
+        init_all();
+        vec_ops_->start_use_vector(y_);
+        orth_.init_tolerance(*vec_ops_, y_);
+        vec_ops_->stop_use_vector(y_);
+    }
+    gmres_dr(
+        std::shared_ptr<const linear_operator_type> A,
+        std::shared_ptr<vector_operations_type> vec_ops,
+        Log *log = nullptr,
+        const params& prm = params(),
+        std::shared_ptr<preconditioner_type> prec = nullptr,
+        std::shared_ptr<residual_regulaization_t> residual_reg = std::make_shared<residual_regulaization_t>(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        gmres_dr(std::move(vec_ops),log,prm,std::move(prec),std::move(residual_reg),std::move(dense_ops))
+    {
+        parent_t::set_operator(std::move(A));
+    }
+
+    gmres_dr(
+        const utils_hierarchy& utils,
+        const params_hierarchy& prm = params_hierarchy()
+    ) :
+        gmres_dr(
+            utils.vec_ops, utils.log, prm,
+            nmfd::detail::algo_hierarchy_creator<preconditioner_type>::get(utils.preconditioner,prm.preconditioner),
+            utils.residual_reg, utils.dense_ops
+        )
+    {
+    }
+
+    const std::shared_ptr<preconditioner_type> &preconditioner()const
+    {
+        return prec_;
+    }
+
+    virtual bool solve(const linear_operator_type &A, const T_vec &b, T_vec &x)const
+    {
+        start_use_all();
+        monitor_call_wrap_t monitor_wrap(monitor_);
+
+        if ((prec_ != nullptr)&&(prms_.preconditioner_side == 'L'))
+        {
+            vec_ops_->assign(b, r_);
+            prec_->apply(r_);
+            residual_reg_->apply(r_);
+            monitor_wrap.start(r_);
+        }
+        else
+        {
+            monitor_wrap.start(b);
+        }
+
+        calc_left_preconditioned_residual(A, x, b, r_);
+        residual_reg_->apply(r_);
+        bool converged_by_checked_ritz_norm = false;
+        std::size_t total_iterations = 0;
+        //number of harmonic Ritz vectors kept from the previous cycle
+        int kk = 0;
+
+        if( !monitor_.check_finished(x, r_) )
+        {
+            do
+            {
+                if(kk == 0)
+                {
+                    dense_ops_->assign_scalar_matrix(0, H_);
+                    T beta = vec_ops_->norm(r_);
+                    vec_ops_->scale(static_cast<T>(1)/beta, r_);
+                    vec_ops_->assign(r_, V_, m_+1, 0);
+                    dense_ops_->assign_scalar_col_vector(0, c_);
+                    c_(0) = beta;
+                    lsq_.reset(beta);
+                }
+                else
+                {
+                    //leading kk columns of H are full after deflated restart
+                    lsq_.reset(c_, kk+1);
+                    for(int j = 0; j < kk; j++)
+                    {
+                        lsq_.add_column(H_, j, kk+1);
+                    }
+                }
+
+                int i = kk-1;
+                do
+                {
+                    ++i;
+                    ++monitor_;
+                    vec_ops_->assign(V_, m_+1, i, y_);
+                    detail::calc_krylov_vector(A, prec_.get(), prms_.preconditioner_side, residual_reg_.get(), y_, r_);
+                    T h_ip = orthogonalize(i);
+                    H_(i+1, i) = h_ip;
+                    vec_ops_->scale(static_cast<T>(1)/h_ip, r_);
+                    vec_ops_->assign(r_, V_, m_+1, i+1);
+
+                    T resid_estimate = lsq_.add_column(H_, i, i+2);
+                    total_iterations++;
+                    if((total_iterations%prms_.batch_size == 0)||(i+1 == m_))
+                    {
+                        logged_obj_t::info_f("iter = %i(%i), resid_estimate = %e", static_cast<int>(total_iterations), i+1, monitor_.norm_out(resid_estimate) );
+                    }
+
+                    if ( monitor_.check_finished_by_ritz_estimate(resid_estimate) )
+                    {
+                        vec_ops_->assign(x, x_tmp_);
+                        update_solution(A, i, b, x);
+                        if (monitor_.check_finished(x, r_))
+                        {
+                            converged_by_checked_ritz_norm = true;
+                            break;
+                        }
+                        else
+                        {
+                            vec_ops_->assign(x_tmp_, x);
+                        }
+                    }
+                }
+                while( i + 1 < m_ );
+
+                if(!converged_by_checked_ritz_norm)
+                {
+                    update_solution(A, i, b, x);
+                    kk = 0;
+                    if(k_ > 0)
+                    {
+                        kk = deflate();
+                        if(kk == 0)
+                        {
+                            logged_obj_t::warning_f("deflation failed, plain restart is performed");
+                        }
+                    }
+                }
+            }
+            while(!converged_by_checked_ritz_norm && !monitor_.check_finished(x, r_) );
+        }
+
+        bool res = monitor_.converged();
+        if(!res)
+            logged_obj_t::error_f("solve: linear solver failed to converge");
+
+        stop_use_all();
+
+        return res;
+    }
+
+    bool solve(const vector_type &b, vector_type &x)const
+    {
+        return solve(*parent_t::A_, b, x);
+    }
+};
+
+}
+}
+
+#endif //__NMFD_GMRES_DR_H__
@@ -0,0 +1,304 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_ITERATIVE_REFINEMENT_H__
+#define __NMFD_ITERATIVE_REFINEMENT_H__
+
+#include <string>
+#include <memory>
+#ifdef NMFD_ENABLE_NLOHMANN
+#include <nlohmann/json.hpp>
+#endif
+#include "detail/monitor_call_wrap.h"
+#include <nmfd/detail/algo_utils_hierarchy.h>
+#include <nmfd/detail/algo_params_hierarchy.h>
+#include <nmfd/detail/algo_hierarchy_creator.h>
+#include "iter_solver_base.h"
+#include <nmfd/preconditioners/dummy.h>
+
+namespace nmfd
+{
+namespace solvers
+{
+
+/**
+ * Mixed precision iterative refinement: residuals r = b - A*x and solution updates are calculated in
+ * VectorOperations scalar type (e.g. double), while correction equations A*e = r are solved approximately
+ * by InnerSolver working in its own (lower, e.g. float) precision space, including all of its krylov basis
+ * and preconditioner (mg) storage.
+ * InnerSolver must have its own operator (lower precision copy of A) already set and provide
+ * solve(const inner_vector_type &b, inner_vector_type &x) and vector_operations_type/vector_type types.
+ * Both spaces must support conversions: inner_ops.assign_convert(ops, r, r_inner) and
+ * ops.add_lin_comb_convert(mul, inner_ops, e_inner, 1, x) (see dense_vector_operations).
+ * Residual is normalized before conversion, so late refinement steps with small residuals do not lose
+ * accuracy because of inner scalar type range.
+ * Each refinement step counts as one iteration of the monitor; inner solver tolerance should be
+ * moderate (about 1e-3..1e-5 for float) - each step reduces error by this factor.
+ **/
+
+template
+<
+     class VectorOperations, class Monitor, class Log,
+     class LinearOperator, class InnerSolver
+>
+class iterative_refinement :
+    public iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, preconditioners::dummy<VectorOperations,LinearOperator>>
+{
+    using parent_t = iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, preconditioners::dummy<VectorOperations,LinearOperator>>;
+    using logged_obj_t = typename parent_t::logged_obj_t;
+    using logged_obj_params_t = typename parent_t::logged_obj_params_t;
+
+public:
+    using scalar_type =  typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using linear_operator_type =  LinearOperator;
+    using vector_operations_type = VectorOperations;
+    using monitor_type = Monitor;
+    using log_type = Log;
+    using inner_solver_type = InnerSolver;
+    using inner_vector_operations_type = typename InnerSolver::vector_operations_type;
+    using inner_vector_type = typename InnerSolver::vector_type;
+
+
+    struct params : public logged_obj_params_t
+    {
+        typename Monitor::params monitor;
+
+        params(const std::string &log_prefix = "", const std::string &log_name = "iterative_refinement::") :
+            logged_obj_params_t(0, log_prefix+log_name),
+            monitor( typename Monitor::params(this->log_msg_prefix) )
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            monitor.from_json(j.at("monitor"));
+        }
+        nlohmann::json to_json() const
+        {
+            return
+                nlohmann::json
+                {
+                    {"type", "iterative_refinement"},
+                    {"monitor", monitor.to_json()}
+                };
+        }
+        #endif
+    };
+    struct utils
+    {
+        std::shared_ptr<vector_operations_type> vec_ops;
+        std::shared_ptr<inner_vector_operations_type> inner_vec_ops;
+        Log *log;
+        utils() = default;
+        utils(
+            std::shared_ptr<vector_operations_type> vec_ops_,
+            std::shared_ptr<inner_vector_operations_type> inner_vec_ops_,
+            Log *log_ = nullptr
+        ) :
+            vec_ops(vec_ops_), inner_vec_ops(inner_vec_ops_), log(log_)
+        {
+        }
+    };
+    using inner_solver_params_hierarchy_type = typename nmfd::detail::algo_params_hierarchy<InnerSolver>::type;
+    struct params_hierarchy : public params
+    {
+        inner_solver_params_hierarchy_type inner_solver;
+
+        params_hierarchy(const std::string &log_prefix = "", const std::string &log_name = "iterative_refinement::") :
+            params(log_prefix, log_name),
+            inner_solver(this->log_msg_prefix)
+        {
+        }
+        params_hierarchy(
+            const params &prm_,
+            const inner_solver_params_hierarchy_type &inner_solver_
+        ) : params(prm_), inner_solver(inner_solver_)
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            params::from_json(j);
+            inner_solver.from_json(j.at("inner_solver"));
+        }
+        nlohmann::json to_json() const
+        {
+            nlohmann::json  j = params::to_json(),
+                            j_inner = inner_solver.to_json();
+            j["inner_solver"] = j_inner;
+            return j;
+        }
+        #endif
+    };
+
+    using inner_solver_utils_hierarchy_type = typename nmfd::detail::algo_utils_hierarchy<InnerSolver>::type;
+    struct utils_hierarchy : public utils
+    {
+        inner_solver_utils_hierarchy_type inner_solver;
+
+        utils_hierarchy() = default;
+        template<class ...Args>
+        utils_hierarchy(
+            inner_solver_utils_hierarchy_type inner_solver_,
+            Args... args
+        ) :
+            utils(args...),
+            inner_solver(inner_solver_)
+        {
+        }
+    };
+
+private:
+    using T = scalar_type;
+    using T_vec = vector_type;
+
+    using monitor_call_wrap_t = detail::monitor_call_wrap<VectorOperations, Monitor>;
+
+    mutable T_vec r_;
+    mutable inner_vector_type r_inner_, e_inner_;
+
+    params prms_;
+    std::shared_ptr<inner_vector_operations_type> inner_vec_ops_;
+    std::shared_ptr<inner_solver_type> inner_solver_;
+
+    void calc_residual(const linear_operator_type &A, const T_vec &x, const T_vec &b, T_vec &r)const
+    {
+        A.apply(x, r);
+        vec_ops_->add_lin_comb(static_cast<T>(1.0), b, static_cast<T>(-1.0), r);
+    }
+
+    void init_all() const
+    {
+        vec_ops_->init_vector( r_ );
+        inner_vec_ops_->init_vector( r_inner_ );
+        inner_vec_ops_->init_vector( e_inner_ );
+    }
+    void start_use_all() const
+    {
+        vec_ops_->start_use_vector( r_ );
+        inner_vec_ops_->start_use_vector( r_inner_ );
+        inner_vec_ops_->start_use_vector( e_inner_ );
+    }
+    void stop_use_all() const
+    {
+        vec_ops_->stop_use_vector( r_ );
+        inner_vec_ops_->stop_use_vector( r_inner_ );
+        inner_vec_ops_->stop_use_vector( e_inner_ );
+    }
+    void free_all() const
+    {
+        vec_ops_->free_vector( r_ );
+        inner_vec_ops_->free_vector( r_inner_ );
+        inner_vec_ops_->free_vector( e_inner_ );
+    }
+
+protected:
+    using parent_t::monitor_;
+    using parent_t::vec_ops_;
+
+public:
+    ~iterative_refinement()
+    {
+        free_all();
+    }
+
+    iterative_refinement(
+        std::shared_ptr<vector_operations_type> vec_ops,
+        std::shared_ptr<inner_vector_operations_type> inner_vec_ops,
+        std::shared_ptr<inner_solver_type> inner_solver,
+        Log *log = nullptr,
+        const params& prm = params()
+    ) :
+        parent_t(std::move(vec_ops), log, prm, prm.monitor),
+        prms_(prm),
+        inner_vec_ops_(std::move(inner_vec_ops)),
+        inner_solver_(std::move(inner_solver))
+    {
+        init_all();
+    }
+    iterative_refinement(
+        std::shared_ptr<const linear_operator_type> A,
+        std::shared_ptr<vector_operations_type> vec_ops,
+        std::shared_ptr<inner_vector_operations_type> inner_vec_ops,
+        std::shared_ptr<inner_solver_type> inner_solver,
+        Log *log = nullptr,
+        const params& prm = params()
+    ) :
+        iterative_refinement(std::move(vec_ops),std::move(inner_vec_ops),std::move(inner_solver),log,prm)
+    {
+        parent_t::set_operator(std::move(A));
+    }
+
+    iterative_refinement(
+        const utils_hierarchy& utils,
+        const params_hierarchy& prm = params_hierarchy()
+    ) :
+        iterative_refinement(
+            utils.vec_ops, utils.inner_vec_ops,
+            nmfd::detail::algo_hierarchy_creator<inner_solver_type>::get(utils.inner_solver,prm.inner_solver),
+            utils.log, prm
+        )
+    {
+    }
+
+    const std::shared_ptr<inner_solver_type> &inner_solver()const
+    {
+        return inner_solver_;
+    }
+
+    virtual bool solve(const linear_operator_type &A, const T_vec &b, T_vec &x)const
+    {
+        start_use_all();
+        monitor_call_wrap_t monitor_wrap(monitor_);
+        monitor_wrap.start(b);
+
+        calc_residual(A, x, b, r_);
+        while(!monitor_.check_finished(x, r_))
+        {
+            ++monitor_;
+            //correction equation A*e = r/||r|| is solved in inner precision
+            T r_norm = monitor_.resid_norm();
+            vec_ops_->scale(static_cast<T>(1)/r_norm, r_);
+            inner_vec_ops_->assign_convert(*vec_ops_, r_, r_inner_);
+            inner_vec_ops_->assign_scalar(static_cast<typename inner_vector_operations_type::scalar_type>(0), e_inner_);
+            if(!inner_solver_->solve(r_inner_, e_inner_))
+            {
+                logged_obj_t::warning_f("solve: inner solver failed to converge at refinement step %i", monitor_.iters_performed());
+            }
+            vec_ops_->add_lin_comb_convert(r_norm, *inner_vec_ops_, e_inner_, static_cast<T>(1), x);
+            calc_residual(A, x, b, r_);
+        }
+
+        bool res = monitor_.converged();
+        if(!res)
+            logged_obj_t::error_f("solve: linear solver failed to converge");
+
+        stop_use_all();
+
+        return res;
+    }
+
+    bool solve(const vector_type &b, vector_type &x)const
+    {
+        return solve(*parent_t::A_, b, x);
+    }
+};
+
+}
+}
+
+#endif //__NMFD_ITERATIVE_REFINEMENT_H__
@@ -17,8 +17,16 @@
 #ifndef __NMFD_NEWTON_ITERATION_H__
 #define __NMFD_NEWTON_ITERATION_H__
 
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <stdexcept>
 #include <nmfd/detail/algo_hierarchy_macro.h>
 #include <nmfd/detail/algo_hierarchy_creator.h>
+#include <nmfd/detail/recycle_space_hook.h>
+#include <nmfd/detail/linearization_point_hook.h>
+#include <nmfd/detail/lin_solver_monitor_hook.h>
+#include <nmfd/detail/jacobi_apply_hook.h>
 
 /// NOTE originally taken from deflated_continuation master branch source/deflation/system_operator_deflation.h 22.07.2025
 
@@ -31,13 +39,86 @@ template<class VectorSpace, class NonlinearOperator, class LinearSolver>
 class newton_iteration
 {
     using T = typename VectorSpace::scalar_type;
+    using lin_solver_monitor_hook_t = nmfd::detail::lin_solver_monitor_hook<LinearSolver>;
+    using jacobi_apply_hook_t = nmfd::detail::jacobi_apply_hook<NonlinearOperator,typename VectorSpace::vector_type>;
 public:
     using scalar_type = typename VectorSpace::scalar_type;
     using vector_type = typename VectorSpace::vector_type;
     using vector_space_type = VectorSpace;
     using linear_operator = typename NonlinearOperator::jacobi_operator_type;
 
-    NMFD_ALGO_EMPTY_PARAMS_TYPE_DEFINE(newton_iteration)
+    /// Jacobian reuse policy (modified newton). Jacobian (set_linearization_point) and linear solver
+    /// operator/preconditioner setup (set_operator) are refreshed only when one of the conditions holds:
+    /// - jacobian_lag steps were made with the current jacobian (jacobian_lag = 1 is classical newton,
+    ///   0 disables this condition);
+    /// - residual decreased worse than ||F(x_k)|| <= max_residual_ratio*||F(x_{k-1})|| on the lagged jacobian;
+    /// - previous linear solve took more than max_lin_iters iterations (0 disables; needs solver with monitor,
+    ///   otherwise constructor throws);
+    /// - linear solve failed with lagged jacobian and refresh_on_lin_fail is set (step is repeated then).
+    /// Jacobian is always refreshed on the first step of every nonlinear solve.
+    ///
+    /// Inexact newton: forcing selects relative tolerance eta_k of the linear solver on step k
+    /// (pushed into its monitor by set_temp_tolerance, so constructor throws for "ew1"/"ew2" if solver has no monitor):
+    /// - "fixed": tolerance of the linear solver monitor is used as is;
+    /// - "ew1": Eisenstat-Walker choice 1, eta_k = | ||F_k|| - ||F_{k-1} + J_{k-1} s_{k-1}|| | / ||F_{k-1}||,
+    ///   safeguarded by eta_{k-1}^((1+sqrt(5))/2) when it exceeds 0.1;
+    /// - "ew2": Eisenstat-Walker choice 2, eta_k = ew_gamma*(||F_k||/||F_{k-1}||)^ew_alpha,
+    ///   safeguarded by ew_gamma*eta_{k-1}^ew_alpha when it exceeds 0.1.
+    /// eta_0 = eta_initial; eta_k is bounded by eta_max from above and by the monitor tolerance from below.
+    /// For "ew1" the linear residual ||F_{k-1} + J_{k-1} s_{k-1}|| of the full step is calculated explicitly
+    /// (one jacobi apply per step) if NonlinearOperator provides jacobi operator with apply (see detail/jacobi_apply_hook.h).
+    /// Otherwise residual norm of the linear solver monitor is used, which is the true linear residual only for
+    /// unpreconditioned or right preconditioned solvers (left preconditioned ones report ||M^{-1}(F + J s)||).
+    struct params
+    {
+        std::string log_msg_prefix;
+        int jacobian_lag;
+        T max_residual_ratio;
+        int max_lin_iters;
+        bool refresh_on_lin_fail;
+        std::string forcing;
+        T eta_initial;
+        T eta_max;
+        T ew_gamma;
+        T ew_alpha;
+
+        params(const std::string &log_prefix = "", const std::string &log_name = "newton_iteration::") :
+            log_msg_prefix(log_prefix), jacobian_lag(1), max_residual_ratio(T(0.5)), max_lin_iters(0), refresh_on_lin_fail(true),
+            forcing("fixed"), eta_initial(T(0.5)), eta_max(T(0.9)), ew_gamma(T(0.9)), ew_alpha(T(2))
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            jacobian_lag = j.value("jacobian_lag", jacobian_lag);
+            max_residual_ratio = j.value("max_residual_ratio", max_residual_ratio);
+            max_lin_iters = j.value("max_lin_iters", max_lin_iters);
+            refresh_on_lin_fail = j.value("refresh_on_lin_fail", refresh_on_lin_fail);
+            forcing = j.value("forcing", forcing);
+            eta_initial = j.value("eta_initial", eta_initial);
+            eta_max = j.value("eta_max", eta_max);
+            ew_gamma = j.value("ew_gamma", ew_gamma);
+            ew_alpha = j.value("ew_alpha", ew_alpha);
+        }
+        nlohmann::json to_json() const
+        {
+            return
+                nlohmann::json
+                {
+                    {"type", "newton_iteration"},
+                    {"jacobian_lag", jacobian_lag},
+                    {"max_residual_ratio", max_residual_ratio},
+                    {"max_lin_iters", max_lin_iters},
+                    {"refresh_on_lin_fail", refresh_on_lin_fail},
+                    {"forcing", forcing},
+                    {"eta_initial", eta_initial},
+                    {"eta_max", eta_max},
+                    {"ew_gamma", ew_gamma},
+                    {"ew_alpha", ew_alpha}
+                };
+        }
+        #endif
+    };
     struct utils
     {
         std::shared_ptr<VectorSpace> vec_space;
@@ -52,11 +133,29 @@ public:
     };
     NMFD_ALGO_HIERARCHY_TYPES_DEFINE(newton_iteration,LinearSolver,lin_solver)
 
-    newton_iteration(std::shared_ptr<VectorSpace> vec_ops, std::shared_ptr<LinearSolver> lin_solver):
+    newton_iteration(
+        std::shared_ptr<VectorSpace> vec_ops, std::shared_ptr<LinearSolver> lin_solver, const params &prm = params()
+    ):
       vec_ops_(std::move(vec_ops)),
-      lin_solver_(std::move(lin_solver))
+      lin_solver_(std::move(lin_solver)),
+      prms_(prm),
+      forcing_(forcing_from_params(prm))
     {
+        if((forcing_ != forcing_t::fixed)&&(!lin_solver_monitor_hook_t::is_available))
+        {
+            throw std::logic_error("newton_iteration: forcing " + prms_.forcing + " needs linear solver with monitor");
+        }
+        if((prms_.max_lin_iters > 0)&&(!lin_solver_monitor_hook_t::is_available))
+        {
+            throw std::logic_error("newton_iteration: max_lin_iters needs linear solver with monitor");
+        }
+        true_lin_resid_ = (forcing_ == forcing_t::ew1)&&(jacobi_apply_hook_t::is_available);
         vec_ops_->init_vector(f_);
+        if(true_lin_resid_)
+        {
+            vec_ops_->init_vector(lin_resid_);
+        }
+        start_solve();
     }
     newton_iteration(
         const utils_hierarchy& utils,
@@ -64,31 +163,191 @@ public:
     ) :
         newton_iteration(
             utils.vec_space,
-            nmfd::detail::algo_hierarchy_creator<LinearSolver>::get(utils.lin_solver,prm.lin_solver)
+            nmfd::detail::algo_hierarchy_creator<LinearSolver>::get(utils.lin_solver,prm.lin_solver),
+            prm
         )
     {
     }
     ~newton_iteration()
     {
+        if(true_lin_resid_)
+        {
+            vec_ops_->free_vector(lin_resid_);
+        }
         vec_ops_->free_vector(f_);
     }
 
     bool solve(NonlinearOperator &nonlin_op, const vector_type& x, vector_type& d_x)
     {
         vec_ops_->start_use_vector(f_);
-        nonlin_op.set_linearization_point(x);
         nonlin_op.apply(x, f_); // f = F(x)
-        vec_ops_->scale(T(-1), f_);
-        lin_solver_->set_operator(nonlin_op.get_jacobi_operator());
-        bool flag_lin_solver = lin_solver_->solve(f_, d_x);
+        bool flag_lin_solver = solve_step(nonlin_op, x, d_x);
+        vec_ops_->stop_use_vector(f_);
+        return flag_lin_solver;
+    }
+    /// Fx = F(x) handed over by nonlinear_solver (see detail/residual_handoff.h) becomes the right hand side
+    bool solve(NonlinearOperator &nonlin_op, const vector_type& x, const vector_type& Fx, vector_type& d_x)
+    {
+        vec_ops_->start_use_vector(f_);
+        vec_ops_->assign(Fx, f_); // f = F(x)
+        bool flag_lin_solver = solve_step(nonlin_op, x, d_x);
         vec_ops_->stop_use_vector(f_);
         return flag_lin_solver;
     }
+    /// called by nonlinear_solver at the start of every solve: lagged jacobian and forcing terms history
+    /// refer to previous problem, so jacobian is refreshed on the next step
+    void start_solve()
+    {
+        reset_jacobian();
+        steps_since_refresh_ = 0;
+        prev_f_norm_ = T(-1);
+        prev_lin_resid_norm_ = T(-1);
+        eta_ = T(-1);
+    }
+    /// forces jacobian and linear solver setup refresh on the next step
+    void reset_jacobian()
+    {
+        is_linearized_ = false;
+    }
+    /// number of jacobian refreshes made so far
+    int jacobian_refreshes_num()const
+    {
+        return refreshes_num_;
+    }
+    /// forcing term (relative tolerance of the linear solver) used on the last step
+    T last_forcing_term()const
+    {
+        return eta_;
+    }
+    const params &get_params()const
+    {
+        return prms_;
+    }
 private:
+    enum class forcing_t { fixed, ew1, ew2 };
+
+    static forcing_t forcing_from_params(const params &p)
+    {
+        if(p.forcing == "fixed") return forcing_t::fixed;
+        if(p.forcing == "ew1") return forcing_t::ew1;
+        if(p.forcing == "ew2") return forcing_t::ew2;
+        throw std::logic_error("newton_iteration: unknown forcing " + p.forcing);
+    }
+
     std::shared_ptr<VectorSpace> vec_ops_;
     std::shared_ptr<LinearSolver> lin_solver_;
-    vector_type f_;
+    params prms_;
+    forcing_t forcing_;
+    vector_type f_, lin_resid_;
+    bool true_lin_resid_;
+    bool is_linearized_;
+    int steps_since_refresh_;
+    T prev_f_norm_, prev_lin_resid_norm_, eta_;
+    int refreshes_num_ = 0;
 
+    /// f_ contains F(x) on entry
+    bool solve_step(NonlinearOperator &nonlin_op, const vector_type& x, vector_type& d_x)
+    {
+        bool need_refresh = !is_linearized_;
+        if((prms_.jacobian_lag > 0)&&(steps_since_refresh_ >= prms_.jacobian_lag))
+        {
+            need_refresh = true;
+        }
+        const bool use_forcing = (forcing_ != forcing_t::fixed);
+        //norm is only needed when jacobian can be lagged or for forcing terms
+        if((prms_.jacobian_lag != 1)||use_forcing)
+        {
+            T f_norm = vec_ops_->norm(f_);
+            if((prms_.jacobian_lag != 1)&&(prev_f_norm_ > T(0))&&(f_norm > prms_.max_residual_ratio*prev_f_norm_))
+            {
+                need_refresh = true;
+            }
+            if(use_forcing)
+            {
+                eta_ = forcing_term(f_norm);
+                lin_solver_monitor_hook_t::set_temp_tolerance(*lin_solver_, eta_);
+            }
+            prev_f_norm_ = f_norm;
+        }
+        if(need_refresh)
+        {
+            refresh_jacobian(nonlin_op, x);
+        }
+        vec_ops_->scale(T(-1), f_); // f = -F(x)
+        bool flag_lin_solver = lin_solver_->solve(f_, d_x);
+        if((!flag_lin_solver)&&(!need_refresh)&&(prms_.refresh_on_lin_fail))
+        {
+            //lagged jacobian may be too far from the actual one: repeat with the fresh one
+            vec_ops_->scale(T(-1), f_); // f = F(x)
+            refresh_jacobian(nonlin_op, x);
+            vec_ops_->scale(T(-1), f_);
+            vec_ops_->assign_scalar(T(0), d_x);
+            flag_lin_solver = lin_solver_->solve(f_, d_x);
+        }
+        if(use_forcing)
+        {
+            prev_lin_resid_norm_ = linear_residual_norm(nonlin_op, d_x);
+            lin_solver_monitor_hook_t::restore_tolerance(*lin_solver_);
+        }
+        ++steps_since_refresh_;
+        if((prms_.max_lin_iters > 0)&&(lin_solver_monitor_hook_t::iters_performed(*lin_solver_) > prms_.max_lin_iters))
+        {
+            is_linearized_ = false;
+        }
+        return flag_lin_solver;
+    }
+    /// ||F + J*d_x|| of the step just found, f_ = -F on entry (see params for the case without jacobi apply)
+    T linear_residual_norm(const NonlinearOperator &nonlin_op, const vector_type& d_x)
+    {
+        if(!true_lin_resid_)
+        {
+            return lin_solver_monitor_hook_t::template resid_norm<T>(*lin_solver_);
+        }
+        vec_ops_->start_use_vector(lin_resid_);
+        jacobi_apply_hook_t::apply(nonlin_op, d_x, lin_resid_);
+        vec_ops_->add_lin_comb(T(-1), f_, T(1), lin_resid_); // lin_resid = J*d_x + F
+        T res = vec_ops_->norm(lin_resid_);
+        vec_ops_->stop_use_vector(lin_resid_);
+        return res;
+    }
+    /// Eisenstat-Walker forcing term for the current residual norm
+    T forcing_term(T f_norm)const
+    {
+        const T rel_tol_min = lin_solver_monitor_hook_t::template rel_tol<T>(*lin_solver_);
+        T eta = prms_.eta_initial;
+        if((prev_f_norm_ > T(0))&&(eta_ > T(0)))
+        {
+            T eta_safe;
+            if(forcing_ == forcing_t::ew1)
+            {
+                eta = std::abs(f_norm - prev_lin_resid_norm_)/prev_f_norm_;
+                eta_safe = std::pow(eta_, T(0.5)*(T(1) + std::sqrt(T(5))));
+            }
+            else
+            {
+                eta = prms_.ew_gamma*std::pow(f_norm/prev_f_norm_, prms_.ew_alpha);
+                eta_safe = prms_.ew_gamma*std::pow(eta_, prms_.ew_alpha);
+            }
+            //prevents too rapid decrease of eta far from the solution
+            if(eta_safe > T(0.1))
+            {
+                eta = std::max(eta, eta_safe);
+            }
+        }
+        eta = std::min(eta, prms_.eta_max);
+        return std::max(eta, rel_tol_min);
+    }
+    /// f_ contains F(x); jacobian-free operators (see operations/jfnk_operator.h) take it as base point of finite differences
+    void refresh_jacobian(NonlinearOperator &nonlin_op, const vector_type& x)
+    {
+        nmfd::detail::linearization_point_hook<NonlinearOperator,vector_type>::set(nonlin_op, x, f_);
+        lin_solver_->set_operator(nonlin_op.get_jacobi_operator());
+        //jacobian has changed, so recycling linear solvers (like gcro_dr) must refresh their recycle space
+        nmfd::detail::recycle_space_hook<LinearSolver,linear_operator>::update(*lin_solver_, *nonlin_op.get_jacobi_operator());
+        is_linearized_ = true;
+        steps_since_refresh_ = 0;
+        ++refreshes_num_;
+    }
 };
 
 }
@@ -32,6 +32,8 @@
 #include <nmfd/operations/zero_functional.h>
 #include <nmfd/detail/algo_hierarchy_macro.h>
 #include <nmfd/detail/algo_hierarchy_creator.h>
+#include <nmfd/detail/start_solve_hook.h>
+#include <nmfd/detail/residual_handoff.h>
 #include "../detail/str_source_helper.h"
 #include "../detail/vector_wrap.h"
 #include "default_convergence_strategy.h"
@@ -128,12 +130,20 @@ public:
         vec_ops_->assign_scalar(T(0.0), *delta_x_);
         bool converged = false;
         conv_strat_->reset_iterations(); //reset iteration count, newton wight and iteration history
+        //state of iteration operator refers to previous problem
+        nmfd::detail::start_solve_hook<IterationOperator>::apply(*iter_op_);
         while(!conv_strat_->check_convergence(nonlin_op, project_op, quality_func, x, *delta_x_))
         {
             //reset iterational vectors??!
             vec_ops_->assign_scalar(T(0.0), *delta_x_);
 
-            bool linsolver_converged = iter_op_->solve(*nonlin_op, x, *delta_x_);
+            //F(x) calculated by convergence check is passed to iteration operator if both support it
+            bool linsolver_converged =
+                nmfd::detail::residual_handoff<ConvergenceStrategy,IterationOperator,NonlinearOperator,vector_type>::solve(
+                    *conv_strat_, *iter_op_, *nonlin_op, x, *delta_x_
+                );
+            //F(x+delta_x) of internally globalized step (trust region) is not recalculated by convergence check
+            nmfd::detail::step_residual_handoff<ConvergenceStrategy,IterationOperator>::pass(*conv_strat_, *iter_op_);
 
             /// TODO some how react to non-converged linsolver maybe??
             /// Think to add parameter to calibrate this behaviour
@@ -176,7 +186,7 @@ public:
     }
 
 private:
-    using vec_wrap_t = detail::vector_wrap<VectorSpace,true,true>;
+    using vec_wrap_t = nmfd::detail::vector_wrap<VectorSpace,true,true>;
 
     std::shared_ptr<VectorSpace> vec_ops_;
     std::shared_ptr<IterationOperator> iter_op_;
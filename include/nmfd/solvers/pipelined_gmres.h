@@ -0,0 +1,444 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_PIPELINED_GMRES_H__
+#define __NMFD_PIPELINED_GMRES_H__
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cmath>
+#include <limits>
+#ifdef NMFD_ENABLE_NLOHMANN
+#include <nlohmann/json.hpp>
+#endif
+#include "detail/monitor_call_wrap.h"
+#include <nmfd/detail/algo_utils_hierarchy.h>
+#include <nmfd/detail/algo_params_hierarchy.h>
+#include <nmfd/detail/algo_hierarchy_creator.h>
+#include "iter_solver_base.h"
+#include "detail/dense_operations.h"
+#include "detail/givens_least_squares.h"
+#include "detail/krylov_hierarchy.h"
+#include "detail/preconditioned_operator.h"
+#include "detail/residual_regularization_dummy.h"
+#include <nmfd/preconditioners/dummy.h>
+
+namespace nmfd
+{
+namespace solvers
+{
+
+/**
+ * Pipelined restarted GMRES with one step lookahead (p(1)-GMRES).
+ * Along with orthonormal basis V auxiliary basis Z(j) = K*V(j-1) is kept (K is preconditioned operator),
+ * so K*V(i) is obtained by linearity from K*Z(i) before V(i) itself is known.
+ * This way the only global reduction phase of the iteration (projections of Z(i) onto V and its norm)
+ * is started with nonblocking scalar_prod_async/multi_scalar_prod_async and overlapped with
+ * application of operator and preconditioner. Norm of the new basis vector is taken from the
+ * Pythagorean identity; on cancellation it is recalculated explicitly with blocking reduction.
+ * Residual estimate lags one operator application behind the usual gmres.
+ * Template parameters demands are the same as for gmres, VectorOperations must additionally
+ * provide multi_add_lin_comb and nonblocking reductions.
+ **/
+
+template
+<
+     class VectorOperations, class Monitor, class Log,
+     class LinearOperator, class Preconditioner = preconditioners::dummy<VectorOperations,LinearOperator>,
+     class ResidualRegulariation = detail::residual_regularization_dummy,
+     class DenseOperations = detail::dense_operations<typename VectorOperations::Ord, typename VectorOperations::scalar_type>
+>
+class pipelined_gmres : public iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, Preconditioner>
+{
+    using parent_t = iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, Preconditioner>;
+    using logged_obj_t = typename parent_t::logged_obj_t;
+    using logged_obj_params_t = typename parent_t::logged_obj_params_t;
+
+public:
+    using scalar_type =  typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using linear_operator_type =  LinearOperator;
+    using preconditioner_type = Preconditioner;
+    using vector_operations_type = VectorOperations;
+    using dense_operations_t = DenseOperations;
+    using monitor_type = Monitor;
+    using log_type = Log;
+    using residual_regulaization_t = ResidualRegulariation;
+
+
+    struct params : public logged_obj_params_t
+    {
+        unsigned basis_size; //size of the krylov basis
+        unsigned batch_size; //residual estimate is logged each batch_size iterations
+        char preconditioner_side; //can be L for left and R for right
+        typename Monitor::params monitor;
+
+        params(const std::string &log_prefix = "", const std::string &log_name = "pipelined_gmres::") :
+            logged_obj_params_t(0, log_prefix+log_name),
+            basis_size(20),
+            batch_size(5),
+            preconditioner_side('R'),
+            monitor( typename Monitor::params(this->log_msg_prefix) )
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            basis_size = j.value("basis_size", basis_size);
+            batch_size = j.value("batch_size", batch_size);
+            preconditioner_side = j.value("preconditioner_side", preconditioner_side);
+            monitor.from_json(j.at("monitor"));
+        }
+        nlohmann::json to_json() const
+        {
+            return
+                nlohmann::json
+                {
+                    {"type", "pipelined_gmres"},
+                    {"basis_size", basis_size},
+                    {"batch_size", batch_size},
+                    {"preconditioner_side", preconditioner_side},
+                    {"monitor", monitor.to_json()}
+                };
+        }
+        #endif
+    };
+    using utils = detail::krylov_utils<vector_operations_type, Log, residual_regulaization_t, dense_operations_t>;
+    using params_hierarchy = detail::krylov_params_hierarchy<params, Preconditioner>;
+    using utils_hierarchy = detail::krylov_utils_hierarchy<utils, Preconditioner>;
+
+private:
+    using T = scalar_type;
+    using T_vec = vector_type;
+    using T_mvec = multivector_type;
+
+    using D_vec = typename dense_operations_t::vector_type;
+    using D_mat = typename dense_operations_t::matrix_type;
+
+    using monitor_call_wrap_t = detail::monitor_call_wrap<VectorOperations, Monitor>;
+
+    //V_ is orthonormal basis, Z_(j) = K*V_(j) (i.e. z_{j+1} in usual p(l)-GMRES notation)
+    mutable T_mvec V_;
+    mutable T_mvec Z_;
+    mutable T_vec r_;
+    mutable T_vec y_;
+    mutable T_vec z_;
+    mutable T_vec w_;
+    mutable T_vec x_tmp_;
+
+    //parameters:
+    params prms_;
+    int m_;
+
+    //host dense operations vectors and matrices
+    mutable D_mat H_;
+    mutable D_vec s_h_;
+    //host buffers for reductions results and combination coefficients
+    mutable std::vector<T> h_col_, h_corr_;
+    mutable detail::givens_least_squares<dense_operations_t> lsq_;
+
+
+    void calc_left_preconditioned_residual(const linear_operator_type &A, const T_vec &x, const T_vec &b, T_vec &r)const
+    {
+        detail::calc_left_preconditioned_residual(*vec_ops_, A, prec_.get(), prms_.preconditioner_side, x, b, r);
+    }
+
+    void calc_right_precond_solution(T_vec &x) const
+    {
+        detail::apply_right_preconditioner(prec_.get(), prms_.preconditioner_side, x);
+    }
+
+    void init_host()
+    {
+        dense_ops_->init_matrix(H_);
+        dense_ops_->init_col_vector(s_h_);
+        lsq_.init(dense_ops_);
+    }
+
+    void free_host_()
+    {
+        dense_ops_->free_matrix(H_);
+        dense_ops_->free_col_vector(s_h_);
+        lsq_.free();
+    }
+
+    void init_all() const
+    {
+        vec_ops_->init_vector( r_ );
+        vec_ops_->init_vector( y_ );
+        vec_ops_->init_vector( z_ );
+        vec_ops_->init_vector( w_ );
+        vec_ops_->init_vector( x_tmp_ );
+        vec_ops_->init_multivector( V_, m_+1 );
+        vec_ops_->init_multivector( Z_, m_ );
+    }
+    void start_use_all() const
+    {
+        vec_ops_->start_use_vector( r_ );
+        vec_ops_->start_use_vector( y_ );
+        vec_ops_->start_use_vector( z_ );
+        vec_ops_->start_use_vector( w_ );
+        vec_ops_->start_use_vector( x_tmp_ );
+        vec_ops_->start_use_multivector( V_, m_+1 );
+        vec_ops_->start_use_multivector( Z_, m_ );
+    }
+    void stop_use_all() const
+    {
+        vec_ops_->stop_use_vector( r_ );
+        vec_ops_->stop_use_vector( y_ );
+        vec_ops_->stop_use_vector( z_ );
+        vec_ops_->stop_use_vector( w_ );
+        vec_ops_->stop_use_vector( x_tmp_ );
+        vec_ops_->stop_use_multivector( V_, m_+1 );
+        vec_ops_->stop_use_multivector( Z_, m_ );
+    }
+    void free_all() const
+    {
+        vec_ops_->free_vector( r_ );
+        vec_ops_->free_vector( y_ );
+        vec_ops_->free_vector( z_ );
+        vec_ops_->free_vector( w_ );
+        vec_ops_->free_vector( x_tmp_ );
+        vec_ops_->free_multivector( V_, m_+1 );
+        vec_ops_->free_multivector( Z_, m_ );
+    }
+
+    //constructs solution of the linear system
+    void construct_solution(const int i, const D_vec& s, T_vec& x) const
+    {
+        vec_ops_->assign_scalar(0, x);
+        for (int j = 0; j <= i; j++)
+        {
+            vec_ops_->add_lin_comb(s(j), V_, m_+1, j, static_cast<T>(1), x);
+        }
+    }
+
+    void update_solution(const linear_operator_type &A, const int i, const T_vec &b, T_vec &x) const
+    {
+        lsq_.solve(s_h_);
+        construct_solution(i, s_h_, y_);
+        calc_right_precond_solution(y_);
+        residual_reg_->apply(y_);
+        vec_ops_->add_lin_comb(static_cast<T>(1), y_, static_cast<T>(1), x);
+        calc_left_preconditioned_residual(A, x, b, r_);
+        residual_reg_->apply(r_);
+    }
+
+protected:
+    using parent_t::monitor_;
+    using parent_t::vec_ops_;
+    using parent_t::prec_;
+    std::shared_ptr<dense_operations_t> dense_ops_;
+    std::shared_ptr<residual_regulaization_t> residual_reg_;
+
+public:
+    ~pipelined_gmres()
+    {
+        free_host_();
+        free_all();
+    }
+
+    pipelined_gmres(
+        std::shared_ptr<vector_operations_type> vec_ops,
+        Log *log = nullptr,
+        const params& prm = params(),
+        std::shared_ptr<preconditioner_type> prec = nullptr,
+        std::shared_ptr<residual_regulaization_t> residual_reg = std::make_shared<residual_regulaization_t>(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        parent_t(std::move(vec_ops), log, prm, prm.monitor, std::move(prec) ),
+        prms_(prm),
+        m_(prm.basis_size),
+        dense_ops_(std::move(dense_ops)),
+        residual_reg_(std::move(residual_reg))
+    {
+        h_col_.resize(prm.basis_size+1);
+        h_corr_.resize(prm.basis_size+1);
+        dense_ops_->init(prm.basis_size+1, prm.basis_size);
+        init_host();
+        init_all();
+    }
+    pipelined_gmres(
+        std::shared_ptr<const linear_operator_type> A,
+        std::shared_ptr<vector_operations_type> vec_ops,
+        Log *log = nullptr,
+        const params& prm = params(),
+        std::shared_ptr<preconditioner_type> prec = nullptr,
+        std::shared_ptr<residual_regulaization_t> residual_reg = std::make_shared<residual_regulaization_t>(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        pipelined_gmres(std::move(vec_ops),log,prm,std::move(prec),std::move(residual_reg),std::move(dense_ops))
+    {
+        parent_t::set_operator(std::move(A));
+    }
+
+    pipelined_gmres(
+        const utils_hierarchy& utils,
+        const params_hierarchy& prm = params_hierarchy()
+    ) :
+        pipelined_gmres(
+            utils.vec_ops, utils.log, prm,
+            nmfd::detail::algo_hierarchy_creator<preconditioner_type>::get(utils.preconditioner,prm.preconditioner),
+            utils.residual_reg, utils.dense_ops
+        )
+    {
+    }
+
+    const std::shared_ptr<preconditioner_type> &preconditioner()const
+    {
+        return prec_;
+    }
+
+    virtual bool solve(const linear_operator_type &A, const T_vec &b, T_vec &x)const
+    {
+        start_use_all();
+        monitor_call_wrap_t monitor_wrap(monitor_);
+
+        if ((prec_ != nullptr)&&(prms_.preconditioner_side == 'L'))
+        {
+            vec_ops_->assign(b, r_);
+            prec_->apply(r_);
+            residual_reg_->apply(r_);
+            monitor_wrap.start(r_);
+        }
+        else
+        {
+            monitor_wrap.start(b);
+        }
+
+        calc_left_preconditioned_residual(A, x, b, r_);
+        residual_reg_->apply(r_);
+        bool converged_by_checked_ritz_norm = false;
+        std::size_t total_iterations = 0;
+        //below this ratio Pythagorean norm of the new basis vector is considered to be spoiled by cancellation
+        const T pythagorean_tol = std::sqrt(std::numeric_limits<T>::epsilon());
+
+        if( !monitor_.check_finished(x, r_) )
+        {
+            do
+            {
+                dense_ops_->assign_scalar_matrix(0, H_);
+                T beta = vec_ops_->norm(r_);
+                vec_ops_->scale(static_cast<T>(1)/beta, r_);
+                vec_ops_->assign(r_, V_, m_+1, 0);
+                lsq_.reset(beta); // s(:) = beta*e_0
+
+                //pipeline startup: Z(0) = K*V(0)
+                vec_ops_->assign(r_, y_);
+                detail::calc_krylov_vector(A, prec_.get(), prms_.preconditioner_side, residual_reg_.get(), y_, z_);
+                vec_ops_->assign(z_, Z_, m_, 0);
+
+                int i = 0;
+                while(true)
+                {
+                    //on entry z_ = Z(i) = K*V(i), V(0:i) are known, column i of H is to be found
+                    T zz;
+                    auto h_proj = vec_ops_->multi_scalar_prod_async(V_, m_+1, 0, i+1, z_, h_col_.data());
+                    auto h_norm = vec_ops_->scalar_prod_async(z_, z_, &zz);
+                    //overlapped with reductions: w_ = K*Z(i)
+                    if(i+1 < m_)
+                    {
+                        vec_ops_->assign(z_, y_);
+                        detail::calc_krylov_vector(A, prec_.get(), prms_.preconditioner_side, residual_reg_.get(), y_, w_);
+                    }
+                    h_proj.wait();
+                    h_norm.wait();
+
+                    T proj_sq = static_cast<T>(0);
+                    for(int k = 0; k <= i; k++)
+                    {
+                        H_(k, i) = h_col_[k];
+                        h_corr_[k] = -h_col_[k];
+                        proj_sq += h_col_[k]*h_col_[k];
+                    }
+                    //V(i+1) = (Z(i) - V(0:i)*H(0:i,i))/H(i+1,i)
+                    vec_ops_->assign(z_, r_);
+                    vec_ops_->multi_add_lin_comb(h_corr_.data(), V_, m_+1, 0, i+1, static_cast<T>(1), r_);
+                    T h_ip;
+                    if(zz - proj_sq > pythagorean_tol*zz)
+                    {
+                        h_ip = std::sqrt(zz - proj_sq);
+                    }
+                    else
+                    {
+                        h_ip = vec_ops_->norm(r_);
+                        logged_obj_t::info_f("Pythagorean norm cancellation at iteration %i, explicit norm is used", i);
+                    }
+                    H_(i+1, i) = h_ip;
+                    vec_ops_->scale(static_cast<T>(1)/h_ip, r_);
+                    vec_ops_->assign(r_, V_, m_+1, i+1);
+                    //Z(i+1) = K*V(i+1) = (K*Z(i) - Z(0:i)*H(0:i,i))/H(i+1,i)
+                    if(i+1 < m_)
+                    {
+                        vec_ops_->multi_add_lin_comb(h_corr_.data(), Z_, m_, 0, i+1, static_cast<T>(1), w_);
+                        vec_ops_->assign_lin_comb(static_cast<T>(1)/h_ip, w_, z_);
+                        vec_ops_->assign(z_, Z_, m_, i+1);
+                    }
+
+                    ++monitor_;
+                    T resid_estimate = lsq_.add_column(H_, i, i+2); //QR via Givens rotations
+                    total_iterations++;
+                    if((total_iterations%prms_.batch_size == 0)||(i+1 == m_))
+                    {
+                        logged_obj_t::info_f("iter = %i(%i), resid_estimate = %e", static_cast<int>(total_iterations), i+1, monitor_.norm_out(resid_estimate) );
+                    }
+
+                    if ( monitor_.check_finished_by_ritz_estimate(resid_estimate) )
+                    {
+                        vec_ops_->assign(x, x_tmp_);
+                        update_solution(A, i, b, x);
+                        if (monitor_.check_finished(x, r_))
+                        {
+                            converged_by_checked_ritz_norm = true;
+                            break;
+                        }
+                        else
+                        {
+                            vec_ops_->assign(x_tmp_, x);
+                        }
+                    }
+                    if(i+1 == m_)
+                    {
+                        update_solution(A, i, b, x);
+                        break;
+                    }
+                    ++i;
+                }
+            }
+            while(!converged_by_checked_ritz_norm && !monitor_.check_finished(x, r_) );
+        }
+
+        bool res = monitor_.converged();
+        if(!res)
+            logged_obj_t::error_f("solve: linear solver failed to converge");
+
+        stop_use_all();
+
+        return res;
+    }
+
+    bool solve(const vector_type &b, vector_type &x)const
+    {
+        return solve(*parent_t::A_, b, x);
+    }
+};
+
+}
+}
+
+#endif //__NMFD_PIPELINED_GMRES_H__
@@ -0,0 +1,703 @@
+// Copyright © 2020-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_S_STEP_GMRES_H__
+#define __NMFD_S_STEP_GMRES_H__
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <cmath>
+#include <limits>
+#ifdef NMFD_ENABLE_NLOHMANN
+#include <nlohmann/json.hpp>
+#endif
+#include "detail/monitor_call_wrap.h"
+#include <nmfd/detail/algo_utils_hierarchy.h>
+#include <nmfd/detail/algo_params_hierarchy.h>
+#include <nmfd/detail/algo_hierarchy_creator.h>
+#include "iter_solver_base.h"
+#include "detail/dense_operations.h"
+#include "detail/fused_vector_ops.h"
+#include "detail/givens_least_squares.h"
+#include "detail/krylov_hierarchy.h"
+#include "detail/preconditioned_operator.h"
+#include "detail/residual_regularization_dummy.h"
+#include <nmfd/preconditioners/dummy.h>
+
+namespace nmfd
+{
+namespace solvers
+{
+
+/**
+ * Communication avoiding (s-step) variant of restarted GMRES.
+ * Krylov basis is built by blocks of s vectors: first s vectors are generated with
+ * monomial or Newton polynomial basis (matrix powers without any inner products), then
+ * the whole block is orthogonalized against the previous basis and inside itself
+ * at once (block classical Gram-Schmidt + Cholesky QR): all inner products of the orthogonalization
+ * pass [V(0:j0) W]^T*W are taken by one block reduction (multivector-multivector multi_scalar_prod
+ * of VectorOperations, if present), so the number of global reductions per block (one norm plus
+ * one per pass) does not depend on the block size. VectorOperations without block product fall back
+ * to one reduction per block column. Hessenberg matrix is recovered from the
+ * change of basis matrix. If Cholesky QR fails (block is numerically rank deficient) the block
+ * is rebuilt with usual Arnoldi process.
+ * Newton basis shifts are Leja ordered Ritz values taken from the first s Arnoldi steps of each solve.
+ * Template parameters demands are the same as for gmres.
+ **/
+
+template
+<
+     class VectorOperations, class Monitor, class Log,
+     class LinearOperator, class Preconditioner = preconditioners::dummy<VectorOperations,LinearOperator>,
+     class ResidualRegulariation = detail::residual_regularization_dummy,
+     class DenseOperations = detail::dense_operations<typename VectorOperations::Ord, typename VectorOperations::scalar_type>
+>
+class s_step_gmres : public iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, Preconditioner>
+{
+    using parent_t = iter_solver_base<VectorOperations, Monitor, Log, LinearOperator, Preconditioner>;
+    using logged_obj_t = typename parent_t::logged_obj_t;
+    using logged_obj_params_t = typename parent_t::logged_obj_params_t;
+
+public:
+    using scalar_type =  typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+    using multivector_type = typename VectorOperations::multivector_type;
+    using linear_operator_type =  LinearOperator;
+    using preconditioner_type = Preconditioner;
+    using vector_operations_type = VectorOperations;
+    using dense_operations_t = DenseOperations;
+    using monitor_type = Monitor;
+    using log_type = Log;
+    using residual_regulaization_t = ResidualRegulariation;
+
+
+    struct params : public logged_obj_params_t
+    {
+        unsigned basis_size; //size of the krylov basis
+        unsigned s; //number of basis vectors built and orthogonalized as one block
+        std::string basis_type; //"monomial" or "newton"
+        char preconditioner_side; //can be L for left and R for right
+        bool reorthogonalization; //apply second block orthogonalization pass (BCGS2)
+        typename Monitor::params monitor;
+
+        params(const std::string &log_prefix = "", const std::string &log_name = "s_step_gmres::") :
+            logged_obj_params_t(0, log_prefix+log_name),
+            basis_size(20),
+            s(5),
+            basis_type("newton"),
+            preconditioner_side('R'),
+            reorthogonalization(true),
+            monitor( typename Monitor::params(this->log_msg_prefix) )
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            basis_size = j.value("basis_size", basis_size);
+            s = j.value("s", s);
+            basis_type = j.value("basis_type", basis_type);
+            preconditioner_side = j.value("preconditioner_side", preconditioner_side);
+            reorthogonalization = j.value("reorthogonalization", reorthogonalization);
+            monitor.from_json(j.at("monitor"));
+        }
+        nlohmann::json to_json() const
+        {
+            return
+                nlohmann::json
+                {
+                    {"type", "s_step_gmres"},
+                    {"basis_size", basis_size},
+                    {"s", s},
+                    {"basis_type", basis_type},
+                    {"preconditioner_side", preconditioner_side},
+                    {"reorthogonalization", reorthogonalization},
+                    {"monitor", monitor.to_json()}
+                };
+        }
+        #endif
+    };
+    using utils = detail::krylov_utils<vector_operations_type, Log, residual_regulaization_t, dense_operations_t>;
+    using params_hierarchy = detail::krylov_params_hierarchy<params, Preconditioner>;
+    using utils_hierarchy = detail::krylov_utils_hierarchy<utils, Preconditioner>;
+
+private:
+    using T = scalar_type;
+    using T_vec = vector_type;
+    using T_mvec = multivector_type;
+
+    using D_vec = typename dense_operations_t::vector_type;
+    using D_mat = typename dense_operations_t::matrix_type;
+
+    using monitor_call_wrap_t = detail::monitor_call_wrap<VectorOperations, Monitor>;
+
+    mutable T_mvec V_;
+    mutable T_vec r_;
+    mutable T_vec y_;
+    mutable T_vec x_tmp_;
+
+    //parameters:
+    params prms_;
+    int m_, s_max_;
+    bool use_newton_basis_;
+
+    //host dense operations vectors and matrices
+    //H_raw_ is Hessenberg matrix itself, its QR factorization is kept by lsq_
+    mutable D_mat H_raw_;
+    //P_ is block projection coefficients onto previous basis and then change of basis matrix Rb,
+    //G_ is Gram matrix of the new block and then its Cholesky factor, B_ is basis recurrence matrix
+    mutable D_mat P_, P2_, G_, G2_, B_, M_, W_;
+    mutable D_vec s_h_;
+    mutable D_vec shifts_, wr_, wi_;
+    mutable bool shifts_ready_;
+    //host buffer for batched inner products and combination coefficients
+    mutable std::vector<T> orth_coeffs_;
+    //host buffer for block Gram product [V(0:j0) W]^T*W, column-major with leading dimension j0+sb+1
+    mutable std::vector<T> gram_;
+    mutable detail::givens_least_squares<dense_operations_t> lsq_;
+
+
+    void calc_left_preconditioned_residual(const linear_operator_type &A, const T_vec &x, const T_vec &b, T_vec &r)const
+    {
+        detail::calc_left_preconditioned_residual(*vec_ops_, A, prec_.get(), prms_.preconditioner_side, x, b, r);
+    }
+
+    void calc_right_precond_solution(T_vec &x) const
+    {
+        detail::apply_right_preconditioner(prec_.get(), prms_.preconditioner_side, x);
+    }
+
+    void init_host()
+    {
+        dense_ops_->init_matrices(H_raw_, P_, P2_, G_, G2_, B_, M_, W_);
+        dense_ops_->init_col_vectors(s_h_, shifts_, wr_, wi_);
+        lsq_.init(dense_ops_);
+    }
+
+    void free_host_()
+    {
+        dense_ops_->free_matrices(H_raw_, P_, P2_, G_, G2_, B_, M_, W_);
+        dense_ops_->free_col_vectors(s_h_, shifts_, wr_, wi_);
+        lsq_.free();
+    }
+
+    void init_all() const
+    {
+        vec_ops_->init_vector( r_ );
+        vec_ops_->init_vector( y_ );
+        vec_ops_->init_vector( x_tmp_ );
+        vec_ops_->init_multivector( V_, m_+1);
+    }
+    void start_use_all() const
+    {
+        vec_ops_->start_use_vector( r_ );
+        vec_ops_->start_use_vector( y_ );
+        vec_ops_->start_use_vector( x_tmp_ );
+        vec_ops_->start_use_multivector( V_, m_+1 );
+    }
+    void stop_use_all() const
+    {
+        vec_ops_->stop_use_vector( r_ );
+        vec_ops_->stop_use_vector( y_ );
+        vec_ops_->stop_use_vector( x_tmp_ );
+        vec_ops_->stop_use_multivector( V_, m_+1 );
+    }
+    void free_all() const
+    {
+        vec_ops_->free_vector( r_ );
+        vec_ops_->free_vector( y_ );
+        vec_ops_->free_vector( x_tmp_ );
+        vec_ops_->free_multivector( V_, m_+1 );
+    }
+
+    /// usual Arnoldi step with modified Gram-Schmidt: V(i) -> V(i+1), fills H_raw_ column i
+    void arnoldi_step(const linear_operator_type &A, const int i) const
+    {
+        vec_ops_->assign(V_, m_+1, i, y_);
+        detail::calc_krylov_vector(A, prec_.get(), prms_.preconditioner_side, residual_reg_.get(), y_, r_);
+        for(int k = 0; k <= i; k++)
+        {
+            T alpha = vec_ops_->scalar_prod(V_, m_+1, k, r_);
+            vec_ops_->add_lin_comb(-alpha, V_, m_+1, k, static_cast<T>(1), r_);
+            if(prms_.reorthogonalization)
+            {
+                T c = vec_ops_->scalar_prod(V_, m_+1, k, r_);
+                vec_ops_->add_lin_comb(-c, V_, m_+1, k, static_cast<T>(1), r_);
+                alpha += c;
+            }
+            H_raw_(k, i) = alpha;
+        }
+        T h_ip = vec_ops_->norm(r_);
+        H_raw_(i+1, i) = h_ip;
+        vec_ops_->scale(static_cast<T>(1)/h_ip, r_);
+        vec_ops_->assign(r_, V_, m_+1, i+1);
+    }
+
+    /// Leja ordered real parts of the Ritz values of the leading sb x sb block of H_raw_
+    void calc_newton_shifts(const int sb) const
+    {
+        if(!dense_ops_->hessenberg_eigenvalues(H_raw_, sb, W_, wr_, wi_))
+        {
+            logged_obj_t::warning_f("failed to calculate Ritz values for Newton basis, monomial basis is used");
+            for(int k = 0; k < s_max_; k++) shifts_(k) = static_cast<T>(0);
+            return;
+        }
+        std::vector<bool> used(sb, false);
+        for(int k = 0; k < s_max_; k++)
+        {
+            if(k >= sb)
+            {
+                shifts_(k) = shifts_(k % sb);
+                continue;
+            }
+            int best = -1;
+            T best_val = -std::numeric_limits<T>::max();
+            for(int l = 0; l < sb; l++)
+            {
+                if(used[l]) continue;
+                T val;
+                if(k == 0)
+                {
+                    val = std::abs(wr_(l));
+                }
+                else
+                {
+                    //log of the product is used to avoid overflow
+                    val = static_cast<T>(0);
+                    for(int q = 0; q < k; q++)
+                    {
+                        val += std::log(std::abs(wr_(l) - shifts_(q)) + std::numeric_limits<T>::min());
+                    }
+                }
+                if(val > best_val)
+                {
+                    best_val = val;
+                    best = l;
+                }
+            }
+            used[best] = true;
+            shifts_(k) = wr_(best);
+        }
+    }
+
+    /// block orthogonalization pass of V(j0+1:j0+sb) against V(0:j0) and inside itself (CGS + Cholesky QR)
+    /// P(0:j0,1:sb) gets projection coeffs, G(1:sb,1:sb) (shifted by one in both indices) gets Cholesky factor
+    /// all inner products of the pass are independent, so they are taken by one block reduction before any update
+    bool block_orth_pass(const int j0, const int sb, D_mat &P, D_mat &G) const
+    {
+        const int ld = j0+sb+1;
+        detail::fused_block_scalar_prod<vector_operations_type>::apply(
+            *vec_ops_, V_, m_+1, 0, ld, V_, m_+1, j0+1, j0+sb+1, gram_.data(), r_
+        );
+        for(int i = 1; i <= sb; i++)
+        {
+            for(int l = 0; l <= j0+i; l++)
+            {
+                if(l <= j0)
+                    P(l, i) = gram_[(i-1)*ld + l];
+                else
+                    G(l-j0-1, i-1) = gram_[(i-1)*ld + l];
+            }
+        }
+        // G := W^T*W - P^T*P (Pythagorean correction for the projected block)
+        for(int i = 1; i <= sb; i++)
+        {
+            for(int k = i; k <= sb; k++)
+            {
+                T corr = static_cast<T>(0);
+                for(int l = 0; l <= j0; l++)
+                {
+                    corr += P(l, i)*P(l, k);
+                }
+                G(i-1, k-1) -= corr;
+            }
+        }
+        if(!dense_ops_->cholesky_upper(G, sb))
+        {
+            return false;
+        }
+        for(int i = 1; i <= sb; i++)
+        {
+            vec_ops_->assign(V_, m_+1, j0+i, r_);
+            for(int l = 0; l <= j0; l++)
+            {
+                orth_coeffs_[l] = -P(l, i);
+            }
+            for(int t = 1; t < i; t++)
+            {
+                orth_coeffs_[j0+t] = -G(t-1, i-1);
+            }
+            vec_ops_->multi_add_lin_comb(orth_coeffs_.data(), V_, m_+1, 0, j0+i, static_cast<T>(1), r_);
+            vec_ops_->scale(static_cast<T>(1)/G(i-1, i-1), r_);
+            vec_ops_->assign(r_, V_, m_+1, j0+i);
+        }
+        return true;
+    }
+
+    /// builds V(j0+1:j0+sb) and H_raw_ columns j0:j0+sb-1 using s-step block; returns false on breakdown
+    /// in which case V(0:j0) and H_raw_ columns before j0 are left untouched
+    bool block_step(const linear_operator_type &A, const int j0, const int sb) const
+    {
+        //matrix powers: w_i = (K - theta_{i-1}*I)*w_{i-1}/sigma, w_0 = V(j0)
+        T sigma = static_cast<T>(1);
+        vec_ops_->assign(V_, m_+1, j0, r_);
+        for(int i = 1; i <= sb; i++)
+        {
+            T theta = (use_newton_basis_ ? static_cast<T>(shifts_(i-1)) : static_cast<T>(0));
+            vec_ops_->assign(r_, y_);
+            detail::calc_krylov_vector(A, prec_.get(), prms_.preconditioner_side, residual_reg_.get(), y_, r_);
+            if(theta != static_cast<T>(0))
+            {
+                vec_ops_->add_lin_comb(-theta, V_, m_+1, j0+i-1, static_cast<T>(1), r_);
+            }
+            if(i == 1)
+            {
+                sigma = vec_ops_->norm(r_);
+                if(!(sigma > static_cast<T>(0)) || !std::isfinite(sigma))
+                {
+                    return false;
+                }
+            }
+            vec_ops_->scale(static_cast<T>(1)/sigma, r_);
+            vec_ops_->assign(r_, V_, m_+1, j0+i);
+        }
+        for(int i = 0; i <= sb; i++)
+        {
+            for(int k = 0; k < sb; k++)
+            {
+                B_(i, k) = static_cast<T>(0);
+            }
+        }
+        for(int k = 0; k < sb; k++)
+        {
+            B_(k, k) = (use_newton_basis_ ? static_cast<T>(shifts_(k)) : static_cast<T>(0));
+            B_(k+1, k) = sigma;
+        }
+
+        //block orthogonalization: W = V(0:j0)*P + Q*G
+        if(!block_orth_pass(j0, sb, P_, G_))
+        {
+            return false;
+        }
+        if(prms_.reorthogonalization)
+        {
+            //W = V(0:j0)*(P + P2*G) + Q2*(G2*G)
+            if(!block_orth_pass(j0, sb, P2_, G2_))
+            {
+                return false;
+            }
+            for(int l = 0; l <= j0; l++)
+            {
+                for(int i = sb; i >= 1; i--)
+                {
+                    T v = P_(l, i);
+                    for(int t = 1; t <= i; t++)
+                    {
+                        v += P2_(l, t)*G_(t-1, i-1);
+                    }
+                    P_(l, i) = v;
+                }
+            }
+            for(int i = sb; i >= 1; i--)
+            {
+                for(int t = 1; t <= i; t++)
+                {
+                    T v = static_cast<T>(0);
+                    for(int q = t; q <= i; q++)
+                    {
+                        v += G2_(t-1, q-1)*G_(q-1, i-1);
+                    }
+                    M_(t-1, i-1) = v;
+                }
+            }
+            for(int i = 1; i <= sb; i++)
+            {
+                for(int t = 1; t <= i; t++)
+                {
+                    G_(t-1, i-1) = M_(t-1, i-1);
+                }
+            }
+        }
+
+        //change of basis matrix Rb: [w_0..w_sb] = V(0:j0+sb)*Rb, stored in P_
+        for(int l = 0; l <= j0+sb; l++)
+        {
+            P_(l, 0) = (l == j0 ? static_cast<T>(1) : static_cast<T>(0));
+        }
+        for(int i = 1; i <= sb; i++)
+        {
+            for(int t = 1; t <= sb; t++)
+            {
+                P_(j0+t, i) = (t <= i ? static_cast<T>(G_(t-1, i-1)) : static_cast<T>(0));
+            }
+        }
+
+        //H(:,j0:j0+sb-1) = (Rb*B - [H_prev*Rb(0:j0-1,0:sb-1); 0])*Rb(j0:j0+sb-1,0:sb-1)^{-1}
+        for(int l = 0; l <= j0+sb; l++)
+        {
+            for(int k = 0; k < sb; k++)
+            {
+                T v = P_(l, k)*B_(k, k) + P_(l, k+1)*B_(k+1, k);
+                if(l <= j0)
+                {
+                    for(int q = (l > 0 ? l-1 : 0); q < j0; q++)
+                    {
+                        v -= H_raw_(l, q)*P_(q, k);
+                    }
+                }
+                M_(l, k) = v;
+            }
+        }
+        for(int k = 0; k < sb; k++)
+        {
+            for(int l = 0; l <= j0+sb; l++)
+            {
+                T v = M_(l, k);
+                for(int a = 0; a < k; a++)
+                {
+                    v -= H_raw_(l, j0+a)*P_(j0+a, k);
+                }
+                H_raw_(l, j0+k) = v/P_(j0+k, k);
+            }
+        }
+        for(int k = 0; k < sb; k++)
+        {
+            for(int l = j0+k+2; l <= m_; l++)
+            {
+                H_raw_(l, j0+k) = static_cast<T>(0);
+            }
+        }
+        return true;
+    }
+
+    //constructs solution of the linear system
+    void construct_solution(const int i, const D_vec& s, T_vec& x) const
+    {
+        vec_ops_->assign_scalar(0, x);
+        for (int j = 0; j <= i; j++)
+        {
+            vec_ops_->add_lin_comb(s(j), V_, m_+1, j, static_cast<T>(1), x);
+        }
+    }
+
+    void update_solution(const linear_operator_type &A, const int i, const T_vec &b, T_vec &x) const
+    {
+        lsq_.solve(s_h_);
+        construct_solution(i, s_h_, y_);
+        calc_right_precond_solution(y_);
+        residual_reg_->apply(y_);
+        vec_ops_->add_lin_comb(static_cast<T>(1), y_, static_cast<T>(1), x);
+        calc_left_preconditioned_residual(A, x, b, r_);
+        residual_reg_->apply(r_);
+    }
+
+protected:
+    using parent_t::monitor_;
+    using parent_t::vec_ops_;
+    using parent_t::prec_;
+    std::shared_ptr<dense_operations_t> dense_ops_;
+    std::shared_ptr<residual_regulaization_t> residual_reg_;
+
+public:
+    ~s_step_gmres()
+    {
+        free_host_();
+        free_all();
+    }
+
+    s_step_gmres(
+        std::shared_ptr<vector_operations_type> vec_ops,
+        Log *log = nullptr,
+        const params& prm = params(),
+        std::shared_ptr<preconditioner_type> prec = nullptr,
+        std::shared_ptr<residual_regulaization_t> residual_reg = std::make_shared<residual_regulaization_t>(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        parent_t(std::move(vec_ops), log, prm, prm.monitor, std::move(prec) ),
+        prms_(prm),
+        m_(prm.basis_size),
+        s_max_(prm.s),
+        dense_ops_(std::move(dense_ops)),
+        residual_reg_(std::move(residual_reg))
+    {
+        if((prm.s == 0)||(prm.s >= prm.basis_size))
+        {
+            throw std::logic_error("s_step_gmres: s must satisfy 0 < s < basis_size");
+        }
+        if(prm.basis_type == "newton")
+        {
+            use_newton_basis_ = true;
+        }
+        else if(prm.basis_type == "monomial")
+        {
+            use_newton_basis_ = false;
+        }
+        else
+        {
+            throw std::logic_error("s_step_gmres: unknown basis_type " + prm.basis_type);
+        }
+        shifts_ready_ = !use_newton_basis_;
+        orth_coeffs_.resize(prm.basis_size+1);
+        gram_.resize((prm.basis_size+1)*prm.s);
+        dense_ops_->init(prm.basis_size+1, prm.basis_size);
+        init_host();
+        init_all();
+    }
+    s_step_gmres(
+        std::shared_ptr<const linear_operator_type> A,
+        std::shared_ptr<vector_operations_type> vec_ops,
+        Log *log = nullptr,
+        const params& prm = params(),
+        std::shared_ptr<preconditioner_type> prec = nullptr,
+        std::shared_ptr<residual_regulaization_t> residual_reg = std::make_shared<residual_regulaization_t>(),
+        std::shared_ptr<dense_operations_t> dense_ops = std::make_shared<dense_operations_t>()
+    ) :
+        s_step_gmres(std::move(vec_ops),log,prm,std::move(prec),std::move(residual_reg),std::move(dense_ops))
+    {
+        parent_t::set_operator(std::move(A));
+    }
+
+    s_step_gmres(
+        const utils_hierarchy& utils,
+        const params_hierarchy& prm = params_hierarchy()
+    ) :
+        s_step_gmres(
+            utils.vec_ops, utils.log, prm,
+            nmfd::detail::algo_hierarchy_creator<preconditioner_type>::get(utils.preconditioner,prm.preconditioner),
+            utils.residual_reg, utils.dense_ops
+        )
+    {
+    }
+
+    const std::shared_ptr<preconditioner_type> &preconditioner()const
+    {
+        return prec_;
+    }
+
+    virtual bool solve(const linear_operator_type &A, const T_vec &b, T_vec &x)const
+    {
+        start_use_all();
+        monitor_call_wrap_t monitor_wrap(monitor_);
+
+        if ((prec_ != nullptr)&&(prms_.preconditioner_side == 'L'))
+        {
+            vec_ops_->assign(b, r_);
+            prec_->apply(r_);
+            residual_reg_->apply(r_);
+            monitor_wrap.start(r_);
+        }
+        else
+        {
+            monitor_wrap.start(b);
+        }
+
+        //shifts are recalculated on each solve because operator may change
+        shifts_ready_ = !use_newton_basis_;
+
+        calc_left_preconditioned_residual(A, x, b, r_);
+        residual_reg_->apply(r_);
+        bool converged_by_checked_ritz_norm = false;
+        std::size_t total_iterations = 0;
+
+        if( !monitor_.check_finished(x, r_) )
+        {
+            do
+            {
+                dense_ops_->assign_scalar_matrix(0, H_raw_);
+                T beta = vec_ops_->norm(r_);
+                vec_ops_->scale(static_cast<T>(1)/beta, r_);
+                vec_ops_->assign(r_, V_, m_+1, 0);
+                lsq_.reset(beta); // s(:) = beta*e_0
+
+                int i = -1, j0 = 0;
+                while( (j0 < m_)&&(!converged_by_checked_ritz_norm) )
+                {
+                    int sb = std::min(s_max_, m_ - j0);
+                    bool block_done = false;
+                    if(shifts_ready_)
+                    {
+                        block_done = block_step(A, j0, sb);
+                        if(!block_done)
+                        {
+                            logged_obj_t::info_f("s-step block at %i failed, falling back to Arnoldi", j0);
+                        }
+                    }
+                    if(!block_done)
+                    {
+                        for(int k = 0; k < sb; k++)
+                        {
+                            arnoldi_step(A, j0+k);
+                        }
+                        if(!shifts_ready_)
+                        {
+                            calc_newton_shifts(sb);
+                            shifts_ready_ = true;
+                        }
+                    }
+
+                    for(int k = 0; k < sb; k++)
+                    {
+                        ++i;
+                        ++monitor_;
+                        T resid_estimate = lsq_.add_column(H_raw_, i, i+2); //QR via Givens rotations
+                        total_iterations++;
+
+                        if ( monitor_.check_finished_by_ritz_estimate(resid_estimate) )
+                        {
+                            vec_ops_->assign(x, x_tmp_);
+                            update_solution(A, i, b, x);
+                            if (monitor_.check_finished(x, r_))
+                            {
+                                converged_by_checked_ritz_norm = true;
+                                break;
+                            }
+                            else
+                            {
+                                vec_ops_->assign(x_tmp_, x);
+                            }
+                        }
+                    }
+                    logged_obj_t::info_f("iter = %i(%i), resid_estimate = %e", static_cast<int>(total_iterations), i+1, monitor_.norm_out(lsq_.residual_norm()) );
+                    j0 += sb;
+                }
+
+                if(!converged_by_checked_ritz_norm)
+                {
+                    update_solution(A, i, b, x);
+                }
+            }
+            while(!converged_by_checked_ritz_norm && !monitor_.check_finished(x, r_) );
+        }
+
+        bool res = monitor_.converged();
+        if(!res)
+            logged_obj_t::error_f("solve: linear solver failed to converge");
+
+        stop_use_all();
+
+        return res;
+    }
+
+    bool solve(const vector_type &b, vector_type &x)const
+    {
+        return solve(*parent_t::A_, b, x);
+    }
+};
+
+}
+}
+
+#endif //__NMFD_S_STEP_GMRES_H__
@@ -0,0 +1,300 @@
+// Copyright © 2016-2025 Ryabkov Oleg Igorevich, Evstigneev Nikolay Mikhaylovitch
+
+// This file is part of NMFD.
+
+// NMFD is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, version 2 only of the License.
+
+// NMFD is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+
+// You should have received a copy of the GNU General Public License
+// along with NMFD.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef __NMFD_TRUST_REGION_ITERATION_H__
+#define __NMFD_TRUST_REGION_ITERATION_H__
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <stdexcept>
+#include <nmfd/detail/algo_hierarchy_macro.h>
+#include <nmfd/detail/algo_hierarchy_creator.h>
+#include <nmfd/detail/recycle_space_hook.h>
+#include <nmfd/detail/linearization_point_hook.h>
+#include <nmfd/detail/jacobi_apply_hook.h>
+
+namespace nmfd
+{
+namespace solvers
+{
+
+/**
+*   Dogleg trust region iteration operator for nonlinear_solver, alternative to newton_iteration with damping
+*   by convergence strategy. Model m(p) = ||F + J*p||^2/2 is minimized in ||p|| <= radius over dogleg path
+*   through the Cauchy point p_c and the newton step p_n = -J^{-1}*F:
+*   - p_n is used if it is inside the trust region;
+*   - otherwise p_c scaled to the boundary if p_c is outside;
+*   - otherwise the point of segment [p_c, p_n] on the boundary.
+*   Steepest descent direction J^T*F needs transposed jacobian, so Cauchy point is taken along -F instead:
+*   p_c = -t*F, t = (F,J*F)/||J*F||^2 minimizes the model along -F (one jacobi apply per iteration).
+*   Predicted reduction uses the actual linear residual r_n = F + J*p_n of the (inexact) newton step,
+*   so together with F and J*F the model is known on the whole dogleg path (one more jacobi apply per iteration).
+*   Trial step is accepted when rho = actual/predicted reduction of ||F||^2/2 exceeds accept_ratio.
+*   Radius is multiplied by shrink_factor if rho < 0.25 and is doubled (up to radius_max) if rho > 0.75
+*   and the step reached the boundary. Rejected step only costs one F evaluation: p_n and p_c are reused
+*   for the smaller radius, so there is no additional linear solve. After max_rejections the last (shortest)
+*   step is returned to convergence strategy as is.
+*   Radius is kept between iterations and is set to radius_initial*max(||x||,1) on the first step of every solve.
+*   F(x+d_x) of the returned step is available through step_residual(), so nonlinear_solver passes it to convergence
+*   strategy which then does not recalculate it for unit weight (see detail/residual_handoff.h); the step is still
+*   damped by convergence strategy if it increases the norm of F.
+*   NonlinearOperator must provide jacobi operator with apply (see detail/jacobi_apply_hook.h).
+*/
+template<class VectorSpace, class NonlinearOperator, class LinearSolver>
+class trust_region_iteration
+{
+    using T = typename VectorSpace::scalar_type;
+public:
+    using scalar_type = typename VectorSpace::scalar_type;
+    using vector_type = typename VectorSpace::vector_type;
+    using vector_space_type = VectorSpace;
+    using linear_operator = typename NonlinearOperator::jacobi_operator_type;
+
+    static_assert(
+        nmfd::detail::jacobi_apply_hook<NonlinearOperator,vector_type>::is_available,
+        "trust_region_iteration: NonlinearOperator must provide jacobi operator with apply"
+    );
+
+    struct params
+    {
+        std::string log_msg_prefix;
+        T radius_initial;
+        T radius_max;
+        T accept_ratio;
+        T shrink_factor;
+        int max_rejections;
+
+        params(const std::string &log_prefix = "", const std::string & = "trust_region_iteration::") :
+            log_msg_prefix(log_prefix), radius_initial(T(1)), radius_max(T(1.0e10)), accept_ratio(T(1.0e-4)),
+            shrink_factor(T(0.25)), max_rejections(10)
+        {
+        }
+        #ifdef NMFD_ENABLE_NLOHMANN
+        void from_json(const nlohmann::json& j)
+        {
+            radius_initial = j.value("radius_initial", radius_initial);
+            radius_max = j.value("radius_max", radius_max);
+            accept_ratio = j.value("accept_ratio", accept_ratio);
+            shrink_factor = j.value("shrink_factor", shrink_factor);
+            max_rejections = j.value("max_rejections", max_rejections);
+        }
+        nlohmann::json to_json() const
+        {
+            return
+                nlohmann::json
+                {
+                    {"type", "trust_region_iteration"},
+                    {"radius_initial", radius_initial},
+                    {"radius_max", radius_max},
+                    {"accept_ratio", accept_ratio},
+                    {"shrink_factor", shrink_factor},
+                    {"max_rejections", max_rejections}
+                };
+        }
+        #endif
+    };
+    struct utils
+    {
+        std::shared_ptr<VectorSpace> vec_space;
+        utils() = default;
+        utils(std::shared_ptr<VectorSpace> vec_space_) : vec_space(std::move(vec_space_))
+        {
+        }
+        template<class Backend>
+        utils(Backend &backend, std::shared_ptr<VectorSpace> vec_space_) : utils(vec_space_)
+        {
+        }
+    };
+    NMFD_ALGO_HIERARCHY_TYPES_DEFINE(trust_region_iteration,LinearSolver,lin_solver)
+
+    trust_region_iteration(
+        std::shared_ptr<VectorSpace> vec_ops, std::shared_ptr<LinearSolver> lin_solver, const params &prm = params()
+    ):
+      vec_ops_(std::move(vec_ops)),
+      lin_solver_(std::move(lin_solver)),
+      prms_(prm)
+    {
+        if((prms_.radius_initial <= T(0))||(prms_.radius_max <= T(0))||(prms_.shrink_factor <= T(0))||(prms_.shrink_factor >= T(1)))
+        {
+            throw std::logic_error("trust_region_iteration: radius_initial and radius_max must be positive, shrink_factor must be in (0,1)");
+        }
+        vec_ops_->init_vector(f_); vec_ops_->start_use_vector(f_);
+        vec_ops_->init_vector(p_n_); vec_ops_->start_use_vector(p_n_);
+        vec_ops_->init_vector(p_c_); vec_ops_->start_use_vector(p_c_);
+        vec_ops_->init_vector(jf_); vec_ops_->start_use_vector(jf_);
+        vec_ops_->init_vector(x_t_); vec_ops_->start_use_vector(x_t_);
+        vec_ops_->init_vector(f_t_); vec_ops_->start_use_vector(f_t_);
+        vec_ops_->init_vector(r_n_); vec_ops_->start_use_vector(r_n_);
+        radius_ = T(-1);
+    }
+    trust_region_iteration(
+        const utils_hierarchy& utils,
+        const params_hierarchy& prm = params_hierarchy()
+    ) :
+        trust_region_iteration(
+            utils.vec_space,
+            nmfd::detail::algo_hierarchy_creator<LinearSolver>::get(utils.lin_solver,prm.lin_solver),
+            prm
+        )
+    {
+    }
+    ~trust_region_iteration()
+    {
+        vec_ops_->stop_use_vector(r_n_); vec_ops_->free_vector(r_n_);
+        vec_ops_->stop_use_vector(f_t_); vec_ops_->free_vector(f_t_);
+        vec_ops_->stop_use_vector(x_t_); vec_ops_->free_vector(x_t_);
+        vec_ops_->stop_use_vector(jf_); vec_ops_->free_vector(jf_);
+        vec_ops_->stop_use_vector(p_c_); vec_ops_->free_vector(p_c_);
+        vec_ops_->stop_use_vector(p_n_); vec_ops_->free_vector(p_n_);
+        vec_ops_->stop_use_vector(f_); vec_ops_->free_vector(f_);
+    }
+
+    bool solve(NonlinearOperator &nonlin_op, const vector_type& x, vector_type& d_x)
+    {
+        nonlin_op.apply(x, f_); // f = F(x)
+        return solve_step(nonlin_op, x, d_x);
+    }
+    /// step from x with known F(x) = Fx, usually F(x+d_x) of the previous accepted step
+    bool solve(NonlinearOperator &nonlin_op, const vector_type& x, const vector_type& Fx, vector_type& d_x)
+    {
+        vec_ops_->assign(Fx, f_); // f = F(x)
+        return solve_step(nonlin_op, x, d_x);
+    }
+    /// called by nonlinear_solver at the start of every solve
+    void start_solve()
+    {
+        //trust radius refers to previous problem
+        radius_ = T(-1);
+    }
+    /// F(x+d_x) for the step returned by the last solve; nullptr before the first solve
+    const vector_type *step_residual()const
+    {
+        return step_residual_valid_ ? &f_t_ : nullptr;
+    }
+    /// current trust region radius
+    T radius()const
+    {
+        return radius_;
+    }
+    /// number of rejected trial steps made so far
+    int rejections_num()const
+    {
+        return rejections_num_;
+    }
+    const params &get_params()const
+    {
+        return prms_;
+    }
+private:
+    std::shared_ptr<VectorSpace> vec_ops_;
+    std::shared_ptr<LinearSolver> lin_solver_;
+    params prms_;
+    vector_type f_, p_n_, p_c_, jf_, x_t_, f_t_, r_n_;
+    T radius_;
+    int rejections_num_ = 0;
+    bool step_residual_valid_ = false;
+
+    /// f_ contains F(x) on entry
+    bool solve_step(NonlinearOperator &nonlin_op, const vector_type& x, vector_type& d_x)
+    {
+        step_residual_valid_ = false;
+        nmfd::detail::linearization_point_hook<NonlinearOperator,vector_type>::set(nonlin_op, x, f_);
+        lin_solver_->set_operator(nonlin_op.get_jacobi_operator());
+        nmfd::detail::recycle_space_hook<LinearSolver,linear_operator>::update(*lin_solver_, *nonlin_op.get_jacobi_operator());
+
+        //newton step
+        vec_ops_->assign_lin_comb(T(-1), f_, f_t_); // f_t = -F(x)
+        vec_ops_->assign_scalar(T(0), p_n_);
+        bool flag_lin_solver = lin_solver_->solve(f_t_, p_n_);
+        //linear residual of newton step r_n = F + J*p_n
+        nmfd::detail::jacobi_apply_hook<NonlinearOperator,vector_type>::apply(nonlin_op, p_n_, r_n_);
+        vec_ops_->add_lin_comb(T(1), f_, T(1), r_n_);
+        //Cauchy point along -F
+        nmfd::detail::jacobi_apply_hook<NonlinearOperator,vector_type>::apply(nonlin_op, f_, jf_);
+        const T f_norm2 = vec_ops_->scalar_prod(f_, f_);
+        const T f_jf = vec_ops_->scalar_prod(f_, jf_);
+        const T jf_norm2 = vec_ops_->scalar_prod(jf_, jf_);
+        const T r_norm2_n = vec_ops_->scalar_prod(r_n_, r_n_);
+        const T f_r = vec_ops_->scalar_prod(f_, r_n_);
+        const T jf_r = vec_ops_->scalar_prod(jf_, r_n_);
+        const T t = (jf_norm2 > T(0)) ? f_jf/jf_norm2 : T(0);
+        vec_ops_->assign_lin_comb(-t, f_, p_c_);
+
+        const T p_n_norm = vec_ops_->norm(p_n_);
+        const T p_c_norm = std::abs(t)*std::sqrt(f_norm2);
+        const T p_cn = vec_ops_->scalar_prod(p_c_, p_n_);
+        if(radius_ <= T(0))
+        {
+            radius_ = prms_.radius_initial*std::max(vec_ops_->norm(x), T(1));
+        }
+        for(int rejection = 0; ; ++rejection)
+        {
+            //d_x = a*p_c + b*p_n on the dogleg path
+            T a, b, p_norm;
+            if(p_n_norm <= radius_)
+            {
+                a = T(0); b = T(1); p_norm = p_n_norm;
+            }
+            else if(p_c_norm >= radius_)
+            {
+                a = radius_/p_c_norm; b = T(0); p_norm = radius_;
+            }
+            else
+            {
+                //||p_c + tau*(p_n - p_c)|| = radius
+                const T d_norm2 = p_n_norm*p_n_norm - T(2)*p_cn + p_c_norm*p_c_norm;
+                const T p_c_d = p_cn - p_c_norm*p_c_norm;
+                const T tau = (-p_c_d + std::sqrt(p_c_d*p_c_d + d_norm2*(radius_*radius_ - p_c_norm*p_c_norm)))/d_norm2;
+                a = T(1) - tau; b = tau; p_norm = radius_;
+            }
+            vec_ops_->assign_lin_comb(a, p_c_, b, p_n_, d_x);
+
+            //F + J*d_x = (1-b)*F - a*t*J*F + b*r_n
+            const T c = T(1)-b, e = -a*t;
+            const T r_norm2 =
+                c*c*f_norm2 + e*e*jf_norm2 + b*b*r_norm2_n + T(2)*(c*e*f_jf + c*b*f_r + e*b*jf_r);
+            const T pred = T(0.5)*(f_norm2 - r_norm2);
+            vec_ops_->assign_lin_comb(T(1), x, T(1), d_x, x_t_);
+            nonlin_op.apply(x_t_, f_t_);
+            const T f_t_norm2 = vec_ops_->scalar_prod(f_t_, f_t_);
+            const T ared = T(0.5)*(f_norm2 - f_t_norm2);
+            const T rho = ((pred > T(0))&&std::isfinite(f_t_norm2)) ? ared/pred : T(-1);
+
+            if(rho < T(0.25))
+            {
+                radius_ = prms_.shrink_factor*p_norm;
+            }
+            else if((rho > T(0.75))&&(p_norm >= T(0.99)*radius_))
+            {
+                radius_ = std::min(T(2)*radius_, prms_.radius_max);
+            }
+            if((rho > prms_.accept_ratio)||(rejection == prms_.max_rejections))
+            {
+                break;
+            }
+            ++rejections_num_;
+        }
+        //f_t_ = F(x + d_x) for the returned step
+        step_residual_valid_ = true;
+        return flag_lin_solver;
+    }
+};
+
+}
+}
+
+#endif
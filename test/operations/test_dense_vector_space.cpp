@@ -1,10 +1,16 @@
 #include <memory>
+#include <vector>
+#include <cmath>
+#include <type_traits>
 
 #include <scfd/utils/log.h>
 #include <scfd/backend/backend.h>
 
 #include <nmfd/operations/detail/scfd_array_traits.h>
 #include <nmfd/operations/dense_vector_space.h>
+#ifdef USE_THREADED_CPU_BACKEND
+#include <nmfd/backend/threaded_cpu.h>
+#endif
 
 #ifndef USE_DOUBLE_PRECISION
 using scalar           = float;
@@ -19,7 +25,11 @@ int main( int argc, char const *args[] )
     using log_t                = scfd::utils::log_std;
     using T                    = scalar;
     static const int Dim       = 3;
+#ifdef USE_THREADED_CPU_BACKEND
+    using backend_type         = nmfd::backend::threaded_cpu;
+#else
     using backend_type         = scfd::backend::current;
+#endif
     using memory_type          = backend_type::memory_type;
     using vector_type          = scfd::arrays::array<T, memory_type>;
     using vector_traits        = nmfd::operations::detail::scfd_array_traits<T, memory_type>;
@@ -769,7 +779,220 @@ int main( int argc, char const *args[] )
     }
 
     // ====================================================================
-    // GROUP 11: Slice Operations
+    // GROUP 11: Multivector Operations
+    // ====================================================================
+    log.info( "=== Testing Multivector Operations ===" );
+
+    // 10 columns to cross the fused kernels column block boundary
+    {
+        const int                              m = 10;
+        dense_vector_space_t::multivector_type mx;
+        vec_space->init_multivector( mx, m );
+        for ( int k = 0; k < m; ++k )
+        {
+            vector_type col = { T( k ), T( k + 1 ), T( k + 2 ) };
+            vec_space->assign( col, mx, m, k );
+        }
+
+        // Test batched scalar products: res[k-1] = (mx[k], y) = 15k+17
+        {
+            std::vector<T> res( m - 1 );
+            vec_space->multi_scalar_prod( mx, m, 1, m, y, res.data() );
+            bool ok = true;
+            for ( int k = 1; k < m; ++k )
+            {
+                ok = ok && ( std::abs( res[k - 1] - T( 15 * k + 17 ) ) < eps );
+            }
+            if ( ok )
+            {
+                log.info( "✓ `multi_scalar_prod(mx, m, k0, k1, y, res)` method test passed" );
+                passed_counter++;
+            }
+            else
+            {
+                log.error( "✗ `multi_scalar_prod(mx, m, k0, k1, y, res)` method test failed" );
+                failed_counter++;
+            }
+        }
+
+        // Test batched linear combination: y = 2*{4,5,6} + sum_k mx[k] = {53, 65, 77}
+        {
+            vector_type    tmp_y = { 4, 5, 6 };
+            std::vector<T> mul_x( m, T( 1 ) );
+            vec_space->multi_add_lin_comb( mul_x.data(), mx, m, 0, m, 2, tmp_y );
+            const auto tmp_y_view = tmp_y.create_view( true );
+            if ( std::abs( tmp_y_view( 0 ) - 53 ) < eps && std::abs( tmp_y_view( 1 ) - 65 ) < eps &&
+                 std::abs( tmp_y_view( 2 ) - 77 ) < eps )
+            {
+                log.info( "✓ `multi_add_lin_comb(mul_x, mx, m, k0, k1, mul_y, y)` method test passed" );
+                passed_counter++;
+            }
+            else
+            {
+                log.error(
+                    "✗ `multi_add_lin_comb(mul_x, mx, m, k0, k1, mul_y, y)` method test failed. "
+                    "Expected {53, 65, 77} but got {" +
+                    std::to_string( tmp_y_view( 0 ) ) + ", " + std::to_string( tmp_y_view( 1 ) ) + ", " +
+                    std::to_string( tmp_y_view( 2 ) ) + "}"
+                );
+                failed_counter++;
+            }
+        }
+
+        // Test fused update with norm: tmp = 1*mx[1] + 2*{4,5,6} = {9, 12, 15}, (tmp,tmp) = 450
+        {
+            vector_type tmp      = { 4, 5, 6 };
+            T           dot      = vec_space->axpy_dot( 1, mx, m, 1, 2, tmp );
+            const auto  tmp_view = tmp.create_view( true );
+            if ( std::abs( dot - 450 ) < eps && std::abs( tmp_view( 0 ) - 9 ) < eps &&
+                 std::abs( tmp_view( 1 ) - 12 ) < eps && std::abs( tmp_view( 2 ) - 15 ) < eps )
+            {
+                log.info( "✓ `axpy_dot(mul_x, mx, m, k, mul_y, y)` method test passed" );
+                passed_counter++;
+            }
+            else
+            {
+                log.error( "✗ `axpy_dot(mul_x, mx, m, k, mul_y, y)` method test failed" );
+                failed_counter++;
+            }
+        }
+
+        // Test two scalar products in one sweep: (mx[2], y) = 47, (x, y) = 32
+        {
+            T res[2];
+            vec_space->dot2( mx, m, 2, x, y, res );
+            if ( std::abs( res[0] - 47 ) < eps && std::abs( res[1] - 32 ) < eps )
+            {
+                log.info( "✓ `dot2(mx, m, k, x, y, res)` method test passed" );
+                passed_counter++;
+            }
+            else
+            {
+                log.error( "✗ `dot2(mx, m, k, x, y, res)` method test failed" );
+                failed_counter++;
+            }
+        }
+
+        // Test scaled copy into multivector column: mx[3] = 2*{1,2,3} = {2, 4, 6}
+        {
+            vec_space->scale_assign( 2, x, mx, m, 3 );
+            const auto col_view = mx[3].create_view( true );
+            if ( std::abs( col_view( 0 ) - 2 ) < eps && std::abs( col_view( 1 ) - 4 ) < eps &&
+                 std::abs( col_view( 2 ) - 6 ) < eps )
+            {
+                log.info( "✓ `scale_assign(mul_x, x, mx, m, k)` method test passed" );
+                passed_counter++;
+            }
+            else
+            {
+                log.error( "✗ `scale_assign(mul_x, x, mx, m, k)` method test failed" );
+                failed_counter++;
+            }
+        }
+
+        vec_space->free_multivector( mx, m );
+    }
+
+    // ====================================================================
+    // GROUP 12: Conversion Between Precisions
+    // ====================================================================
+    log.info( "=== Testing Conversion Between Precisions ===" );
+
+    {
+        using other_scalar         = std::conditional_t<std::is_same_v<T, float>, double, float>;
+        using other_vector_type    = scfd::arrays::array<other_scalar, memory_type>;
+        using other_vector_traits  = nmfd::operations::detail::scfd_array_traits<other_scalar, memory_type>;
+        using other_vector_space_t = nmfd::operations::dense_vector_space<other_vector_traits, backend_type>;
+        auto              other_space = std::make_shared<other_vector_space_t>( Dim );
+        other_vector_type other_x     = { 1, 2, 3 };
+
+        // Test conversion copy: tmp = {1, 2, 3}
+        {
+            vector_type tmp = { 0, 0, 0 };
+            vec_space->assign_convert( *other_space, other_x, tmp );
+            const auto tmp_view = tmp.create_view( true );
+            if ( std::abs( tmp_view( 0 ) - 1 ) < eps && std::abs( tmp_view( 1 ) - 2 ) < eps &&
+                 std::abs( tmp_view( 2 ) - 3 ) < eps )
+            {
+                log.info( "✓ `assign_convert(x_ops, x, y)` method test passed" );
+                passed_counter++;
+            }
+            else
+            {
+                log.error( "✗ `assign_convert(x_ops, x, y)` method test failed" );
+                failed_counter++;
+            }
+        }
+
+        // Test converting linear combination: tmp = 2*{1,2,3} + 3*{4,5,6} = {14, 19, 24}
+        {
+            vector_type tmp = { 4, 5, 6 };
+            vec_space->add_lin_comb_convert( 2, *other_space, other_x, 3, tmp );
+            const auto tmp_view = tmp.create_view( true );
+            if ( std::abs( tmp_view( 0 ) - 14 ) < eps && std::abs( tmp_view( 1 ) - 19 ) < eps &&
+                 std::abs( tmp_view( 2 ) - 24 ) < eps )
+            {
+                log.info( "✓ `add_lin_comb_convert(mul_x, x_ops, x, mul_y, y)` method test passed" );
+                passed_counter++;
+            }
+            else
+            {
+                log.error( "✗ `add_lin_comb_convert(mul_x, x_ops, x, mul_y, y)` method test failed" );
+                failed_counter++;
+            }
+        }
+    }
+
+    // ====================================================================
+    // GROUP 13: Large Vectors
+    // ====================================================================
+    log.info( "=== Testing Large Vectors ===" );
+
+    // size is not multiple of any block or thread partitioning
+    {
+        const int   big_size  = 100003;
+        auto        big_space = std::make_shared<dense_vector_space_t>( big_size );
+        vector_type big_x;
+        big_space->init_vector( big_x );
+        big_space->assign_scalar( T( 0.5 ), big_x );
+
+        // sums of 0.5 and 0.25 are exact, so reductions must give exact values
+        T big_sum     = big_space->sum( big_x );
+        T big_norm_sq = big_space->norm_sq( big_x );
+        if ( big_sum == T( 0.5 ) * big_size && big_norm_sq == T( 0.25 ) * big_size )
+        {
+            log.info( "✓ `sum(x)` and `norm_sq(x)` on large vector test passed" );
+            passed_counter++;
+        }
+        else
+        {
+            log.error(
+                "✗ `sum(x)` and `norm_sq(x)` on large vector test failed: " + std::to_string( big_sum ) + ", " +
+                std::to_string( big_norm_sq )
+            );
+            failed_counter++;
+        }
+
+        // repeated reduction must be reproducible bitwise
+        big_space->add_lin_comb( T( 1 ) / T( 3 ), big_x, T( 0.7 ), big_x );
+        T dot_1 = big_space->scalar_prod( big_x, big_x );
+        T dot_2 = big_space->scalar_prod( big_x, big_x );
+        if ( dot_1 == dot_2 )
+        {
+            log.info( "✓ `scalar_prod(x, y)` on large vector is reproducible" );
+            passed_counter++;
+        }
+        else
+        {
+            log.error( "✗ `scalar_prod(x, y)` on large vector is not reproducible" );
+            failed_counter++;
+        }
+
+        big_space->free_vector( big_x );
+    }
+
+    // ====================================================================
+    // GROUP 14: Slice Operations
     // ====================================================================
     // log.info("=== Testing Slice Operations ===");
 
@@ -9,14 +9,19 @@ namespace tests
 {
 
 
-template<class LinearOperator, class Log> 
+template
+<
+    class LinearOperator, class Log,
+    class Restrictor = restrictor<typename LinearOperator::vector_space_type,Log>,
+    class Prolongator = prolongator<typename LinearOperator::vector_space_type,Log>
+> 
 class coarsening
 {
 public:
     using operator_type = LinearOperator;
     using vector_space_type = typename operator_type::vector_space_type;
-    using restrictor_type = restrictor<vector_space_type,Log>;
-    using prolongator_type = prolongator<vector_space_type,Log>;
+    using restrictor_type = Restrictor;
+    using prolongator_type = Prolongator;
 public:
     struct params
     {
@@ -31,9 +36,22 @@ public:
     {
     }
 
+    /// calls counters shared by all instances, used to check hierarchy reuse in mg
+    static int &next_level_calls()
+    {
+        static int calls = 0;
+        return calls;
+    }
+    static int &coarse_operator_calls()
+    {
+        static int calls = 0;
+        return calls;
+    }
+
     std::tuple<std::shared_ptr<restrictor_type>,std::shared_ptr<prolongator_type>> 
     next_level(const operator_type &op)
     {
+        next_level_calls()++;
         return 
             std::make_tuple(
                 std::make_shared<restrictor_type>(op.get_size()),
@@ -44,6 +62,7 @@ public:
     std::shared_ptr<operator_type> 
     coarse_operator(const operator_type &op, const restrictor_type &restrictor, const prolongator_type &prolongator)
     {
+        coarse_operator_calls()++;
         return std::make_shared<operator_type>(op.get_size()/2);
     }
     bool coarse_enough(const operator_type &op)const
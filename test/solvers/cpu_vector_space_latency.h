@@ -0,0 +1,116 @@
+#ifndef __CPU_VECTOR_SPACE_LATENCY_H__
+#define __CPU_VECTOR_SPACE_LATENCY_H__
+
+/**
+*   Test class for communication hiding solvers
+*   cpu_vector_space which emulates latency of global reductions (like MPI_Allreduce on many nodes).
+*   Blocking reductions sleep for the given latency; nonblocking ones are calculated at once,
+*   but their handles do not finish earlier than latency after the start, so work done
+*   between start and wait is hidden.
+*/
+
+#include <chrono>
+#include <thread>
+#include <nmfd/operations/reduction_handle.h>
+#include "cpu_vector_space.h"
+
+namespace nmfd
+{
+
+template
+<
+    class Type, class VectorType, class Log, class Ordinal = std::ptrdiff_t
+>
+class cpu_vector_space_latency : public cpu_vector_space<Type, VectorType, Log, Ordinal>
+{
+    using parent_t = cpu_vector_space<Type, VectorType, Log, Ordinal>;
+    using clock_t = std::chrono::steady_clock;
+
+public:
+    using Ord = typename parent_t::Ord;
+    using vector_type = typename parent_t::vector_type;
+    using multivector_type = typename parent_t::multivector_type;
+    using scalar_type = typename parent_t::scalar_type;
+
+    cpu_vector_space_latency(Ord sz, std::chrono::microseconds latency) :
+        parent_t(sz), latency_(latency), blocking_reductions_num_(0), async_reductions_num_(0)
+    {
+    }
+
+    using parent_t::scalar_prod;
+    using parent_t::multi_scalar_prod;
+
+    [[nodiscard]] scalar_type scalar_prod(const vector_type &x, const vector_type &y)const
+    {
+        wait_latency();
+        return parent_t::scalar_prod(x, y);
+    }
+    void multi_scalar_prod(const multivector_type& mx, Ord, Ord k0, Ord k1, const vector_type &y, scalar_type *res)const
+    {
+        wait_latency();
+        for(Ord k = k0;k < k1;k++)
+        {
+            res[k-k0] = parent_t::scalar_prod(mx[k], y);
+        }
+    }
+    void multi_scalar_prod(
+        const multivector_type& mx, Ord, Ord k0, Ord k1, const multivector_type& my, Ord, Ord l0, Ord l1, scalar_type *res
+    )const
+    {
+        wait_latency();
+        for(Ord l = l0;l < l1;l++)
+        {
+            for(Ord k = k0;k < k1;k++)
+            {
+                res[(l-l0)*(k1-k0)+(k-k0)] = parent_t::scalar_prod(mx[k], my[l]);
+            }
+        }
+    }
+    operations::reduction_handle scalar_prod_async(const vector_type &x, const vector_type &y, scalar_type *res)const
+    {
+        *res = parent_t::scalar_prod(x, y);
+        return start_latency();
+    }
+    operations::reduction_handle multi_scalar_prod_async(const multivector_type& mx, Ord, Ord k0, Ord k1, const vector_type &y, scalar_type *res)const
+    {
+        for(Ord k = k0;k < k1;k++)
+        {
+            res[k-k0] = parent_t::scalar_prod(mx[k], y);
+        }
+        return start_latency();
+    }
+
+    std::size_t blocking_reductions_num()const
+    {
+        return blocking_reductions_num_;
+    }
+    std::size_t async_reductions_num()const
+    {
+        return async_reductions_num_;
+    }
+    void reset_reductions_num()
+    {
+        blocking_reductions_num_ = async_reductions_num_ = 0;
+    }
+
+private:
+    std::chrono::microseconds latency_;
+    mutable std::size_t blocking_reductions_num_;
+    mutable std::size_t async_reductions_num_;
+
+    void wait_latency()const
+    {
+        ++blocking_reductions_num_;
+        std::this_thread::sleep_for(latency_);
+    }
+    operations::reduction_handle start_latency()const
+    {
+        ++async_reductions_num_;
+        auto deadline = clock_t::now() + latency_;
+        return operations::reduction_handle([deadline](){ std::this_thread::sleep_until(deadline); });
+    }
+};
+
+}
+
+#endif
@@ -79,6 +79,23 @@ public:
         }
 
     }
+    //block version: operator is applied to n first vectors of multivector x at once
+    template<class MultiVector>
+    void apply_multi(const MultiVector& x, MultiVector& f, Ord m, Ord n)const
+    {
+        for(Ord j=0; j<N; j++)
+        {
+            for(Ord k=0; k<n; k++)
+            {
+                if((j>0)&&(j<N-1))
+                    f[k][j] = (1+2*tau_/h_/h_)*x[k][j] - (tau_/h_/h_)*x[k][j-1] - (tau_/h_/h_)*x[k][j+1];
+                else if(j==0)
+                    f[k][j] = (1+2*tau_/h_/h_)*x[k][j] - (tau_/h_/h_)*x[k][j+1];
+                else if(j==N-1)
+                    f[k][j] = (1+2*tau_/h_/h_)*x[k][j] - (tau_/h_/h_)*x[k][j-1];
+            }
+        }
+    }
 
 private:
 
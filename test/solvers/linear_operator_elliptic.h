@@ -86,6 +86,12 @@ public:
         }
 
     }
+    /// j-th component of rhs - A*x
+    T residual_at(const T_vec& rhs, const T_vec& x, Ord j)const
+    {
+        Ord jm = (j > 0 ? j-1 : N_-1), jp = (j < N_-1 ? j+1 : 0);
+        return rhs[j] - ((2/h_/h_)*x[j] - (1/h_/h_)*x[jm] - (1/h_/h_)*x[jp]);
+    }
 
 private:
 
@@ -0,0 +1,60 @@
+#ifndef __PRECONDITIONER_INNER_SOLVER__
+#define __PRECONDITIONER_INNER_SOLVER__
+
+
+/**
+*   Test class for flexible iterative linear solvers
+*   Implements preconditioner as a few iterations of the given inner iterative solver
+*   with zero initial guess, so preconditioner changes from one application to another.
+*/
+
+#include <memory>
+
+namespace tests
+{
+
+template<class VectorOperations, class LinearOperator, class InnerSolver> 
+class preconditioner_inner_solver
+{
+public:
+    using T = typename VectorOperations::scalar_type;
+    using T_vec = typename VectorOperations::vector_type;
+
+    preconditioner_inner_solver(std::shared_ptr<VectorOperations> vec_ops, std::shared_ptr<InnerSolver> solver):
+    vec_ops_(vec_ops), solver_(solver)
+    {
+        vec_ops_->init_vector(rhs_);
+        vec_ops_->start_use_vector(rhs_);
+    }
+
+    ~preconditioner_inner_solver()
+    {
+        vec_ops_->stop_use_vector(rhs_);
+        vec_ops_->free_vector(rhs_);
+    }
+    
+    void set_operator(std::shared_ptr<const LinearOperator> op_) 
+    {
+        solver_->set_operator(op_);
+    }
+
+    void apply(T_vec& x)const
+    {
+        vec_ops_->assign(x, rhs_);
+        vec_ops_->assign_scalar(0, x);
+        //inner solver is not supposed to converge
+        solver_->solve(rhs_, x);
+    }
+
+private:
+    std::shared_ptr<VectorOperations> vec_ops_;
+    std::shared_ptr<InnerSolver> solver_;
+    mutable T_vec rhs_;
+
+};
+
+
+}
+
+
+#endif
@@ -84,6 +84,31 @@ private:
 
 };
 
+/**
+*   Same prolongator with extended mg level interface: adds prolongated vector without temporary one
+*/
+template<class VectorSpace, class Log> 
+class prolongator_fused : public prolongator<VectorSpace,Log>
+{
+    using parent_t = prolongator<VectorSpace,Log>;
+public:
+    using typename parent_t::ordinal_type;
+    using typename parent_t::vector_type;
+
+    prolongator_fused(ordinal_type N) : parent_t(N)
+    {
+    }
+
+    /// f += P*x, x is vector of size N/2, f is of N size
+    void prolongate_add(const vector_type& x, vector_type& f)const
+    {
+        for(ordinal_type j=0; j<parent_t::get_size(); j++)
+        {
+            f[j] += x[j/2];
+        }
+    }
+};
+
 }
 
 #endif
\ No newline at end of file
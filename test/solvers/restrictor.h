@@ -77,6 +77,33 @@ private:
 
 };
 
+/**
+*   Same restrictor with extended mg level interface: restricts residual of fine level calculated on the fly
+*/
+template<class VectorSpace, class Log> 
+class restrictor_fused : public restrictor<VectorSpace,Log>
+{
+    using parent_t = restrictor<VectorSpace,Log>;
+public:
+    using typename parent_t::scalar_type;
+    using typename parent_t::ordinal_type;
+    using typename parent_t::vector_type;
+
+    restrictor_fused(ordinal_type N) : parent_t(N)
+    {
+    }
+
+    /// f = R*(rhs - A*x), rhs and x are vectors of size N, f is of N/2 size
+    template<class Operator>
+    void restrict_residual(const Operator& A, const vector_type& rhs, const vector_type& x, vector_type& f)const
+    {
+        for(ordinal_type j=0; j<parent_t::get_size()/2; j++)
+        {
+            f[j] = scalar_type(0.5)*(A.residual_at(rhs, x, j*2) + A.residual_at(rhs, x, j*2+1));
+        }
+    }
+};
+
 }
 
 #endif
\ No newline at end of file
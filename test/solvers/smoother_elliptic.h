@@ -15,8 +15,10 @@
 * 
 *   preconditioner for the residual vecotr R={r_j}:
 * 
-*   u_{j} = (r_{j})/(2/h^2)
+*   u_{j} = omega*(r_{j})/(2/h^2)
 *
+*   omega = 1 is plain Jacobi, which does not damp the most oscillating mode; omega = 1/2 does
+*   (needed when multigrid is used without outer krylov solver)
 */
 
 #include <memory>
@@ -35,7 +37,9 @@ public:
 
     struct params
     {
-        params(const std::string &log_prefix = "", const std::string &log_name = "smoother_elliptic::")
+        T relaxation;
+        params(const std::string &log_prefix = "", const std::string &log_name = "smoother_elliptic::") :
+            relaxation(1)
         {
         }
     };
@@ -45,7 +49,7 @@ public:
     };
     using utils_hierarchy = utils;
 
-    smoother_elliptic(const utils_hierarchy &u, const params_hierarchy &p)
+    smoother_elliptic(const utils_hierarchy &u, const params_hierarchy &p) : relaxation_(p.relaxation)
     {
     }
     ~smoother_elliptic()
@@ -56,7 +60,7 @@ public:
     {
         N = op_->get_size();
         h_ = op_->get_h();
-        diag_coeff_ = (2/h_/h_);
+        diag_coeff_ = (2/h_/h_)/relaxation_;
     }
 
     void apply(T_vec& x)const
@@ -67,6 +71,8 @@ public:
         }
     }
 
+protected:
+    T relaxation_;
 private:
     T diag_coeff_;
     std::size_t N;
@@ -74,6 +80,66 @@ private:
 
 };
 
+/**
+*   Same smoother with extended mg level interface: x update and new residual are calculated in one pass,
+*   residual component j is recalculated right after x[j+1] is updated
+*/
+template<class VectorSpace, class Log> 
+class smoother_elliptic_fused : public smoother_elliptic<VectorSpace,Log>
+{
+    using parent_t = smoother_elliptic<VectorSpace,Log>;
+public:
+    using typename parent_t::T;
+    using typename parent_t::T_vec;
+    using typename parent_t::operator_type;
+    using typename parent_t::params;
+    using typename parent_t::params_hierarchy;
+    using typename parent_t::utils;
+    using typename parent_t::utils_hierarchy;
+
+    smoother_elliptic_fused(const utils_hierarchy &u, const params_hierarchy &p) : parent_t(u, p)
+    {
+    }
+
+    void set_operator(std::shared_ptr<const operator_type> op_) 
+    {
+        parent_t::set_operator(op_);
+        op_ptr_ = op_;
+    }
+
+    void apply_and_residual(const T_vec& rhs, T_vec& x, T_vec& residual)const
+    {
+        std::size_t N = op_ptr_->get_size();
+        T diag_coeff = op_ptr_->diag_coefficient()/this->relaxation_;
+        x[0] += residual[0]/diag_coeff;
+        if (N > 1) x[1] += residual[1]/diag_coeff;
+        for(std::size_t j=1; j+1<N;j++)
+        {
+            x[j+1] += residual[j+1]/diag_coeff;
+            residual[j] = op_ptr_->residual_at(rhs, x, j);
+        }
+        if (N > 1) residual[N-1] = op_ptr_->residual_at(rhs, x, N-1);
+        residual[0] = op_ptr_->residual_at(rhs, x, 0);
+    }
+
+    /// x = omega*rhs/d, so residual_j = rhs_j - (d x_j - (d/2)(x_{j-1} + x_{j+1})) = 
+    /// (1-omega)*rhs_j + omega*(rhs_{j-1} + rhs_{j+1})/2
+    void apply_zero_guess(const T_vec& rhs, T_vec& x, T_vec& residual)const
+    {
+        std::size_t N = op_ptr_->get_size();
+        T diag_coeff = op_ptr_->diag_coefficient(), omega = this->relaxation_;
+        for(std::size_t j=0; j<N;j++)
+        {
+            x[j] = omega*rhs[j]/diag_coeff;
+            residual[j] = (T(1)-omega)*rhs[j] + T(0.5)*omega*(rhs[j > 0 ? j-1 : N-1] + rhs[j+1 < N ? j+1 : 0]);
+        }
+    }
+
+private:
+    std::shared_ptr<const operator_type> op_ptr_;
+
+};
+
 
 }
 
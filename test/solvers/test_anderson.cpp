@@ -0,0 +1,117 @@
+#include <memory>
+#include <cmath>
+#include <scfd/utils/log.h>
+#include <scfd/backend/backend.h>
+#include <nmfd/operations/detail/scfd_array_traits.h>
+#include <nmfd/operations/dense_vector_space.h>
+#include <nmfd/solvers/nonlinear_solver.h>
+#include <nmfd/solvers/anderson_iteration.h>
+
+/// F(u) = u - G(u), G(u) = a*S(u) + c*cos(u) + 1, S is 3 point averaging with zero boundary values,
+/// G is contraction with factor about a + c, so plain Picard iteration converges slowly
+template<class VectorOperations>
+class fixed_point_operator
+{
+public:
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+
+    fixed_point_operator(const VectorOperations& vec_ops, scalar_type a, scalar_type c) :
+        vec_ops_(vec_ops), N_(vec_ops.size()), a_(a), c_(c), apply_calls(0)
+    {
+    }
+    void apply(const vector_type& x, vector_type& f)const
+    {
+        apply_calls++;
+        const scalar_type *x_ = vec_ops_.get_raw_ptr(x);
+        scalar_type *f_ = vec_ops_.get_raw_ptr(f);
+        for(std::size_t j = 0; j < N_; j++)
+        {
+            scalar_type x_l = (j>0 ? x_[j-1] : scalar_type(0)), x_r = (j<N_-1 ? x_[j+1] : scalar_type(0));
+            f_[j] = x_[j] - (a_*(x_l + x_[j] + x_r)/3 + c_*std::cos(x_[j]) + scalar_type(1));
+        }
+    }
+
+    mutable int apply_calls;
+private:
+    const VectorOperations& vec_ops_;
+    std::size_t N_;
+    scalar_type a_, c_;
+};
+
+int main(int argc, char const *args[])
+{
+    using log_t = scfd::utils::log_std;
+    using backend_t = scfd::backend::current;
+    using memory_t = backend_t::memory_type;
+    using T = double;
+    using vec_ops_t = nmfd::operations::dense_vector_space<nmfd::operations::detail::scfd_array_traits<T, memory_t>, backend_t>;
+    using T_vec = typename vec_ops_t::vector_type;
+    using nonlin_op_t = fixed_point_operator<vec_ops_t>;
+    using anderson_t = nmfd::solvers::anderson_iteration<vec_ops_t, nonlin_op_t>;
+    using conv_strat_t = nmfd::solvers::default_convergence_strategy<vec_ops_t, log_t, nonlin_op_t>;
+    using solver_t = nmfd::solvers::nonlinear_solver<vec_ops_t, log_t, nonlin_op_t, anderson_t>;
+
+    int error = 0;
+    log_t log;
+    std::size_t N = 100;
+    const T eps = 1e-10;
+
+    auto vec_ops = std::make_shared<vec_ops_t>(N);
+    T_vec x, f;
+    vec_ops->init_vectors(x, f);
+    nonlin_op_t nonlin_op(*vec_ops, 0.9, 0.05);
+
+    int iters_picard = 0;
+    /// depth 0 is plain Picard iteration; depth 3 is less than number of iterations, so oldest columns are removed
+    for(int depth : {0, 3, 8})
+    {
+        log.info_f("test anderson_iteration with depth %i", depth);
+        anderson_t::params prm;
+        prm.depth = depth;
+        auto anderson = std::make_shared<anderson_t>(vec_ops, prm);
+        conv_strat_t::params conv_prm;
+        conv_prm.abs_tol = eps;
+        conv_prm.max_iters_num = 1000;
+        conv_prm.verbose = false;
+        auto conv_strat = std::make_shared<conv_strat_t>(vec_ops, nullptr, conv_prm);
+        solver_t solver(vec_ops, &log, anderson, conv_strat);
+        /// second solve checks that history of the first one is cleared
+        for(int attempt = 0; attempt < 2; ++attempt)
+        {
+            vec_ops->assign_scalar(T(0), x);
+            bool res = solver.solve(&nonlin_op, nullptr, nullptr, x);
+            int iters = conv_strat->get_number_of_iterations();
+            nonlin_op.apply(x, f);
+            T resid = vec_ops->norm(f);
+            log.info_f("res: %s, iterations: %i, residual norm: %e", res?"true":"false", iters, resid);
+            if ((!res)||(resid > eps))
+            {
+                log.error("Failed to converge!!");
+                error++;
+            }
+            if (depth == 0)
+            {
+                iters_picard = iters;
+            }
+            else if (2*iters > iters_picard)
+            {
+                log.error("Anderson acceleration is too slow!!");
+                error++;
+            }
+        }
+    }
+
+    vec_ops->free_vectors(x, f);
+
+    if(error > 0)
+    {
+        log.error_f("Got error = %d.", error ) ;
+    }
+    else
+    {
+        log.info("No errors.") ;
+    }
+
+    return error;
+}
@@ -0,0 +1,188 @@
+#include <memory>
+#include <cmath>
+#include <scfd/utils/log.h>
+#include <nmfd/operations/batched_static_vector_space.h>
+#include <nmfd/solvers/batched_newton.h>
+
+static const int dim = 3;
+
+/// F_b(x) = s_b*A*(x - u_b) + c_b*(x^3 - u_b^3) with exact solution u_b; A has zero (0,0) element, so
+/// LU at x = 0 needs pivoting; s_b = 0 gives singular jacobian at x = 0
+template<class VectorSpace>
+struct batched_cubic_operator
+{
+    using T = typename VectorSpace::scalar_type;
+    using vector_type = typename VectorSpace::vector_type;
+    using matrix_type = typename VectorSpace::matrix_type;
+    using lanes_type = typename VectorSpace::lanes_type;
+
+    const T A[dim][dim] = {{0., 2., 1.}, {1., 0., 3.}, {2., 1., 0.}};
+    std::size_t n;
+    vector_type u;
+    lanes_type s, c;
+    mutable int apply_calls = 0, jacobi_calls = 0;
+
+    void apply(const vector_type &x, vector_type &f)const
+    {
+        apply_calls++;
+        for(int i = 0; i < dim; ++i)
+        {
+            T *f_i = f.component(i);
+            for(std::size_t b = 0; b < n; ++b)
+            {
+                T ax = T(0);
+                for(int j = 0; j < dim; ++j)
+                {
+                    ax += A[i][j]*(x(j,b) - u(j,b));
+                }
+                f_i[b] = s[b]*ax + c[b]*(x(i,b)*x(i,b)*x(i,b) - u(i,b)*u(i,b)*u(i,b));
+            }
+        }
+    }
+    void assemble_jacobi(const vector_type &x, matrix_type &jacobi)const
+    {
+        jacobi_calls++;
+        for(int i = 0; i < dim; ++i)
+        {
+            for(int j = 0; j < dim; ++j)
+            {
+                T *jac_ij = jacobi.component(i,j);
+                for(std::size_t b = 0; b < n; ++b)
+                {
+                    jac_ij[b] = s[b]*A[i][j] + (i == j ? 3*c[b]*x(i,b)*x(i,b) : T(0));
+                }
+            }
+        }
+    }
+};
+
+int main(int argc, char const *args[])
+{
+    using log_t = scfd::utils::log_std;
+    using T = double;
+    using vec_sp_t = nmfd::operations::batched_static_vector_space<T, dim>;
+    using vec_t = typename vec_sp_t::vector_type;
+    using sys_op_t = batched_cubic_operator<vec_sp_t>;
+    using solver_t = nmfd::solvers::batched_newton<vec_sp_t, sys_op_t, log_t>;
+
+    int error = 0;
+    log_t log;
+    const std::size_t n = 10000, singular_lane = 17;
+    const T eps = 1e-10;
+
+    auto vec_sp = std::make_shared<vec_sp_t>(n);
+    sys_op_t sys_op;
+    sys_op.n = n;
+    vec_sp->init_vector(sys_op.u);
+    vec_sp->init_lanes(sys_op.s, T(1));
+    vec_sp->init_lanes(sys_op.c);
+    for(std::size_t b = 0; b < n; ++b)
+    {
+        for(int i = 0; i < dim; ++i)
+        {
+            vec_sp->set_value_at_point(std::sin(T(1) + i + 0.37*b), i, b, sys_op.u);
+        }
+        sys_op.c[b] = 0.05 + 0.3*(b%7)/7.;
+    }
+    sys_op.s[singular_lane] = T(0);
+
+    vec_t x, f;
+    vec_sp->init_vectors(x, f);
+
+    log.info("test batched_newton");
+    solver_t::params prm;
+    prm.abs_tol = eps;
+    prm.verbose = true;
+    solver_t solver(vec_sp, &log, prm);
+    vec_sp->assign_scalar(T(0), x);
+    bool res = solver.solve(sys_op, x);
+    if (res)
+    {
+        log.error("singular system is reported as converged!!");
+        error++;
+    }
+    int iters_max = 0;
+    T err_max = T(0);
+    std::size_t failed_num = 0;
+    for(std::size_t b = 0; b < n; ++b)
+    {
+        if (b == singular_lane)
+        {
+            if ((solver.lane_status(b) != solver_t::status_singular_jacobi)||(vec_sp->get_value_at_point(0, b, x) != T(0)))
+            {
+                log.error("singular system is not detected!!");
+                error++;
+            }
+            continue;
+        }
+        if (solver.lane_status(b) != solver_t::status_converged)
+        {
+            failed_num++;
+            continue;
+        }
+        for(int i = 0; i < dim; ++i)
+        {
+            err_max = std::max(err_max, std::abs(x(i,b) - sys_op.u(i,b)));
+        }
+        iters_max = std::max(iters_max, solver.lane_iterations(b));
+    }
+    /// with x = 0 initial guess all systems need pivoting on the first step
+    log.info_f(
+        "failed systems: %zu, max solution error: %e, max iterations: %i, batched residual evaluations: %i, batched jacobian evaluations: %i",
+        failed_num, err_max, iters_max, sys_op.apply_calls, sys_op.jacobi_calls
+    );
+    if ((failed_num > 0)||(err_max > 1e-8)||(iters_max > 30))
+    {
+        log.error("Failed to converge!!");
+        error++;
+    }
+
+    log.info("test batched_newton with distant initial guess");
+    sys_op.s[singular_lane] = T(1);
+    sys_op.apply_calls = 0;
+    sys_op.jacobi_calls = 0;
+    vec_sp->assign_scalar(T(1), x);
+    res = solver.solve(sys_op, x);
+    vec_sp->add_lin_comb(T(-1), sys_op.u, T(1), x);
+    T err_inf = T(0);
+    for(std::size_t b = 0; b < n; ++b)
+    {
+        for(int i = 0; i < dim; ++i)
+        {
+            err_inf = std::max(err_inf, std::abs(x(i,b)));
+        }
+    }
+    /// some systems need damped steps: extra residual evaluations are batched too
+    log.info_f(
+        "max solution error: %e, batched residual evaluations: %i, batched jacobian evaluations: %i",
+        err_inf, sys_op.apply_calls, sys_op.jacobi_calls
+    );
+    if ((!res)||(err_inf > 1e-8)||(sys_op.apply_calls <= sys_op.jacobi_calls + 1))
+    {
+        log.error("Failed to converge with damping!!");
+        error++;
+    }
+
+    log.info("test batched_newton restart from the solution");
+    sys_op.jacobi_calls = 0;
+    vec_sp->assign(sys_op.u, x);
+    res = solver.solve(sys_op, x);
+    if ((!res)||(sys_op.jacobi_calls != 0)||(solver.lane_iterations(0) != 0))
+    {
+        log.error("Solution is not recognized as converged!!");
+        error++;
+    }
+
+    vec_sp->free_vectors(x, f);
+
+    if(error > 0)
+    {
+        log.error_f("Got error = %d.", error ) ;
+    }
+    else
+    {
+        log.info("No errors.") ;
+    }
+
+    return error;
+}
@@ -0,0 +1,261 @@
+#include <memory>
+#include <cmath>
+#include <scfd/utils/log.h>
+#include "cpu_vector_space.h"
+#include "linear_operator_advection.h"
+#include "linear_operator_diffusion.h"
+#include "preconditioner_advection.h"
+#include "preconditioner_diffusion.h"
+#include <nmfd/solvers/monitor_krylov.h>
+#include <nmfd/solvers/gmres.h>
+#include <nmfd/solvers/block_gmres.h>
+#include <nmfd/solvers/dense1_extended_solver.h>
+
+#define M_PIl 3.141592653589793238462643383279502884L
+
+
+
+int main(int argc, char const *args[])
+{
+    using log_t = scfd::utils::log_std;
+    using T = double;
+    using T_vec = double*;
+    using vec_ops_t = nmfd::cpu_vector_space<T, T_vec, log_t>;
+    using T_mvec = typename vec_ops_t::multivector_type;
+    using lin_op_adv_t = tests::linear_operator_advection<vec_ops_t, log_t>;
+    using lin_op_diff_t = tests::linear_operator_diffusion<vec_ops_t, log_t>;
+    using prec_adv_t = tests::preconditioner_advection<vec_ops_t, lin_op_adv_t, log_t>;
+    using prec_diff_t = tests::preconditioner_diffusion<vec_ops_t, lin_op_diff_t, log_t>;
+    using monitor_t = nmfd::solvers::monitor_krylov<vec_ops_t, log_t>;
+    using gmres_adv_t = nmfd::solvers::block_gmres< vec_ops_t, monitor_t, log_t, lin_op_adv_t, prec_adv_t >;
+    using gmres_diff_t = nmfd::solvers::block_gmres< vec_ops_t, monitor_t, log_t, lin_op_diff_t, prec_diff_t >;
+    using gmres_diff_noprec_t = nmfd::solvers::block_gmres< vec_ops_t, monitor_t, log_t, lin_op_diff_t >;
+    using single_gmres_diff_noprec_t = nmfd::solvers::gmres< vec_ops_t, monitor_t, log_t, lin_op_diff_t >;
+    using ext_op_t = nmfd::operations::dense1_extended_operator<lin_op_diff_t, vec_ops_t>;
+    using ext_solver_t = nmfd::solvers::dense1_extended_solver<gmres_diff_noprec_t, lin_op_diff_t, vec_ops_t>;
+
+    int error = 0;
+    log_t log;
+    log.info("test block_gmres");
+    std::size_t N_with_preconds = 500;
+    std::size_t N_with_no_preconds = 100;
+    std::shared_ptr<vec_ops_t> vec_ops;
+
+    auto check_residual = [&log, &vec_ops](auto& A, auto& x, auto &y, T tol)
+    {
+        T_vec resid;
+        vec_ops->init_vector(resid);
+        vec_ops->start_use_vector(resid);
+        A.apply(x,resid);
+        vec_ops->add_lin_comb(1,y,-1,resid);
+        T res_norm = vec_ops->norm(resid), rhs_norm = vec_ops->norm(y);
+        log.info_f("||Lx-y|| = %e", res_norm );
+        vec_ops->stop_use_vector(resid);
+        vec_ops->free_vector(resid);
+        return (res_norm <= tol*rhs_norm ? 0 : 1);
+    };
+    auto check_residuals = [&vec_ops, &check_residual](auto& A, T_mvec& X, T_mvec &Y, int n, T tol)
+    {
+        int res = 0;
+        T_vec x, y;
+        vec_ops->init_vector(x);
+        vec_ops->init_vector(y);
+        vec_ops->start_use_vector(x);
+        vec_ops->start_use_vector(y);
+        for(int l = 0; l < n; l++)
+        {
+            vec_ops->assign(X, n, l, x);
+            vec_ops->assign(Y, n, l, y);
+            res += check_residual(A, x, y, tol);
+        }
+        vec_ops->stop_use_vector(x);
+        vec_ops->stop_use_vector(y);
+        vec_ops->free_vector(x);
+        vec_ops->free_vector(y);
+        return res;
+    };
+    auto fill_rhs = [&vec_ops](T_mvec &Y, std::size_t N)
+    {
+        T_vec y;
+        vec_ops->init_vector(y);
+        vec_ops->start_use_vector(y);
+        for(int l = 0; l < 2; l++)
+        {
+            for(int j=0;j<N;j++)
+            {
+                y[j] = std::sin((1.0+2*l)*j/(N-1)*M_PIl) + 0.1*std::sin((7.0-3*l)*j/(N-1)*M_PIl);
+            }
+            y[0] = y[N-1] = 0;
+            vec_ops->assign(y, Y, 2, l);
+        }
+        vec_ops->stop_use_vector(y);
+        vec_ops->free_vector(y);
+    };
+
+    //testing left and right preconditioners
+    {
+        std::size_t N = N_with_preconds;
+        vec_ops = std::make_shared<vec_ops_t>(N);
+        auto prec_diff = std::make_shared<prec_diff_t>(vec_ops, 15);
+        auto prec_adv = std::make_shared<prec_adv_t>(vec_ops, 1);
+
+        T tau = 1.0;
+        T a = 1.0;
+        T_mvec X,Y;
+        vec_ops->init_multivector(X, 2);
+        vec_ops->init_multivector(Y, 2);
+        vec_ops->start_use_multivector(X, 2);
+        vec_ops->start_use_multivector(Y, 2);
+        fill_rhs(Y, N);
+
+        log.info_f("=>diffusion with size %i, timestep %.02f.", vec_ops->size(), tau );
+        auto lin_op_diff = std::make_shared<lin_op_diff_t>(*vec_ops, tau);
+
+        gmres_diff_t::params params_diff;
+        params_diff.monitor.rel_tol = 1.0e-10;
+        params_diff.monitor.max_iters_num = 300;
+        params_diff.basis_size = 40;
+        params_diff.block_size = 2;
+        for(char side: {'L', 'R'})
+        {
+            log.info_f("%c preconditioner", side);
+            params_diff.preconditioner_side = side;
+            gmres_diff_t gmres(lin_op_diff, vec_ops, &log, params_diff, prec_diff);
+
+            for(int l = 0; l < 2; l++) vec_ops->assign_scalar(0.0, X[l]);
+            bool res = gmres.solve_multi(Y, X, 2);
+            error += (!res);
+            log.info_f("block_gmres res: %s", res?"true":"false");
+            error += check_residuals(*lin_op_diff, X, Y, 2, 1.0e-8);
+        }
+
+        log.info_f("=>advection with size %i, speed %.02f, timestep %.02f.", vec_ops->size(), a, tau );
+        gmres_adv_t::params params_adv;
+        params_adv.monitor.rel_tol = 1.0e-10;
+        params_adv.monitor.max_iters_num = 300;
+        params_adv.basis_size = 30;
+        params_adv.block_size = 2;
+        auto lin_op_adv = std::make_shared<lin_op_adv_t>(*vec_ops, a, tau);
+        for(char side: {'L', 'R'})
+        {
+            log.info_f("%c preconditioner", side);
+            params_adv.preconditioner_side = side;
+            gmres_adv_t gmres(lin_op_adv, vec_ops, &log, params_adv, prec_adv);
+
+            for(int l = 0; l < 2; l++) vec_ops->assign_scalar(0.0, X[l]);
+            bool res = gmres.solve_multi(Y, X, 2);
+            error += (!res);
+            log.info_f("block_gmres res: %s", res?"true":"false");
+            error += check_residuals(*lin_op_adv, X, Y, 2, 1.0e-8);
+        }
+
+        vec_ops->stop_use_multivector(X, 2);
+        vec_ops->stop_use_multivector(Y, 2);
+        vec_ops->free_multivector(X, 2);
+        vec_ops->free_multivector(Y, 2);
+    }
+    //no preconditioner: block solve must take fewer operator sweeps than two separate gmres solves with the same memory
+    {
+        std::size_t N = N_with_no_preconds;
+        vec_ops = std::make_shared<vec_ops_t>(N);
+        T tau = 1.0;
+        T_mvec X,Y;
+        vec_ops->init_multivector(X, 2);
+        vec_ops->init_multivector(Y, 2);
+        vec_ops->start_use_multivector(X, 2);
+        vec_ops->start_use_multivector(Y, 2);
+        fill_rhs(Y, N);
+
+        log.info_f("=>diffusion with size %i, timestep %.02f.", vec_ops->size(), tau );
+        auto lin_op_diff = std::make_shared<lin_op_diff_t>(*vec_ops, tau);
+
+        single_gmres_diff_noprec_t::params params_single;
+        params_single.monitor.rel_tol = 1.0e-10;
+        params_single.monitor.max_iters_num = 5000;
+        params_single.basis_size = 20;
+        single_gmres_diff_noprec_t gmres(lin_op_diff, vec_ops, &log, params_single);
+        int iters_num_single = 0;
+        for(int l = 0; l < 2; l++)
+        {
+            vec_ops->assign_scalar(0.0, X[l]);
+            bool res = gmres.solve(Y[l], X[l]);
+            error += (!res);
+            iters_num_single += gmres.monitor().iters_performed();
+            log.info_f("gmres res: %s, iterations %i", res?"true":"false", gmres.monitor().iters_performed());
+        }
+        error += check_residuals(*lin_op_diff, X, Y, 2, 1.0e-8);
+
+        gmres_diff_noprec_t::params params_block;
+        params_block.monitor.rel_tol = 1.0e-10;
+        params_block.monitor.max_iters_num = 5000;
+        params_block.basis_size = 40;
+        params_block.block_size = 2;
+        gmres_diff_noprec_t block_gmres(lin_op_diff, vec_ops, &log, params_block);
+        for(int l = 0; l < 2; l++) vec_ops->assign_scalar(0.0, X[l]);
+        bool res = block_gmres.solve_multi(Y, X, 2);
+        error += (!res);
+        int block_steps = std::max(block_gmres.monitor(0).iters_performed(), block_gmres.monitor(1).iters_performed());
+        log.info_f("block_gmres res: %s, block steps %i, separate gmres iterations %i", res?"true":"false", block_steps, iters_num_single);
+        error += check_residuals(*lin_op_diff, X, Y, 2, 1.0e-8);
+        if(block_steps >= iters_num_single)
+        {
+            log.error_f("block solve did not reduce number of operator sweeps: %i vs %i", block_steps, iters_num_single);
+            error++;
+        }
+
+        //linearly dependent right hand sides: second one is postponed and solved in the next cycle
+        log.info("dependent right hand sides");
+        vec_ops->assign_lin_comb(2.0, Y[0], Y[1]);
+        for(int l = 0; l < 2; l++) vec_ops->assign_scalar(0.0, X[l]);
+        res = block_gmres.solve_multi(Y, X, 2);
+        error += (!res);
+        log.info_f("block_gmres res: %s", res?"true":"false");
+        error += check_residuals(*lin_op_diff, X, Y, 2, 1.0e-8);
+
+        //single right hand side through ordinary solve interface
+        log.info("single right hand side");
+        vec_ops->assign_scalar(0.0, X[0]);
+        res = block_gmres.solve(Y[0], X[0]);
+        error += (!res);
+        log.info_f("block_gmres res: %s", res?"true":"false");
+        error += check_residual(*lin_op_diff, X[0], Y[0], 1.0e-8);
+
+        //bordered system [A u;v^T w][x;y] = [b;beta]: both inner systems are solved with one solve_multi call
+        log.info("bordered system with dense1_extended_solver");
+        {
+            fill_rhs(Y, N);
+            T_vec u = Y[1], v = Y[0], b = Y[0];
+            std::array<T,1> w = {1.0}, beta = {0.5}, y = {0.0};
+            auto ext_op = std::make_shared<ext_op_t>(vec_ops, lin_op_diff, u, v, w);
+            auto ext_solver = std::make_shared<ext_solver_t>(vec_ops, std::make_shared<gmres_diff_noprec_t>(vec_ops, &log, params_block), ext_op);
+            vec_ops->assign_scalar(0.0, X[0]);
+            std::pair<T_vec,std::array<T,1>> rhs = {b, beta}, sol = {X[0], y};
+            res = ext_solver->solve(rhs, sol);
+            error += (!res);
+            log.info_f("dense1_extended_solver res: %s", res?"true":"false");
+            //x satisfies A*x = b - u*y and v^T*x + w*y = beta
+            vec_ops->assign(b, X[1]);
+            vec_ops->add_lin_comb(-sol.second[0], u, 1.0, X[1]);
+            error += check_residual(*lin_op_diff, X[0], X[1], 1.0e-8);
+            T border_resid = vec_ops->scalar_prod(v, X[0]) + w[0]*sol.second[0] - beta[0];
+            log.info_f("border residual = %e", border_resid);
+            error += (std::abs(border_resid) > 1.0e-8);
+        }
+
+        vec_ops->stop_use_multivector(X, 2);
+        vec_ops->stop_use_multivector(Y, 2);
+        vec_ops->free_multivector(X, 2);
+        vec_ops->free_multivector(Y, 2);
+    }
+
+    if(error > 0)
+    {
+        log.error_f("Got error = %e.", error ) ;
+    }
+    else
+    {
+        log.info("No errors.") ;
+    }
+
+    return error;
+}
@@ -0,0 +1,204 @@
+#include <memory>
+#include <cmath>
+#include <scfd/utils/log.h>
+#include <scfd/backend/backend.h>
+#include <nmfd/operations/detail/scfd_array_traits.h>
+#include <nmfd/operations/dense_vector_space.h>
+#include <nmfd/operations/jfnk_operator.h>
+#include <nmfd/solvers/monitor_krylov.h>
+#include <nmfd/solvers/gmres.h>
+#include <nmfd/solvers/nonlinear_solver.h>
+#include <nmfd/solvers/broyden_iteration.h>
+
+/// F(u) = u - G(u), G(u) = a*S(u) + c*cos(u) + 1, S is 3 point averaging with zero boundary values;
+/// jacobian is close to identity, so identity initial jacobian is reasonable
+template<class VectorOperations>
+class fixed_point_operator
+{
+public:
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+
+    fixed_point_operator(const VectorOperations& vec_ops, scalar_type a, scalar_type c) :
+        vec_ops_(vec_ops), N_(vec_ops.size()), a_(a), c_(c), apply_calls(0)
+    {
+    }
+    void apply(const vector_type& x, vector_type& f)const
+    {
+        apply_calls++;
+        const scalar_type *x_ = vec_ops_.get_raw_ptr(x);
+        scalar_type *f_ = vec_ops_.get_raw_ptr(f);
+        for(std::size_t j = 0; j < N_; j++)
+        {
+            scalar_type x_l = (j>0 ? x_[j-1] : scalar_type(0)), x_r = (j<N_-1 ? x_[j+1] : scalar_type(0));
+            f_[j] = x_[j] - (a_*(x_l + x_[j] + x_r)/3 + c_*std::cos(x_[j]) + scalar_type(1));
+        }
+    }
+
+    mutable int apply_calls;
+private:
+    const VectorOperations& vec_ops_;
+    std::size_t N_;
+    scalar_type a_, c_;
+};
+
+/// F(u) = -u'' + u^3 - 1 on uniform grid with zero boundary values; only residual is provided, no jacobian
+template<class VectorOperations>
+class dense_cubic_diffusion_operator
+{
+public:
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+
+    dense_cubic_diffusion_operator(const VectorOperations& vec_ops) :
+        vec_ops_(vec_ops), N_(vec_ops.size()), apply_calls(0)
+    {
+        h_ = scalar_type(1)/static_cast<scalar_type>(N_+1);
+    }
+    void apply(const vector_type& x, vector_type& f)const
+    {
+        apply_calls++;
+        const scalar_type *x_ = vec_ops_.get_raw_ptr(x);
+        scalar_type *f_ = vec_ops_.get_raw_ptr(f);
+        for(std::size_t j = 0; j < N_; j++)
+        {
+            scalar_type x_l = (j>0 ? x_[j-1] : scalar_type(0)), x_r = (j<N_-1 ? x_[j+1] : scalar_type(0));
+            f_[j] = (2*x_[j] - x_l - x_r)/h_/h_ + 100*x_[j]*x_[j]*x_[j] - scalar_type(100);
+        }
+    }
+
+    mutable int apply_calls;
+private:
+    const VectorOperations& vec_ops_;
+    std::size_t N_;
+    scalar_type h_;
+};
+
+int main(int argc, char const *args[])
+{
+    using log_t = scfd::utils::log_std;
+    using backend_t = scfd::backend::current;
+    using memory_t = backend_t::memory_type;
+    using T = double;
+    using vec_ops_t = nmfd::operations::dense_vector_space<nmfd::operations::detail::scfd_array_traits<T, memory_t>, backend_t>;
+    using T_vec = typename vec_ops_t::vector_type;
+    using fp_op_t = fixed_point_operator<vec_ops_t>;
+    using broyden_ident_t = nmfd::solvers::broyden_iteration<vec_ops_t, fp_op_t>;
+    using conv_strat_ident_t = nmfd::solvers::default_convergence_strategy<vec_ops_t, log_t, fp_op_t>;
+    using solver_ident_t = nmfd::solvers::nonlinear_solver<vec_ops_t, log_t, fp_op_t, broyden_ident_t>;
+    using diff_op_t = dense_cubic_diffusion_operator<vec_ops_t>;
+    using system_op_t = nmfd::operations::jfnk_system_operator<vec_ops_t, diff_op_t>;
+    using jfnk_op_t = typename system_op_t::jacobi_operator_type;
+    using monitor_t = nmfd::solvers::monitor_krylov<vec_ops_t, log_t>;
+    using gmres_t = nmfd::solvers::gmres<vec_ops_t, monitor_t, log_t, jfnk_op_t>;
+    using broyden_t = nmfd::solvers::broyden_iteration<vec_ops_t, system_op_t, gmres_t>;
+    using solver_t = nmfd::solvers::nonlinear_solver<vec_ops_t, log_t, system_op_t, broyden_t>;
+
+    int error = 0;
+    log_t log;
+    std::size_t N = 100;
+    const T eps = 1e-10;
+
+    auto vec_ops = std::make_shared<vec_ops_t>(N);
+    T_vec x, f;
+    vec_ops->init_vectors(x, f);
+
+    {
+        log.info("test broyden_iteration with identity initial jacobian");
+        fp_op_t fp_op(*vec_ops, 0.9, 0.05);
+        /// memory 0 is plain Picard iteration; memory 5 restarts several times
+        int iters_picard = 0;
+        for(int memory : {0, 5, 30})
+        {
+            log.info_f("memory: %i", memory);
+            broyden_ident_t::params prm;
+            prm.memory = memory;
+            auto broyden = std::make_shared<broyden_ident_t>(vec_ops, nullptr, prm);
+            conv_strat_ident_t::params conv_prm;
+            conv_prm.abs_tol = eps;
+            conv_prm.max_iters_num = 1000;
+            conv_prm.verbose = false;
+            auto conv_strat = std::make_shared<conv_strat_ident_t>(vec_ops, nullptr, conv_prm);
+            solver_ident_t solver(vec_ops, &log, broyden, conv_strat);
+            /// second solve checks that pairs of the first one are discarded
+            for(int attempt = 0; attempt < 2; ++attempt)
+            {
+                vec_ops->assign_scalar(T(0), x);
+                bool res = solver.solve(&fp_op, nullptr, nullptr, x);
+                int iters = conv_strat->get_number_of_iterations();
+                fp_op.apply(x, f);
+                T resid = vec_ops->norm(f);
+                log.info_f("res: %s, iterations: %i, residual norm: %e", res?"true":"false", iters, resid);
+                if ((!res)||(resid > eps))
+                {
+                    log.error("Failed to converge!!");
+                    error++;
+                }
+                if (memory == 0)
+                {
+                    iters_picard = iters;
+                }
+                else if (2*iters > iters_picard)
+                {
+                    log.error("Broyden iteration is too slow!!");
+                    error++;
+                }
+            }
+        }
+    }
+
+    {
+        log.info("test broyden_iteration with gmres for jfnk initial jacobian");
+        auto diff_op = std::make_shared<diff_op_t>(*vec_ops);
+        auto system_op = std::make_shared<system_op_t>(vec_ops, diff_op);
+        gmres_t::params params_gmres;
+        params_gmres.monitor.rel_tol = 1.0e-6;
+        params_gmres.monitor.max_iters_num = 300;
+        params_gmres.basis_size = 100;
+        for(bool refresh_on_restart : {false, true})
+        {
+            log.info_f("refresh_on_restart: %s", refresh_on_restart?"true":"false");
+            broyden_t::params prm;
+            prm.memory = 4;
+            prm.refresh_on_restart = refresh_on_restart;
+            auto gmres = std::make_shared<gmres_t>(vec_ops, &log, params_gmres);
+            auto broyden = std::make_shared<broyden_t>(vec_ops, gmres, prm);
+            auto solver = std::make_shared<solver_t>(vec_ops, &log, broyden);
+            solver->convergence_strategy()->set_tolerance(eps);
+            vec_ops->assign_scalar(T(0), x);
+            bool res = solver->solve(system_op.get(), nullptr, nullptr, x);
+            int iters = solver->convergence_strategy()->get_number_of_iterations();
+            int setups = broyden->initial_jacobian_setups_num();
+            diff_op->apply(x, f);
+            T resid = vec_ops->norm(f);
+            log.info_f(
+                "res: %s, residual norm: %e, iterations: %i, initial jacobian setups: %i",
+                res?"true":"false", resid, iters, setups
+            );
+            if ((!res)||(resid > eps))
+            {
+                log.error("Failed to converge!!");
+                error++;
+            }
+            /// jacobian is linearized once per solve or once per restart, not on every iteration
+            if ((!refresh_on_restart && setups != 1)||(refresh_on_restart && (setups < 2 || setups >= iters)))
+            {
+                log.error("Wrong number of initial jacobian setups!!");
+                error++;
+            }
+        }
+    }
+
+    vec_ops->free_vectors(x, f);
+
+    if(error > 0)
+    {
+        log.error_f("Got error = %d.", error ) ;
+    }
+    else
+    {
+        log.info("No errors.") ;
+    }
+
+    return error;
+}
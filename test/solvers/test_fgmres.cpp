@@ -0,0 +1,147 @@
+#include <memory>
+#include <cmath>
+#include <string>
+#include <scfd/utils/log.h>
+#include "cpu_vector_space.h"
+#include "linear_operator_advection.h"
+#include "linear_operator_diffusion.h"
+#include "preconditioner_advection.h"
+#include "preconditioner_diffusion.h"
+#include "preconditioner_inner_solver.h"
+#include <nmfd/solvers/monitor_krylov.h>
+#include <nmfd/solvers/gmres.h>
+#include <nmfd/solvers/fgmres.h>
+
+#define M_PIl 3.141592653589793238462643383279502884L
+
+
+
+int main(int argc, char const *args[])
+{
+    using log_t = scfd::utils::log_std;
+    using T = double;
+    using T_vec = double*;
+    using vec_ops_t = nmfd::cpu_vector_space<T, T_vec, log_t>;
+    using lin_op_adv_t = tests::linear_operator_advection<vec_ops_t, log_t>;
+    using lin_op_diff_t = tests::linear_operator_diffusion<vec_ops_t, log_t>;
+    using prec_adv_t = tests::preconditioner_advection<vec_ops_t, lin_op_adv_t, log_t>;
+    using prec_diff_t = tests::preconditioner_diffusion<vec_ops_t, lin_op_diff_t, log_t>;
+    using monitor_t = nmfd::solvers::monitor_krylov<vec_ops_t, log_t>;
+    using fgmres_adv_t = nmfd::solvers::fgmres< vec_ops_t, monitor_t, log_t, lin_op_adv_t, prec_adv_t >;
+    using fgmres_diff_t = nmfd::solvers::fgmres< vec_ops_t, monitor_t, log_t, lin_op_diff_t, prec_diff_t >;
+    using inner_gmres_t = nmfd::solvers::gmres< vec_ops_t, monitor_t, log_t, lin_op_diff_t, prec_diff_t >;
+    using prec_inner_t = tests::preconditioner_inner_solver<vec_ops_t, lin_op_diff_t, inner_gmres_t>;
+    using fgmres_inner_t = nmfd::solvers::fgmres< vec_ops_t, monitor_t, log_t, lin_op_diff_t, prec_inner_t >;
+
+    int error = 0;
+    log_t log;
+    log.info("test fgmres");
+    std::size_t N = 500;
+    std::shared_ptr<vec_ops_t> vec_ops = std::make_shared<vec_ops_t>(N);
+
+    auto get_residual = [&log, &vec_ops](auto& A, auto& x, auto &y) 
+    {
+        T_vec resid;
+        vec_ops->init_vector(resid);
+        vec_ops->start_use_vector(resid);
+        A.apply(x,resid);
+        vec_ops->add_lin_comb(1,y,-1,resid);
+        log.info_f("||Lx-y|| = %e", vec_ops->norm(resid) );
+        vec_ops->stop_use_vector(resid);
+        vec_ops->free_vector(resid);
+    };
+
+    T tau = 1.0;
+    T a = 1.0;
+    T_vec x,y;
+    vec_ops->init_vector(x);
+    vec_ops->init_vector(y);        
+    vec_ops->start_use_vector(x);
+    vec_ops->start_use_vector(y);
+    for(int j=0;j<N;j++)
+    {
+        y[j] = std::sin(1.0*j/(N-1)*M_PIl);
+    }
+    y[0] = y[N-1] = 0;
+
+    auto lin_op_diff = std::make_shared<lin_op_diff_t>(*vec_ops, tau);
+    auto lin_op_adv = std::make_shared<lin_op_adv_t>(*vec_ops, a, tau);
+
+    //fixed preconditioners
+    {
+        auto prec_diff = std::make_shared<prec_diff_t>(vec_ops, 15);
+        log.info_f("=>diffusion with size %i, timestep %.02f.", vec_ops->size(), tau ); 
+        fgmres_diff_t::params params_diff;
+        params_diff.monitor.rel_tol = 1.0e-10;
+        params_diff.monitor.max_iters_num = 300;
+        params_diff.basis_size = 25;
+        for(std::string orth: {"mgs", "cgs2"})
+        {
+            params_diff.orthogonalization = orth;
+            fgmres_diff_t fgmres(lin_op_diff, vec_ops, &log, params_diff, prec_diff);
+
+            vec_ops->assign_scalar(0.0, x);
+            bool res = fgmres.solve(y, x);
+            error += (!res);
+            log.info_f("fgmres (%s) res: %s", orth.c_str(), res?"true":"false");
+            log.info(" reusing the solution...");
+            vec_ops->add_mul_scalar(0.0, 0.99999, x);
+            res = fgmres.solve(y, x);
+            error += (!res);
+            log.info_f("fgmres (%s) res with x0: %s", orth.c_str(), res?"true":"false");
+            get_residual(*lin_op_diff, x, y);
+        }
+
+        auto prec_adv = std::make_shared<prec_adv_t>(vec_ops, 1);
+        log.info_f("=>advection with size %i, speed %.02f, timestep %.02f.", vec_ops->size(), a, tau ); 
+        fgmres_adv_t::params params_adv;
+        params_adv.monitor.rel_tol = 1.0e-10;
+        params_adv.monitor.max_iters_num = 300;
+        params_adv.basis_size = 15;    
+        fgmres_adv_t fgmres(lin_op_adv, vec_ops, &log, params_adv, prec_adv);
+        vec_ops->assign_scalar(0.0, x);       
+        bool res = fgmres.solve(y, x);
+        error += (!res);
+        log.info_f("fgmres res: %s", res?"true":"false");
+        get_residual(*lin_op_adv, x, y);             
+    }
+
+    //variable preconditioner: few iterations of inner preconditioned gmres
+    {
+        log.info_f("=>diffusion with size %i, timestep %.02f, inner gmres preconditioner.", vec_ops->size(), tau ); 
+        inner_gmres_t::params params_inner("fgmres::", "inner_gmres::");
+        params_inner.monitor.rel_tol = 1.0e-2;
+        params_inner.monitor.max_iters_num = 3;
+        params_inner.basis_size = 3;
+        auto inner_gmres = std::make_shared<inner_gmres_t>(vec_ops, nullptr, params_inner, std::make_shared<prec_diff_t>(vec_ops, 15));
+        auto prec_inner = std::make_shared<prec_inner_t>(vec_ops, inner_gmres);
+
+        fgmres_inner_t::params params_diff;
+        params_diff.monitor.rel_tol = 1.0e-10;
+        params_diff.monitor.max_iters_num = 100;
+        params_diff.basis_size = 20;
+        fgmres_inner_t fgmres(lin_op_diff, vec_ops, &log, params_diff, prec_inner);
+
+        vec_ops->assign_scalar(0.0, x);
+        bool res = fgmres.solve(y, x);
+        error += (!res);
+        log.info_f("fgmres res: %s", res?"true":"false");
+        get_residual(*lin_op_diff, x, y);
+    }
+
+    vec_ops->stop_use_vector(x);
+    vec_ops->stop_use_vector(y);
+    vec_ops->free_vector(x);
+    vec_ops->free_vector(y);
+
+    if(error > 0)
+    {
+        log.error_f("Got error = %e.", error ) ;
+    }
+    else
+    {
+        log.info("No errors.") ;   
+    }
+
+    return error;
+}
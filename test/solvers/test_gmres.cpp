@@ -1,5 +1,6 @@
 #include <memory>
 #include <cmath>
+#include <string>
 #include <scfd/utils/log.h>
 #include "cpu_vector_space.h"
 #include "linear_operator_advection.h"
@@ -241,6 +242,48 @@ int main(int argc, char const *args[])
 
 
 
+    //testing classical Gram-Schmidt variants based on batched multivector operations
+    {
+        std::size_t N = N_with_preconds;
+        vec_ops = std::make_shared<vec_ops_t>(N);
+        auto prec_diff = std::make_shared<prec_diff_t>(vec_ops, 15);
+        T tau = 1.0;
+        T_vec x,y;
+        vec_ops->init_vector(x);
+        vec_ops->init_vector(y);
+        vec_ops->start_use_vector(x);
+        vec_ops->start_use_vector(y);
+
+        auto lin_op_diff = std::make_shared<lin_op_diff_t>(*vec_ops, tau);
+        for(int j=0;j<N;j++)
+        {
+            y[j] = std::sin(1.0*j/(N-1)*M_PIl);
+        }
+        y[0] = y[N-1] = 0;
+
+        gmres_diff_t::params params_diff;
+        params_diff.monitor.rel_tol = 1.0e-10;
+        params_diff.monitor.max_iters_num = 300;
+        params_diff.basis_size = 25;
+        for(std::string orth: {"cgs", "cgs2"})
+        {
+            log.info_f("=>diffusion with size %i, timestep %.02f, %s orthogonalization.", vec_ops->size(), tau, orth.c_str() );
+            params_diff.orthogonalization = orth;
+            gmres_diff_t gmres(lin_op_diff, vec_ops, &log, params_diff, prec_diff);
+
+            vec_ops->assign_scalar(0.0, x);
+            bool res = gmres.solve(y, x);
+            error += (!res);
+            log.info_f("pRgmres res: %s", res?"true":"false");
+            get_residual(*lin_op_diff, x, y);
+        }
+
+        vec_ops->stop_use_vector(x);
+        vec_ops->stop_use_vector(y);
+        vec_ops->free_vector(x);
+        vec_ops->free_vector(y);
+    }
+
     //testing elliptic operator with constant kernel
     {
         std::size_t N = N_with_preconds;
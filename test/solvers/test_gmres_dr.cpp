@@ -0,0 +1,184 @@
+#include <memory>
+#include <cmath>
+#include <scfd/utils/log.h>
+#include "cpu_vector_space.h"
+#include "linear_operator_advection.h"
+#include "linear_operator_diffusion.h"
+#include "preconditioner_advection.h"
+#include "preconditioner_diffusion.h"
+#include <nmfd/solvers/monitor_krylov.h>
+#include <nmfd/solvers/gmres_dr.h>
+
+#define M_PIl 3.141592653589793238462643383279502884L
+
+
+
+int main(int argc, char const *args[])
+{
+    using log_t = scfd::utils::log_std;
+    using T = double;
+    using T_vec = double*;
+    using vec_ops_t = nmfd::cpu_vector_space<T, T_vec, log_t>;
+    using lin_op_adv_t = tests::linear_operator_advection<vec_ops_t, log_t>;
+    using lin_op_diff_t = tests::linear_operator_diffusion<vec_ops_t, log_t>;
+    using prec_adv_t = tests::preconditioner_advection<vec_ops_t, lin_op_adv_t, log_t>;
+    using prec_diff_t = tests::preconditioner_diffusion<vec_ops_t, lin_op_diff_t, log_t>;
+    using monitor_t = nmfd::solvers::monitor_krylov<vec_ops_t, log_t>;
+    using gmres_adv_t = nmfd::solvers::gmres_dr< vec_ops_t, monitor_t, log_t, lin_op_adv_t, prec_adv_t >;
+    using gmres_diff_t = nmfd::solvers::gmres_dr< vec_ops_t, monitor_t, log_t, lin_op_diff_t, prec_diff_t >;
+    using gmres_diff_noprec_t = nmfd::solvers::gmres_dr< vec_ops_t, monitor_t, log_t, lin_op_diff_t >;
+
+    int error = 0;
+    log_t log;
+    log.info("test gmres_dr");
+    std::size_t N_with_preconds = 500;
+    std::size_t N_with_no_preconds = 100;
+    std::shared_ptr<vec_ops_t> vec_ops;
+
+    auto check_residual = [&log, &vec_ops](auto& A, auto& x, auto &y, T tol)
+    {
+        T_vec resid;
+        vec_ops->init_vector(resid);
+        vec_ops->start_use_vector(resid);
+        A.apply(x,resid);
+        vec_ops->add_lin_comb(1,y,-1,resid);
+        T res_norm = vec_ops->norm(resid), rhs_norm = vec_ops->norm(y);
+        log.info_f("||Lx-y|| = %e", res_norm );
+        vec_ops->stop_use_vector(resid);
+        vec_ops->free_vector(resid);
+        return (res_norm <= tol*rhs_norm ? 0 : 1);
+    };
+
+    //testing left and right preconditioners
+    {
+        std::size_t N = N_with_preconds;
+        vec_ops = std::make_shared<vec_ops_t>(N);
+        auto prec_diff = std::make_shared<prec_diff_t>(vec_ops, 15);
+        auto prec_adv = std::make_shared<prec_adv_t>(vec_ops, 1);
+
+        T tau = 1.0;
+        T a = 1.0;
+        T_vec x,y;
+        vec_ops->init_vector(x);
+        vec_ops->init_vector(y);
+        vec_ops->start_use_vector(x);
+        vec_ops->start_use_vector(y);
+
+        log.info_f("=>diffusion with size %i, timestep %.02f.", vec_ops->size(), tau );
+        auto lin_op_diff = std::make_shared<lin_op_diff_t>(*vec_ops, tau);
+
+        for(int j=0;j<N;j++)
+        {
+            y[j] = std::sin(1.0*j/(N-1)*M_PIl);
+        }
+        y[0] = y[N-1] = 0;
+
+        gmres_diff_t::params params_diff;
+        params_diff.monitor.rel_tol = 1.0e-10;
+        params_diff.monitor.max_iters_num = 300;
+        params_diff.basis_size = 25;
+        params_diff.deflation_size = 5;
+        for(char side: {'L', 'R'})
+        {
+            log.info_f("%c preconditioner", side);
+            params_diff.preconditioner_side = side;
+            gmres_diff_t gmres(lin_op_diff, vec_ops, &log, params_diff, prec_diff);
+
+            vec_ops->assign_scalar(0.0, x);
+            bool res = gmres.solve(y, x);
+            error += (!res);
+            log.info_f("gmres_dr res: %s", res?"true":"false");
+            log.info(" reusing the solution...");
+            vec_ops->add_mul_scalar(0.0, 0.99999, x);
+            res = gmres.solve(y, x);
+            error += (!res);
+            log.info_f("gmres_dr res with x0: %s", res?"true":"false");
+            error += check_residual(*lin_op_diff, x, y, 1.0e-8);
+        }
+
+        log.info_f("=>advection with size %i, speed %.02f, timestep %.02f.", vec_ops->size(), a, tau );
+        gmres_adv_t::params params_adv;
+        params_adv.monitor.rel_tol = 1.0e-10;
+        params_adv.monitor.max_iters_num = 300;
+        params_adv.basis_size = 15;
+        params_adv.deflation_size = 4;
+        auto lin_op_adv = std::make_shared<lin_op_adv_t>(*vec_ops, a, tau);
+        for(char side: {'L', 'R'})
+        {
+            log.info_f("%c preconditioner", side);
+            params_adv.preconditioner_side = side;
+            gmres_adv_t gmres(lin_op_adv, vec_ops, &log, params_adv, prec_adv);
+
+            vec_ops->assign_scalar(0.0, x);
+            bool res = gmres.solve(y, x);
+            error += (!res);
+            log.info_f("gmres_dr res: %s", res?"true":"false");
+            error += check_residual(*lin_op_adv, x, y, 1.0e-8);
+        }
+
+        vec_ops->stop_use_vector(x);
+        vec_ops->stop_use_vector(y);
+        vec_ops->free_vector(x);
+        vec_ops->free_vector(y);
+    }
+    //no preconditioner, several restarts: deflation must reduce the number of operator applications
+    {
+        std::size_t N = N_with_no_preconds;
+        vec_ops = std::make_shared<vec_ops_t>(N);
+        T tau = 1.0;
+        T_vec x,y;
+        vec_ops->init_vector(x);
+        vec_ops->init_vector(y);
+        vec_ops->start_use_vector(x);
+        vec_ops->start_use_vector(y);
+
+        log.info_f("=>diffusion with size %i, timestep %.02f.", vec_ops->size(), tau );
+        auto lin_op_diff = std::make_shared<lin_op_diff_t>(*vec_ops, tau);
+
+        for(int j=0;j<N;j++)
+        {
+            y[j] = std::sin(1.0*j/(N-1)*M_PIl) + 0.1*std::sin(7.0*j/(N-1)*M_PIl);
+        }
+        y[0] = y[N-1] = 0;
+        gmres_diff_noprec_t::params params_diff;
+        params_diff.monitor.rel_tol = 1.0e-10;
+        params_diff.monitor.max_iters_num = 5000;
+        params_diff.basis_size = 20;
+
+        int iters_num[2];
+        for(int deflation_size: {0, 6})
+        {
+            log.info_f("no preconditioner, deflation_size = %i", deflation_size);
+            params_diff.deflation_size = deflation_size;
+            gmres_diff_noprec_t gmres_diff(lin_op_diff, vec_ops, &log, params_diff);
+
+            vec_ops->assign_scalar(0.0, x);
+            bool res = gmres_diff.solve(y, x);
+            error += (!res);
+            iters_num[deflation_size > 0] = gmres_diff.monitor().iters_performed();
+            log.info_f("gmres_dr res: %s, iterations %i", res?"true":"false", iters_num[deflation_size > 0]);
+            error += check_residual(*lin_op_diff, x, y, 1.0e-8);
+        }
+        if(iters_num[1] >= iters_num[0])
+        {
+            log.error_f("deflated restarting did not reduce number of iterations: %i vs %i", iters_num[1], iters_num[0]);
+            error++;
+        }
+
+        vec_ops->stop_use_vector(x);
+        vec_ops->stop_use_vector(y);
+        vec_ops->free_vector(x);
+        vec_ops->free_vector(y);
+    }
+
+    if(error > 0)
+    {
+        log.error_f("Got error = %e.", error ) ;
+    }
+    else
+    {
+        log.info("No errors.") ;
+    }
+
+    return error;
+}
@@ -11,6 +11,7 @@
 #include <nmfd/preconditioners/mg.h>
 #include <nmfd/solvers/monitor_krylov.h>
 #include <nmfd/solvers/gmres.h>
+#include <nmfd/solvers/fgmres.h>
 #include "residual_regularization_test.h"
 
 #define M_PIl 3.141592653589793238462643383279502884L
@@ -41,6 +42,17 @@ int main(int argc, char const *args[])
     using monitor_t = nmfd::solvers::monitor_krylov<vec_ops_t, log_t>;
     using residual_reg_t = nmfd::solvers::detail::residual_regularization_test<vec_ops_t, log_t>;
     using gmres_elliptic_w_reg_t = nmfd::solvers::gmres< vec_ops_t, monitor_t, log_t, lin_op_elliptic_t, mg_t, residual_reg_t>;
+    using fgmres_elliptic_w_reg_t = nmfd::solvers::fgmres< vec_ops_t, monitor_t, log_t, lin_op_elliptic_t, mg_t, residual_reg_t>;
+    using prolongator_fused_t = tests::prolongator_fused<vec_ops_t, log_t>;
+    using restrictor_fused_t = tests::restrictor_fused<vec_ops_t, log_t>;
+    using coarsening_fused_t = tests::coarsening<lin_op_t, log_t, restrictor_fused_t, prolongator_fused_t>;
+    using smoother_fused_t = tests::smoother_elliptic_fused<vec_ops_t, log_t>;
+    using mg_fused_t = 
+        nmfd::preconditioners::mg
+        <
+            lin_op_t, restrictor_fused_t, prolongator_fused_t, smoother_fused_t, ident_op_t, coarsening_fused_t, log_t
+        >;
+    using gmres_elliptic_fused_t = nmfd::solvers::gmres< vec_ops_t, monitor_t, log_t, lin_op_elliptic_t, mg_fused_t, residual_reg_t>;
 
 
 
@@ -143,6 +155,174 @@ int main(int argc, char const *args[])
             log.info_f("solution final norm = %e", vec_ops->norm(x) );
             get_residual(*lin_op_elliptic, x, y, x_ref);
         }
+        {
+            log.info("operator update with hierarchy reuse");
+            mg_params_t mg_params_upd = mg_params;
+            mg_params_upd.coarse_freeze_updates = 1;
+            auto mg = std::make_shared<mg_t>(mg_utils, mg_params_upd);
+            params_elliptic.preconditioner_side = 'R';
+            gmres_elliptic_w_reg_t gmres(lin_op_elliptic, vec_ops, &log, params_elliptic, mg, residual_reg);
+            int next_level_calls = coarsening_t::next_level_calls(), coarse_operator_calls = coarsening_t::coarse_operator_calls();
+            /// first update only replaces the finest level operator (coarse levels are frozen), second refreshes coarse ones
+            for(int update = 1; update <= 2; ++update)
+            {
+                auto lin_op_new = std::make_shared<lin_op_elliptic_t>(*vec_ops);
+                gmres.set_operator(lin_op_new);
+                vec_ops->assign_scalar(0.0, x);
+                bool res = gmres.solve(y, x);
+                error += (!res);
+                int expected_coarse_operator_calls = (update == 1 ? 0 : static_cast<int>(mg->levels_num()) - 1);
+                log.info_f(
+                    "update %i: pRgmres res: %s, levels: %zu, coarse refreshes: %i", update, res?"true":"false",
+                    mg->levels_num(), mg->coarse_refreshes_num()
+                );
+                if ((coarsening_t::next_level_calls() != next_level_calls)||
+                    (coarsening_t::coarse_operator_calls() - coarse_operator_calls != expected_coarse_operator_calls))
+                {
+                    log.error("mg hierarchy is not reused!!");
+                    error++;
+                }
+            }
+            get_residual(*lin_op_elliptic, x, y, x_ref);
+        }
+        {
+            log.info("fused level kernels");
+            /// both cycles are mathematically the same, so preconditioner actions must coincide up to roundoff
+            /// (gmres iterations may not: convergence tail of the periodic problem is roundoff sensitive)
+            T_vec mg_y[2], z;
+            vec_ops->init_vector(z);
+            vec_ops->start_use_vector(z);
+            for(int j=0;j<N;j++)
+            {
+                z[j] = std::sin(T(j)*T(j)/N) - std::sin(T(j+1)*T(j+1)/N);
+            }
+            for(int fused = 0; fused <= 1; ++fused)
+            {
+                mg_fused_t::params_hierarchy mg_params_fused;
+                mg_params_fused.direct_coarse = false;
+                mg_params_fused.num_sweeps_pre = 3;
+                mg_params_fused.num_sweeps_post = 3;
+                mg_params_fused.fused_kernels = (fused == 1);
+                mg_fused_t::utils_hierarchy mg_utils_fused;
+                mg_utils_fused.log = &log;
+                auto mg = std::make_shared<mg_fused_t>(mg_utils_fused, mg_params_fused);
+                gmres_elliptic_fused_t::params params_fused;
+                params_fused.monitor.rel_tol = params_elliptic.monitor.rel_tol;
+                params_fused.monitor.max_iters_num = params_elliptic.monitor.max_iters_num;
+                params_fused.basis_size = params_elliptic.basis_size;
+                params_fused.reorthogonalization = params_elliptic.reorthogonalization;
+                params_fused.preconditioner_side = 'R';
+                gmres_elliptic_fused_t gmres(lin_op_elliptic, vec_ops, &log, params_fused, mg, residual_reg);
+                vec_ops->assign_scalar(0.0, x);
+                bool res = gmres.solve(y, x);
+                error += (!res);
+                log.info_f(
+                    "fused_kernels = %i: pRgmres res: %s, iterations: %i", fused, res?"true":"false",
+                    gmres.monitor().iters_performed()
+                );
+                vec_ops->init_vector(mg_y[fused]);
+                vec_ops->start_use_vector(mg_y[fused]);
+                mg->apply(z, mg_y[fused]);
+            }
+            T mg_y_norm = vec_ops->norm(mg_y[0]);
+            vec_ops->add_lin_comb(T(1), mg_y[1], -T(1), mg_y[0]);
+            T mg_y_diff = vec_ops->norm(mg_y[0]);
+            log.info_f("||mg_fused(z) - mg(z)||/||mg(z)|| = %e", mg_y_diff/mg_y_norm);
+            if (!(mg_y_diff <= 1.0e-10*mg_y_norm))
+            {
+                log.error("fused and plain mg cycles differ!!");
+                error++;
+            }
+            vec_ops->stop_use_vector(z);
+            vec_ops->free_vector(z);
+            for(int fused = 0; fused <= 1; ++fused)
+            {
+                vec_ops->stop_use_vector(mg_y[fused]);
+                vec_ops->free_vector(mg_y[fused]);
+            }
+            get_residual(*lin_op_elliptic, x, y, x_ref);
+        }
+        {
+            log.info("F-cycle and K-cycle");
+            /// one sweep cycles with smoothing on the coarsest level: V-cycle convergence degrades with levels number;
+            /// K-cycle is nonlinear preconditioner, so flexible gmres is used for all kinds
+            const char *cycle_kinds[3] = {"standard", "F", "K"};
+            int iters[3];
+            for(int kind = 0; kind < 3; ++kind)
+            {
+                mg_params_t mg_params_kind = mg_params;
+                mg_params_kind.num_sweeps_pre = 1;
+                mg_params_kind.num_sweeps_post = 1;
+                mg_params_kind.cycle_kind = cycle_kinds[kind];
+                auto mg = std::make_shared<mg_t>(mg_utils, mg_params_kind);
+                fgmres_elliptic_w_reg_t::params params_kind;
+                params_kind.monitor.rel_tol = 1.0e-6;
+                params_kind.monitor.max_iters_num = params_elliptic.monitor.max_iters_num;
+                params_kind.basis_size = params_elliptic.basis_size;
+                params_kind.reorthogonalization = params_elliptic.reorthogonalization;
+                fgmres_elliptic_w_reg_t gmres(lin_op_elliptic, vec_ops, &log, params_kind, mg, residual_reg);
+                vec_ops->assign_scalar(0.0, x);
+                bool res = gmres.solve(y, x);
+                error += (!res);
+                iters[kind] = gmres.monitor().iters_performed();
+                log.info_f("cycle_kind = %s: fgmres res: %s, iterations: %i", cycle_kinds[kind], res?"true":"false", iters[kind]);
+            }
+            if ((iters[1] >= iters[0])||(iters[2] >= iters[0]))
+            {
+                log.error("F-cycle or K-cycle did not improve convergence!!");
+                error++;
+            }
+            get_residual(*lin_op_elliptic, x, y, x_ref);
+        }
+        {
+            log.info("K-cycle with levels number limited by max_levels");
+            mg_params_t mg_params_cut = mg_params;
+            mg_params_cut.num_sweeps_pre = 1;
+            mg_params_cut.num_sweeps_post = 1;
+            mg_params_cut.cycle_kind = "K";
+            mg_params_cut.max_levels = 4;
+            auto mg = std::make_shared<mg_t>(mg_utils, mg_params_cut);
+            fgmres_elliptic_w_reg_t::params params_cut;
+            params_cut.monitor.rel_tol = 1.0e-6;
+            params_cut.monitor.max_iters_num = params_elliptic.monitor.max_iters_num;
+            params_cut.basis_size = params_elliptic.basis_size;
+            params_cut.reorthogonalization = params_elliptic.reorthogonalization;
+            fgmres_elliptic_w_reg_t gmres(lin_op_elliptic, vec_ops, &log, params_cut, mg, residual_reg);
+            vec_ops->assign_scalar(0.0, x);
+            bool res = gmres.solve(y, x);
+            error += (!res);
+            log.info_f("max_levels = 4: fgmres res: %s, iterations: %i", res?"true":"false", gmres.monitor().iters_performed());
+            get_residual(*lin_op_elliptic, x, y, x_ref);
+        }
+        {
+            log.info("full multigrid solve");
+            /// x still holds converged discrete solution, its error is the discretization error
+            T_vec x_fmg;
+            vec_ops->init_vector(x_fmg);
+            vec_ops->start_use_vector(x_fmg);
+            vec_ops->assign(x_ref, x_fmg);
+            vec_ops->add_lin_comb(T(1), x, -T(1), x_fmg);
+            T discr_err = vec_ops->norm(x_fmg);
+            mg_params_t mg_params_fmg = mg_params;
+            mg_params_fmg.mode = "fmg";
+            mg_params_fmg.fmg_cycles = 1;
+            /// no krylov solver to cope with modes that undamped jacobi does not smooth
+            mg_params_fmg.smoother.relaxation = 0.5;
+            auto mg = std::make_shared<mg_t>(mg_utils, mg_params_fmg);
+            mg->set_operator(lin_op_elliptic);
+            mg->apply(y, x_fmg);
+            get_residual(*lin_op_elliptic, x_fmg, y, x_ref);
+            vec_ops->add_lin_comb(-T(1), x_ref, T(1), x_fmg);
+            T fmg_err = vec_ops->norm(x_fmg);
+            log.info_f("fmg: ||x-x_ref|| = %e, discretization error = %e", fmg_err, discr_err);
+            if (!(fmg_err <= 2*discr_err))
+            {
+                log.error("fmg did not reach discretization error!!");
+                error++;
+            }
+            vec_ops->stop_use_vector(x_fmg);
+            vec_ops->free_vector(x_fmg);
+        }
         
         vec_ops->stop_use_vector(x);
         vec_ops->stop_use_vector(y);
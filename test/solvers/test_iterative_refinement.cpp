@@ -0,0 +1,125 @@
+#include <memory>
+#include <cmath>
+#include <scfd/utils/log.h>
+#include <scfd/backend/backend.h>
+#include <nmfd/operations/detail/scfd_array_traits.h>
+#include <nmfd/operations/dense_vector_space.h>
+#include <nmfd/solvers/monitor_krylov.h>
+#include <nmfd/solvers/gmres.h>
+#include <nmfd/solvers/iterative_refinement.h>
+
+#define M_PIl 3.141592653589793238462643383279502884L
+
+/// 1D diffusion operator (see linear_operator_diffusion.h) for dense vector space of any scalar type
+template<class VectorOperations>
+class dense_diffusion_operator
+{
+public:
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+
+    dense_diffusion_operator(const VectorOperations& vec_ops, scalar_type tau) :
+        vec_ops_(vec_ops), N_(vec_ops.size()), tau_(tau)
+    {
+        h_ = scalar_type(1)/static_cast<scalar_type>(N_);
+    }
+    void apply(const vector_type& x, vector_type& f)const
+    {
+        const scalar_type *x_ = vec_ops_.get_raw_ptr(x);
+        scalar_type *f_ = vec_ops_.get_raw_ptr(f);
+        const scalar_type c = tau_/h_/h_;
+        for(std::size_t j = 0; j < N_; j++)
+        {
+            f_[j] = (1+2*c)*x_[j] - (j>0 ? c*x_[j-1] : scalar_type(0)) - (j<N_-1 ? c*x_[j+1] : scalar_type(0));
+        }
+    }
+private:
+    const VectorOperations& vec_ops_;
+    std::size_t N_;
+    scalar_type tau_;
+    scalar_type h_;
+};
+
+int main(int argc, char const *args[])
+{
+    using log_t = scfd::utils::log_std;
+    using backend_t = scfd::backend::current;
+    using memory_t = backend_t::memory_type;
+    using vec_ops_d_t = nmfd::operations::dense_vector_space<nmfd::operations::detail::scfd_array_traits<double, memory_t>, backend_t>;
+    using vec_ops_f_t = nmfd::operations::dense_vector_space<nmfd::operations::detail::scfd_array_traits<float, memory_t>, backend_t>;
+    using T_vec = typename vec_ops_d_t::vector_type;
+    using T_vec_f = typename vec_ops_f_t::vector_type;
+    using lin_op_d_t = dense_diffusion_operator<vec_ops_d_t>;
+    using lin_op_f_t = dense_diffusion_operator<vec_ops_f_t>;
+    using monitor_d_t = nmfd::solvers::monitor_krylov<vec_ops_d_t, log_t>;
+    using monitor_f_t = nmfd::solvers::monitor_krylov<vec_ops_f_t, log_t>;
+    using gmres_f_t = nmfd::solvers::gmres<vec_ops_f_t, monitor_f_t, log_t, lin_op_f_t>;
+    using refinement_t = nmfd::solvers::iterative_refinement<vec_ops_d_t, monitor_d_t, log_t, lin_op_d_t, gmres_f_t>;
+
+    int error = 0;
+    log_t log;
+    log.info("test iterative_refinement");
+    std::size_t N = 100;
+    double tau = 0.01;
+
+    auto vec_ops = std::make_shared<vec_ops_d_t>(N);
+    auto vec_ops_f = std::make_shared<vec_ops_f_t>(N);
+    auto lin_op = std::make_shared<lin_op_d_t>(*vec_ops, tau);
+    auto lin_op_f = std::make_shared<lin_op_f_t>(*vec_ops_f, static_cast<float>(tau));
+
+    T_vec x, y, r;
+    vec_ops->init_vectors(x, y, r);
+    T_vec_f x_f, y_f;
+    vec_ops_f->init_vectors(x_f, y_f);
+    for(std::size_t j = 0; j < N; j++)
+    {
+        vec_ops->set_value_at_point(std::sin(1.0*j/(N-1)*M_PIl) + 0.1*std::sin(7.0*j/(N-1)*M_PIl), j, y);
+    }
+
+    //float gmres alone can not reach tolerance below float precision
+    gmres_f_t::params params_f;
+    params_f.monitor.rel_tol = 1.0e-12;
+    params_f.monitor.max_iters_num = 1000;
+    params_f.basis_size = 30;
+    log.info_f("=>float gmres with size %i, rel_tol %e", static_cast<int>(N), params_f.monitor.rel_tol);
+    {
+        gmres_f_t gmres_f(lin_op_f, vec_ops_f, &log, params_f);
+        vec_ops_f->assign_convert(*vec_ops, y, y_f);
+        vec_ops_f->assign_scalar(0.f, x_f);
+        bool res = gmres_f.solve(y_f, x_f);
+        log.info_f("float gmres res: %s", res?"true":"false");
+    }
+
+    //refinement with inner float gmres reaches double precision tolerance
+    params_f.monitor.rel_tol = 1.0e-4;
+    params_f.monitor.max_iters_num = 1000;
+    auto gmres_f = std::make_shared<gmres_f_t>(lin_op_f, vec_ops_f, &log, params_f);
+    refinement_t::params params_ref;
+    params_ref.monitor.rel_tol = 1.0e-12;
+    params_ref.monitor.max_iters_num = 20;
+    refinement_t refinement(lin_op, vec_ops, vec_ops_f, gmres_f, &log, params_ref);
+    log.info_f("=>iterative refinement with inner float gmres, rel_tol %e", params_ref.monitor.rel_tol);
+    vec_ops->assign_scalar(0.0, x);
+    bool res = refinement.solve(y, x);
+    error += (!res);
+    log.info_f("iterative_refinement res: %s, refinement steps %i", res?"true":"false", refinement.monitor().iters_performed());
+    lin_op->apply(x, r);
+    vec_ops->add_lin_comb(1.0, y, -1.0, r);
+    double rel_resid = vec_ops->norm(r)/vec_ops->norm(y);
+    log.info_f("||Lx-y||/||y|| = %e", rel_resid);
+    error += (rel_resid > 1.0e-11);
+
+    vec_ops->free_vectors(x, y, r);
+    vec_ops_f->free_vectors(x_f, y_f);
+
+    if(error > 0)
+    {
+        log.error_f("Got error = %e.", error ) ;
+    }
+    else
+    {
+        log.info("No errors.") ;
+    }
+
+    return error;
+}
@@ -0,0 +1,191 @@
+#include <memory>
+#include <cmath>
+#include <string>
+#include <scfd/utils/log.h>
+#include <scfd/backend/backend.h>
+#include <nmfd/operations/detail/scfd_array_traits.h>
+#include <nmfd/operations/dense_vector_space.h>
+#include <nmfd/operations/jfnk_operator.h>
+#include <nmfd/solvers/monitor_krylov.h>
+#include <nmfd/solvers/gmres.h>
+#include <nmfd/solvers/nonlinear_solver.h>
+#include <nmfd/solvers/newton_iteration.h>
+
+#define M_PIl 3.141592653589793238462643383279502884L
+
+/// F(u) = -u'' + u^3 - b on uniform grid with zero boundary values; only residual is provided, no jacobian
+template<class VectorOperations>
+class dense_cubic_diffusion_operator
+{
+public:
+    using scalar_type = typename VectorOperations::scalar_type;
+    using vector_type = typename VectorOperations::vector_type;
+
+    dense_cubic_diffusion_operator(const VectorOperations& vec_ops, const vector_type &b) :
+        vec_ops_(vec_ops), N_(vec_ops.size()), b_(b), apply_calls(0)
+    {
+        h_ = scalar_type(1)/static_cast<scalar_type>(N_+1);
+    }
+    void apply(const vector_type& x, vector_type& f)const
+    {
+        apply_calls++;
+        const scalar_type *x_ = vec_ops_.get_raw_ptr(x);
+        const scalar_type *b_ptr = vec_ops_.get_raw_ptr(b_);
+        scalar_type *f_ = vec_ops_.get_raw_ptr(f);
+        for(std::size_t j = 0; j < N_; j++)
+        {
+            scalar_type x_l = (j>0 ? x_[j-1] : scalar_type(0)), x_r = (j<N_-1 ? x_[j+1] : scalar_type(0));
+            f_[j] = (2*x_[j] - x_l - x_r)/h_/h_ + x_[j]*x_[j]*x_[j] - b_ptr[j];
+        }
+    }
+    /// exact jacobian action at x, used only to check finite difference approximation
+    void apply_jacobi(const vector_type& x, const vector_type& v, vector_type& f)const
+    {
+        const scalar_type *x_ = vec_ops_.get_raw_ptr(x);
+        const scalar_type *v_ = vec_ops_.get_raw_ptr(v);
+        scalar_type *f_ = vec_ops_.get_raw_ptr(f);
+        for(std::size_t j = 0; j < N_; j++)
+        {
+            scalar_type v_l = (j>0 ? v_[j-1] : scalar_type(0)), v_r = (j<N_-1 ? v_[j+1] : scalar_type(0));
+            f_[j] = (2*v_[j] - v_l - v_r)/h_/h_ + 3*x_[j]*x_[j]*v_[j];
+        }
+    }
+    scalar_type h()const
+    {
+        return h_;
+    }
+
+    mutable int apply_calls;
+private:
+    const VectorOperations& vec_ops_;
+    std::size_t N_;
+    const vector_type &b_;
+    scalar_type h_;
+};
+
+int main(int argc, char const *args[])
+{
+    using log_t = scfd::utils::log_std;
+    using backend_t = scfd::backend::current;
+    using memory_t = backend_t::memory_type;
+    using T = double;
+    using vec_ops_t = nmfd::operations::dense_vector_space<nmfd::operations::detail::scfd_array_traits<T, memory_t>, backend_t>;
+    using T_vec = typename vec_ops_t::vector_type;
+    using nonlin_op_t = dense_cubic_diffusion_operator<vec_ops_t>;
+    using system_op_t = nmfd::operations::jfnk_system_operator<vec_ops_t, nonlin_op_t>;
+    using jfnk_op_t = typename system_op_t::jacobi_operator_type;
+    using monitor_t = nmfd::solvers::monitor_krylov<vec_ops_t, log_t>;
+    using gmres_t = nmfd::solvers::gmres<vec_ops_t, monitor_t, log_t, jfnk_op_t>;
+    using newton_iteration_t = nmfd::solvers::newton_iteration<vec_ops_t, system_op_t, gmres_t>;
+    using newton_solver_t = nmfd::solvers::nonlinear_solver<vec_ops_t, log_t, system_op_t, newton_iteration_t>;
+
+    int error = 0;
+    log_t log;
+    std::size_t N = 64;
+    const T eps = 1e-8;
+
+    auto vec_ops = std::make_shared<vec_ops_t>(N);
+    T_vec b, u_ex, x, v, f_fd, f_ex;
+    vec_ops->init_vectors(b, u_ex, x, v, f_fd, f_ex);
+
+    //manufactured solution u_ex = sin(pi*s): b = F(u_ex) with zero rhs
+    vec_ops->assign_scalar(T(0), b);
+    auto nonlin_op = std::make_shared<nonlin_op_t>(*vec_ops, b);
+    for(std::size_t j = 0; j < N; j++)
+    {
+        vec_ops->set_value_at_point(std::sin(M_PIl*(j+1)*nonlin_op->h()), j, u_ex);
+    }
+    nonlin_op->apply(u_ex, f_ex);
+    vec_ops->assign(f_ex, b);
+
+    {
+        log.info("test jfnk_operator against exact jacobian");
+        jfnk_op_t jfnk_op(vec_ops, nonlin_op);
+        for(std::size_t j = 0; j < N; j++)
+        {
+            vec_ops->set_value_at_point(T(1) + std::cos(3.0*j/(N-1)), j, x);
+            vec_ops->set_value_at_point(std::sin(5.0*j/(N-1)), j, v);
+        }
+        jfnk_op.set_linearization_point(x);
+        int calls_before = nonlin_op->apply_calls;
+        jfnk_op.apply(v, f_fd);
+        nonlin_op->apply_jacobi(x, v, f_ex);
+        vec_ops->add_lin_comb(T(-1), f_ex, T(1), f_fd);
+        T rel_err = vec_ops->norm(f_fd)/vec_ops->norm(f_ex);
+        log.info_f("relative error of J*v: %e, residual evaluations per apply: %i", rel_err, nonlin_op->apply_calls - calls_before);
+        if ((rel_err > 1e-6)||(nonlin_op->apply_calls - calls_before != 1))
+        {
+            log.error("jfnk_operator apply is wrong!!");
+            error++;
+        }
+
+        vec_ops->assign_scalar(T(0), v);
+        vec_ops->assign_scalar(T(1), f_fd);
+        jfnk_op.apply(v, f_fd);
+        if (vec_ops->norm(f_fd) != T(0))
+        {
+            log.error("jfnk_operator applied to zero vector is not zero!!");
+            error++;
+        }
+    }
+
+    {
+        log.info("test newton-krylov with jfnk_operator inside gmres");
+        auto system_op = std::make_shared<system_op_t>(vec_ops, nonlin_op);
+        gmres_t::params params_gmres;
+        params_gmres.monitor.rel_tol = 1.0e-10;
+        params_gmres.monitor.max_iters_num = 200;
+        params_gmres.basis_size = 70;
+        int evals_fixed = 0;
+        for(std::string forcing : {"fixed", "ew1", "ew2"})
+        {
+            log.info_f("forcing: %s", forcing.c_str());
+            newton_iteration_t::params params_newton;
+            params_newton.forcing = forcing;
+            auto gmres = std::make_shared<gmres_t>(vec_ops, &log, params_gmres);
+            auto newton_iteration = std::make_shared<newton_iteration_t>(vec_ops, gmres, params_newton);
+            auto newton_solver = std::make_shared<newton_solver_t>(vec_ops, &log, newton_iteration);
+            newton_solver->convergence_strategy()->set_tolerance(eps);
+            vec_ops->assign_scalar(T(0), x);
+            int calls_before = nonlin_op->apply_calls;
+            bool res = newton_solver->solve(system_op.get(), nullptr, nullptr, x);
+            /// each gmres iteration costs one residual evaluation inside jfnk_operator
+            int evals = nonlin_op->apply_calls - calls_before;
+            nonlin_op->apply(x, f_fd);
+            T resid = vec_ops->norm(f_fd);
+            vec_ops->add_lin_comb(T(-1), u_ex, T(1), x);
+            T sol_err = vec_ops->norm_inf(x);
+            log.info_f(
+                "newton res: %s, residual norm: %e, solution error: %e, newton iterations: %i, residual evaluations: %i",
+                res?"true":"false", resid, sol_err, newton_solver->convergence_strategy()->get_number_of_iterations(), evals
+            );
+            if ((!res)||(resid > eps)||(sol_err > 1e-8))
+            {
+                log.error("Failed to converge!!");
+                error++;
+            }
+            if (forcing == "fixed")
+            {
+                evals_fixed = evals;
+            }
+            else if (evals >= evals_fixed)
+            {
+                log.error("Inexact newton did not reduce krylov iterations!!");
+                error++;
+            }
+        }
+    }
+
+    vec_ops->free_vectors(b, u_ex, x, v, f_fd, f_ex);
+
+    if(error > 0)
+    {
+        log.error_f("Got error = %d.", error ) ;
+    }
+    else
+    {
+        log.info("No errors.") ;
+    }
+
+    return error;
+}
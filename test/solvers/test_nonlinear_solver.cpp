@@ -1,5 +1,7 @@
 #include <memory>
 #include <cmath>
+#include <string>
+#include <stdexcept>
 #include <scfd/utils/log.h>
 #include <scfd/static_vec/vec.h>
 #include <scfd/static_mat/mat.h>
@@ -7,6 +9,7 @@
 #include <nmfd/operations/static_vector_space.h>
 #include <nmfd/solvers/nonlinear_solver.h>
 #include <nmfd/solvers/newton_iteration.h>
+#include <nmfd/solvers/trust_region_iteration.h>
 
 template<class Mat,class VectorSpace>
 struct linsolver
@@ -40,6 +43,49 @@ T eq_residual(const scfd::static_vec::vec<T,2> &x)
     return std::sqrt(f[0]*f[0]+f[1]*f[1]);
 }
 
+/// jacobi matrix that can be applied to a vector (needed by trust region and jacobi slope of line search)
+template<class Mat,class Vec>
+struct applicable_mat : public Mat
+{
+    void apply(const Vec &v, Vec &f)const
+    {
+        apply_calls++;
+        f = (*this)*v;
+    }
+
+    mutable int apply_calls = 0;
+};
+
+/// F(x) = atan(x): newton steps overshoot by orders of magnitude far from the root
+template<class T,class Jacobi>
+struct atan_op
+{
+    using vec_t = scfd::static_vec::vec<T,2>;
+    using jacobi_operator_type = Jacobi;
+
+    atan_op() : jacobi(std::make_shared<Jacobi>()), apply_calls(0)
+    {
+    }
+    void apply(const vec_t &x, vec_t &f)const
+    {
+        apply_calls++;
+        f[0] = std::atan(x[0]);
+        f[1] = std::atan(x[1]);
+    }
+    void set_linearization_point(const vec_t &x)
+    {
+        (*jacobi)(0,0) = T(1)/(1+x[0]*x[0]); (*jacobi)(0,1) = T(0);
+        (*jacobi)(1,0) = T(0);               (*jacobi)(1,1) = T(1)/(1+x[1]*x[1]);
+    }
+    std::shared_ptr<const Jacobi> get_jacobi_operator()const
+    {
+        return jacobi;
+    }
+
+    std::shared_ptr<Jacobi> jacobi;
+    mutable int apply_calls;
+};
+
 int main(int argc, char const *args[])
 {
     using backend_t = nmfd::backend::single_node_cpu<>;
@@ -53,22 +99,22 @@ int main(int argc, char const *args[])
     using linsolver_t = linsolver<mat_t,vec_sp_t>;
     struct system_op_t
     {
-        using scalar_type = T;
-        using vector_type = vec_t;
         using jacobi_operator_type = mat_t;
 
-        system_op_t() : jacobi(std::make_shared<mat_t>())
+        system_op_t() : jacobi(std::make_shared<mat_t>()), apply_calls(0), linearization_calls(0)
         {
         }
 
         void apply(const vec_t &x, vec_t &f)const
         {
+            apply_calls++;
             f[0] = x[0]*x[0] + x[1]*x[1] - 2.;
             f[1] = x[0]*x[1] - 1.;
         }
 
         void set_linearization_point(const vec_t &x)
         {
+            linearization_calls++;
             (*jacobi)(0,0) = 2*x[0]; (*jacobi)(0,1) = 2*x[1];
             (*jacobi)(1,0) =   x[1]; (*jacobi)(1,1) =   x[0];
         }
@@ -78,6 +124,8 @@ int main(int argc, char const *args[])
         }
 
         std::shared_ptr<mat_t> jacobi;
+        mutable int apply_calls;
+        int linearization_calls;
     };
     using newton_iteration_t = nmfd::solvers::newton_iteration<vec_sp_t,system_op_t,linsolver_t>;
     using newton_solver_t = nmfd::solvers::nonlinear_solver<vec_sp_t, log_t, system_op_t, newton_iteration_t>;
@@ -151,7 +199,232 @@ int main(int argc, char const *args[])
         }
     }
 
+    {
+        log.info("test newton evaluates residual once per iteration");
+        std::shared_ptr<linsolver_t> lin_solver = std::make_shared<linsolver_t>();
+        std::shared_ptr<newton_iteration_t> newton_iteration = std::make_shared<newton_iteration_t>(vec_sp, lin_solver);
+        std::shared_ptr<newton_solver_t> newton_solver = std::make_shared<newton_solver_t>(vec_sp, &log, newton_iteration);
+        newton_solver->convergence_strategy()->set_tolerance(eps);
+        system_op_t system_op;
+        vec_t x(10.,2.);
+        newton_solver->solve(&system_op, nullptr, nullptr, x);
+        int iters = newton_solver->convergence_strategy()->get_number_of_iterations();
+        log.info_f("iterations: %i, residual evaluations: %i", iters, system_op.apply_calls);
+        /// initial residual plus one per full (not damped) newton update
+        if ((eq_residual(x) > eps)||(system_op.apply_calls > iters+1))
+        {
+            log.error("Residual is recalculated!!");
+            error++;
+        }
+    }
+
+    {
+        log.info("test newton with lagged jacobian");
+        std::shared_ptr<linsolver_t> lin_solver = std::make_shared<linsolver_t>();
+        newton_iteration_t::params newton_prm;
+        newton_prm.jacobian_lag = 3;
+        newton_prm.max_residual_ratio = 0.5;
+        std::shared_ptr<newton_iteration_t> newton_iteration = std::make_shared<newton_iteration_t>(vec_sp, lin_solver, newton_prm);
+        std::shared_ptr<newton_solver_t> newton_solver = std::make_shared<newton_solver_t>(vec_sp, &log, newton_iteration);
+        newton_solver->convergence_strategy()->set_tolerance(eps);
+        system_op_t system_op;
+        vec_t x(10.,2.);
+        newton_solver->solve(&system_op, nullptr, nullptr, x);
+        int iters = newton_solver->convergence_strategy()->get_number_of_iterations();
+        log.info_f("iterations: %i, jacobian evaluations: %i", iters, system_op.linearization_calls);
+        T resid = eq_residual(x);
+        log.info_f("residual norm: %0.15e", resid);
+        if ((resid > eps)||(system_op.linearization_calls != newton_iteration->jacobian_refreshes_num())||(system_op.linearization_calls >= iters))
+        {
+            log.error("Failed to converge with lagged jacobian!!");
+            error++;
+        }
+        /// new solve starts with fresh jacobian
+        int refreshes = newton_iteration->jacobian_refreshes_num();
+        vec_t x1(10.,2.);
+        newton_solver->solve(&system_op, nullptr, nullptr, x1);
+        if ((eq_residual(x1) > eps)||(newton_iteration->jacobian_refreshes_num() == refreshes))
+        {
+            log.error("Failed second solve with lagged jacobian!!");
+            error++;
+        }
+    }
+
+    {
+        log.info("test newton forcing terms need linear solver with monitor");
+        newton_iteration_t::params newton_prm;
+        newton_prm.forcing = "ew1";
+        bool thrown = false;
+        try
+        {
+            newton_iteration_t newton_iteration(vec_sp, std::make_shared<linsolver_t>(), newton_prm);
+        }
+        catch(const std::logic_error &e)
+        {
+            log.info_f("expected exception: %s", e.what());
+            thrown = true;
+        }
+        if (!thrown)
+        {
+            log.error("Forcing terms are accepted for linear solver without monitor!!");
+            error++;
+        }
+    }
+
+    {
+        log.info("test newton with interpolating line search");
+        /// full newton steps overshoot for atan far from the root, so they are backtracked
+        using atan_op_t = atan_op<T,mat_t>;
+        using atan_newton_iteration_t = nmfd::solvers::newton_iteration<vec_sp_t,atan_op_t,linsolver_t>;
+        using atan_conv_strat_t = nmfd::solvers::default_convergence_strategy<vec_sp_t, log_t, atan_op_t>;
+        using atan_newton_solver_t = nmfd::solvers::nonlinear_solver<vec_sp_t, log_t, atan_op_t, atan_newton_iteration_t>;
+        int apply_calls_halving = 0;
+        for(std::string line_search : {"halving", "quadratic", "cubic"})
+        {
+            std::shared_ptr<linsolver_t> lin_solver = std::make_shared<linsolver_t>();
+            std::shared_ptr<atan_newton_iteration_t> newton_iteration = std::make_shared<atan_newton_iteration_t>(vec_sp, lin_solver);
+            atan_conv_strat_t::params conv_prm;
+            conv_prm.line_search = line_search;
+            conv_prm.abs_tol = eps;
+            std::shared_ptr<atan_conv_strat_t> conv_strat = std::make_shared<atan_conv_strat_t>(vec_sp, &log, conv_prm);
+            std::shared_ptr<atan_newton_solver_t> newton_solver = std::make_shared<atan_newton_solver_t>(vec_sp, &log, newton_iteration, conv_strat);
+            atan_op_t atan_op;
+            vec_t x(3.,-2.);
+            newton_solver->solve(&atan_op, nullptr, nullptr, x);
+            int iters = newton_solver->convergence_strategy()->get_number_of_iterations();
+            log.info_f("line search %s: iterations: %i, residual evaluations: %i", line_search.c_str(), iters, atan_op.apply_calls);
+            if ((std::abs(x[0]) > eps)||(std::abs(x[1]) > eps))
+            {
+                log.error_f("Failed to converge with %s line search!!", line_search.c_str());
+                error++;
+            }
+            if (line_search == "halving")
+            {
+                apply_calls_halving = atan_op.apply_calls;
+            }
+            else if (atan_op.apply_calls >= apply_calls_halving)
+            {
+                log.error_f("%s line search does not reduce residual evaluations!!", line_search.c_str());
+                error++;
+            }
+        }
+    }
+
+    {
+        log.info("test line search with jacobi slope");
+        /// linear systems are solved exactly, so (F(x),J*dx) = -||F(x)||^2 and backtracking is the same as without jacobi slope
+        using atan_op_t = atan_op<T,applicable_mat<mat_t,vec_t>>;
+        using atan_newton_iteration_t = nmfd::solvers::newton_iteration<vec_sp_t,atan_op_t,linsolver_t>;
+        using atan_conv_strat_t = nmfd::solvers::default_convergence_strategy<vec_sp_t, log_t, atan_op_t>;
+        using atan_newton_solver_t = nmfd::solvers::nonlinear_solver<vec_sp_t, log_t, atan_op_t, atan_newton_iteration_t>;
+        int apply_calls[2], jacobi_apply_calls[2];
+        for(int jacobi_slope = 0; jacobi_slope <= 1; ++jacobi_slope)
+        {
+            auto newton_iteration = std::make_shared<atan_newton_iteration_t>(vec_sp, std::make_shared<linsolver_t>());
+            atan_conv_strat_t::params conv_prm;
+            conv_prm.line_search = "cubic";
+            conv_prm.line_search_jacobi_slope = (jacobi_slope == 1);
+            conv_prm.abs_tol = eps;
+            atan_newton_solver_t newton_solver(vec_sp, &log, newton_iteration, std::make_shared<atan_conv_strat_t>(vec_sp, &log, conv_prm));
+            atan_op_t atan_op;
+            vec_t x(3.,-2.);
+            bool res = newton_solver.solve(&atan_op, nullptr, nullptr, x);
+            apply_calls[jacobi_slope] = atan_op.apply_calls;
+            jacobi_apply_calls[jacobi_slope] = atan_op.jacobi->apply_calls;
+            log.info_f(
+                "line_search_jacobi_slope = %s: residual evaluations: %i, jacobi applies: %i",
+                jacobi_slope?"true":"false", apply_calls[jacobi_slope], jacobi_apply_calls[jacobi_slope]
+            );
+            if ((!res)||(std::abs(x[0]) > eps)||(std::abs(x[1]) > eps))
+            {
+                log.error("Failed to converge with jacobi slope line search!!");
+                error++;
+            }
+        }
+        if ((jacobi_apply_calls[0] != 0)||(jacobi_apply_calls[1] == 0)||(apply_calls[1] != apply_calls[0]))
+        {
+            log.error("Jacobi slope is not used or changes exact newton line search!!");
+            error++;
+        }
+    }
+
+    {
+        log.info("test trust region iteration against damped newton");
+        /// atan is hard for damped newton far from the root: newton steps overshoot by orders of magnitude
+        using tr_atan_op_t = atan_op<T,applicable_mat<mat_t,vec_t>>;
+        using tr_conv_strat_t = nmfd::solvers::default_convergence_strategy<vec_sp_t, log_t, tr_atan_op_t>;
+        using tr_newton_iteration_t = nmfd::solvers::newton_iteration<vec_sp_t,tr_atan_op_t,linsolver_t>;
+        using tr_newton_solver_t = nmfd::solvers::nonlinear_solver<vec_sp_t, log_t, tr_atan_op_t, tr_newton_iteration_t>;
+        using trust_region_iteration_t = nmfd::solvers::trust_region_iteration<vec_sp_t,tr_atan_op_t,linsolver_t>;
+        using trust_region_solver_t = nmfd::solvers::nonlinear_solver<vec_sp_t, log_t, tr_atan_op_t, trust_region_iteration_t>;
+        tr_conv_strat_t::params conv_prm;
+        conv_prm.abs_tol = eps;
+        conv_prm.verbose = false;
+        for(vec_t x0 : {vec_t(3.,-2.), vec_t(10.,-4.)})
+        {
+            tr_atan_op_t atan_op_newton, atan_op_tr;
+            auto newton_iteration = std::make_shared<tr_newton_iteration_t>(vec_sp, std::make_shared<linsolver_t>());
+            tr_newton_solver_t newton_solver(vec_sp, &log, newton_iteration, std::make_shared<tr_conv_strat_t>(vec_sp, &log, conv_prm));
+            vec_t x_newton = x0;
+            bool res_newton = newton_solver.solve(&atan_op_newton, nullptr, nullptr, x_newton);
 
+            auto tr_iteration = std::make_shared<trust_region_iteration_t>(vec_sp, std::make_shared<linsolver_t>());
+            auto tr_conv_strat = std::make_shared<tr_conv_strat_t>(vec_sp, &log, conv_prm);
+            trust_region_solver_t tr_solver(vec_sp, &log, tr_iteration, tr_conv_strat);
+            vec_t x_tr = x0;
+            bool res_tr = tr_solver.solve(&atan_op_tr, nullptr, nullptr, x_tr);
+            log.info_f(
+                "x0 = (%.1f,%.1f): damped newton: %s, residual evaluations: %i; trust region: %s, residual evaluations: %i, rejected steps: %i",
+                x0[0], x0[1], res_newton?"converged":"failed", atan_op_newton.apply_calls,
+                res_tr?"converged":"failed", atan_op_tr.apply_calls, tr_iteration->rejections_num()
+            );
+            if ((!res_tr)||(std::abs(x_tr[0]) > eps)||(std::abs(x_tr[1]) > eps))
+            {
+                log.error("Failed to converge with trust region!!");
+                error++;
+            }
+            //F(x0) and one evaluation per trial step: F(x+d_x) of accepted step is not recalculated by convergence check
+            int tr_expected_calls = static_cast<int>(tr_conv_strat->get_number_of_iterations()) + tr_iteration->rejections_num();
+            if (atan_op_tr.apply_calls != tr_expected_calls)
+            {
+                log.error_f("Trust region made %i residual evaluations, expected %i!!", atan_op_tr.apply_calls, tr_expected_calls);
+                error++;
+            }
+            if (res_newton && (atan_op_tr.apply_calls >= atan_op_newton.apply_calls))
+            {
+                log.error("Trust region does not reduce residual evaluations!!");
+                error++;
+            }
+        }
+        {
+            /// no rejections and huge radius: overshooting newton steps are returned as is and must be damped by convergence strategy
+            trust_region_iteration_t::params tr_prm;
+            tr_prm.radius_initial = T(1.0e3);
+            tr_prm.max_rejections = 0;
+            tr_conv_strat_t::params conv_prm_hist = conv_prm;
+            conv_prm_hist.store_norms_history = true;
+            tr_atan_op_t atan_op_tr;
+            auto tr_iteration = std::make_shared<trust_region_iteration_t>(vec_sp, std::make_shared<linsolver_t>(), tr_prm);
+            auto tr_conv_strat = std::make_shared<tr_conv_strat_t>(vec_sp, &log, conv_prm_hist);
+            trust_region_solver_t tr_solver(vec_sp, &log, tr_iteration, tr_conv_strat);
+            vec_t x_tr(10.,-4.);
+            bool res_tr = tr_solver.solve(&atan_op_tr, nullptr, nullptr, x_tr);
+            const std::vector<T> &norms = *tr_conv_strat->get_norms_history_handle();
+            bool monotone = true;
+            T norm_prev = tr_conv_strat->rel_tol_base();
+            for(T norm : norms)
+            {
+                monotone = monotone && (norm <= norm_prev);
+                norm_prev = norm;
+            }
+            log.info_f("max_rejections = 0: trust region: %s, iterations: %i", res_tr?"converged":"failed", static_cast<int>(norms.size()));
+            if ((!res_tr)||(!monotone))
+            {
+                log.error("Norm increasing trust region step is accepted!!");
+                error++;
+            }
+        }
+    }
 
     if(error > 0)
     {
@@ -0,0 +1,247 @@
+#include <memory>
+#include <cmath>
+#include <chrono>
+#include <scfd/utils/log.h>
+#include "cpu_vector_space.h"
+#include "cpu_vector_space_latency.h"
+#include "linear_operator_advection.h"
+#include "linear_operator_diffusion.h"
+#include "preconditioner_advection.h"
+#include "preconditioner_diffusion.h"
+#include <nmfd/solvers/monitor_krylov.h>
+#include <nmfd/solvers/gmres.h>
+#include <nmfd/solvers/pipelined_gmres.h>
+
+#define M_PIl 3.141592653589793238462643383279502884L
+
+
+
+int main(int argc, char const *args[])
+{
+    using log_t = scfd::utils::log_std;
+    using T = double;
+    using T_vec = double*;
+    using vec_ops_t = nmfd::cpu_vector_space<T, T_vec, log_t>;
+    using lin_op_adv_t = tests::linear_operator_advection<vec_ops_t, log_t>;
+    using lin_op_diff_t = tests::linear_operator_diffusion<vec_ops_t, log_t>;
+    using prec_adv_t = tests::preconditioner_advection<vec_ops_t, lin_op_adv_t, log_t>;
+    using prec_diff_t = tests::preconditioner_diffusion<vec_ops_t, lin_op_diff_t, log_t>;
+    using monitor_t = nmfd::solvers::monitor_krylov<vec_ops_t, log_t>;
+    using gmres_adv_t = nmfd::solvers::pipelined_gmres< vec_ops_t, monitor_t, log_t, lin_op_adv_t, prec_adv_t >;
+    using gmres_diff_t = nmfd::solvers::pipelined_gmres< vec_ops_t, monitor_t, log_t, lin_op_diff_t, prec_diff_t >;
+    using gmres_diff_noprec_t = nmfd::solvers::pipelined_gmres< vec_ops_t, monitor_t, log_t, lin_op_diff_t >;
+
+    using vec_ops_lat_t = nmfd::cpu_vector_space_latency<T, T_vec, log_t>;
+    using lin_op_diff_lat_t = tests::linear_operator_diffusion<vec_ops_lat_t, log_t>;
+    using prec_diff_lat_t = tests::preconditioner_diffusion<vec_ops_lat_t, lin_op_diff_lat_t, log_t>;
+    using monitor_lat_t = nmfd::solvers::monitor_krylov<vec_ops_lat_t, log_t>;
+    using gmres_lat_t = nmfd::solvers::gmres< vec_ops_lat_t, monitor_lat_t, log_t, lin_op_diff_lat_t, prec_diff_lat_t >;
+    using pipelined_gmres_lat_t = nmfd::solvers::pipelined_gmres< vec_ops_lat_t, monitor_lat_t, log_t, lin_op_diff_lat_t, prec_diff_lat_t >;
+
+    int error = 0;
+    log_t log;
+    log.info("test pipelined_gmres");
+    std::size_t N_with_preconds = 500;
+    std::size_t N_with_no_preconds = 50;
+    std::shared_ptr<vec_ops_t> vec_ops;
+
+    auto check_residual = [&log](auto& vec_ops, auto& A, auto& x, auto &y, T tol)
+    {
+        T_vec resid;
+        vec_ops.init_vector(resid);
+        vec_ops.start_use_vector(resid);
+        A.apply(x,resid);
+        vec_ops.add_lin_comb(1,y,-1,resid);
+        T res_norm = vec_ops.norm(resid), rhs_norm = vec_ops.norm(y);
+        log.info_f("||Lx-y|| = %e", res_norm );
+        vec_ops.stop_use_vector(resid);
+        vec_ops.free_vector(resid);
+        return (res_norm <= tol*rhs_norm ? 0 : 1);
+    };
+
+    //testing left and right preconditioners
+    {
+        std::size_t N = N_with_preconds;
+        vec_ops = std::make_shared<vec_ops_t>(N);
+        auto prec_diff = std::make_shared<prec_diff_t>(vec_ops, 15);
+        auto prec_adv = std::make_shared<prec_adv_t>(vec_ops, 1);
+
+        T tau = 1.0;
+        T a = 1.0;
+        T_vec x,y;
+        vec_ops->init_vector(x);
+        vec_ops->init_vector(y);
+        vec_ops->start_use_vector(x);
+        vec_ops->start_use_vector(y);
+
+        log.info_f("=>diffusion with size %i, timestep %.02f.", vec_ops->size(), tau );
+        auto lin_op_diff = std::make_shared<lin_op_diff_t>(*vec_ops, tau);
+
+        for(int j=0;j<N;j++)
+        {
+            y[j] = std::sin(1.0*j/(N-1)*M_PIl);
+        }
+        y[0] = y[N-1] = 0;
+
+        gmres_diff_t::params params_diff;
+        params_diff.monitor.rel_tol = 1.0e-10;
+        params_diff.monitor.max_iters_num = 300;
+        params_diff.basis_size = 25;
+        for(char side: {'L', 'R'})
+        {
+            log.info_f("%c preconditioner", side);
+            params_diff.preconditioner_side = side;
+            gmres_diff_t gmres(lin_op_diff, vec_ops, &log, params_diff, prec_diff);
+
+            vec_ops->assign_scalar(0.0, x);
+            bool res = gmres.solve(y, x);
+            error += (!res);
+            log.info_f("pipelined_gmres res: %s", res?"true":"false");
+            log.info(" reusing the solution...");
+            vec_ops->add_mul_scalar(0.0, 0.99999, x);
+            res = gmres.solve(y, x);
+            error += (!res);
+            log.info_f("pipelined_gmres res with x0: %s", res?"true":"false");
+            error += check_residual(*vec_ops, *lin_op_diff, x, y, 1.0e-8);
+        }
+
+        log.info_f("=>advection with size %i, speed %.02f, timestep %.02f.", vec_ops->size(), a, tau );
+        gmres_adv_t::params params_adv;
+        params_adv.monitor.rel_tol = 1.0e-10;
+        params_adv.monitor.max_iters_num = 300;
+        params_adv.basis_size = 15;
+        auto lin_op_adv = std::make_shared<lin_op_adv_t>(*vec_ops, a, tau);
+        for(char side: {'L', 'R'})
+        {
+            log.info_f("%c preconditioner", side);
+            params_adv.preconditioner_side = side;
+            gmres_adv_t gmres(lin_op_adv, vec_ops, &log, params_adv, prec_adv);
+
+            vec_ops->assign_scalar(0.0, x);
+            bool res = gmres.solve(y, x);
+            error += (!res);
+            log.info_f("pipelined_gmres res: %s", res?"true":"false");
+            error += check_residual(*vec_ops, *lin_op_adv, x, y, 1.0e-8);
+        }
+
+        vec_ops->stop_use_vector(x);
+        vec_ops->stop_use_vector(y);
+        vec_ops->free_vector(x);
+        vec_ops->free_vector(y);
+    }
+    //no preconditioner, several restarts
+    {
+        std::size_t N = N_with_no_preconds;
+        vec_ops = std::make_shared<vec_ops_t>(N);
+        T tau = 1.0;
+        T_vec x,y;
+        vec_ops->init_vector(x);
+        vec_ops->init_vector(y);
+        vec_ops->start_use_vector(x);
+        vec_ops->start_use_vector(y);
+
+        log.info_f("=>diffusion with size %i, timestep %.02f.", vec_ops->size(), tau );
+        auto lin_op_diff = std::make_shared<lin_op_diff_t>(*vec_ops, tau);
+
+        for(int j=0;j<N;j++)
+        {
+            y[j] = std::sin(1.0*j/(N-1)*M_PIl);
+        }
+        y[0] = y[N-1] = 0;
+        gmres_diff_noprec_t::params params_diff;
+        params_diff.monitor.rel_tol = 1.0e-10;
+        params_diff.monitor.max_iters_num = 400;
+        params_diff.basis_size = 20;
+        gmres_diff_noprec_t gmres_diff(lin_op_diff, vec_ops, &log, params_diff);
+
+        vec_ops->assign_scalar(0.0, x);
+        log.info("no preconditioner");
+        bool res = gmres_diff.solve(y, x);
+        error += (!res);
+        log.info_f("pipelined_gmres res: %s", res?"true":"false");
+        error += check_residual(*vec_ops, *lin_op_diff, x, y, 1.0e-8);
+
+        vec_ops->stop_use_vector(x);
+        vec_ops->stop_use_vector(y);
+        vec_ops->free_vector(x);
+        vec_ops->free_vector(y);
+    }
+    //emulated reduction latency: pipelined_gmres must hide it behind operator and preconditioner applications
+    {
+        std::size_t N = N_with_preconds;
+        auto vec_ops_lat = std::make_shared<vec_ops_lat_t>(N, std::chrono::microseconds(200));
+        auto prec_diff = std::make_shared<prec_diff_lat_t>(vec_ops_lat, 15);
+        T tau = 1.0;
+        T_vec x,y;
+        vec_ops_lat->init_vector(x);
+        vec_ops_lat->init_vector(y);
+        vec_ops_lat->start_use_vector(x);
+        vec_ops_lat->start_use_vector(y);
+
+        log.info_f("=>diffusion with size %i, timestep %.02f, emulated reduction latency.", vec_ops_lat->size(), tau );
+        auto lin_op_diff = std::make_shared<lin_op_diff_lat_t>(*vec_ops_lat, tau);
+        for(int j=0;j<N;j++)
+        {
+            y[j] = std::sin(1.0*j/(N-1)*M_PIl);
+        }
+        y[0] = y[N-1] = 0;
+
+        gmres_lat_t::params params_gmres;
+        params_gmres.monitor.rel_tol = 1.0e-10;
+        params_gmres.monitor.max_iters_num = 300;
+        params_gmres.basis_size = 25;
+        params_gmres.orthogonalization = "cgs";
+        gmres_lat_t gmres(lin_op_diff, vec_ops_lat, &log, params_gmres, prec_diff);
+
+        pipelined_gmres_lat_t::params params_pipelined;
+        params_pipelined.monitor.rel_tol = 1.0e-10;
+        params_pipelined.monitor.max_iters_num = 300;
+        params_pipelined.basis_size = 25;
+        pipelined_gmres_lat_t pipelined_gmres(lin_op_diff, vec_ops_lat, &log, params_pipelined, prec_diff);
+
+        vec_ops_lat->assign_scalar(0.0, x);
+        vec_ops_lat->reset_reductions_num();
+        auto start = std::chrono::steady_clock::now();
+        bool res = gmres.solve(y, x);
+        auto gmres_time = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::size_t gmres_blocking = vec_ops_lat->blocking_reductions_num();
+        error += (!res);
+        log.info_f("gmres res: %s, time %.02f ms, blocking reductions %i", res?"true":"false", gmres_time, static_cast<int>(gmres_blocking));
+        error += check_residual(*vec_ops_lat, *lin_op_diff, x, y, 1.0e-8);
+
+        vec_ops_lat->assign_scalar(0.0, x);
+        vec_ops_lat->reset_reductions_num();
+        start = std::chrono::steady_clock::now();
+        res = pipelined_gmres.solve(y, x);
+        auto pipelined_time = std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::size_t pipelined_blocking = vec_ops_lat->blocking_reductions_num();
+        error += (!res);
+        log.info_f(
+            "pipelined_gmres res: %s, time %.02f ms, blocking reductions %i, nonblocking reductions %i", res?"true":"false", pipelined_time,
+            static_cast<int>(pipelined_blocking), static_cast<int>(vec_ops_lat->async_reductions_num())
+        );
+        error += check_residual(*vec_ops_lat, *lin_op_diff, x, y, 1.0e-8);
+        //reductions of pipelined_gmres are nonblocking except startup and explicit residual checks
+        if(10*pipelined_blocking > gmres_blocking)
+        {
+            log.error_f("pipelined_gmres made %i blocking reductions, expected at most 1/10 of gmres ones (%i)", static_cast<int>(pipelined_blocking), static_cast<int>(gmres_blocking));
+            error++;
+        }
+
+        vec_ops_lat->stop_use_vector(x);
+        vec_ops_lat->stop_use_vector(y);
+        vec_ops_lat->free_vector(x);
+        vec_ops_lat->free_vector(y);
+    }
+
+    if(error > 0)
+    {
+        log.error_f("Got error = %e.", error ) ;
+    }
+    else
+    {
+        log.info("No errors.") ;
+    }
+
+    return error;
+}